@@ -27,11 +27,25 @@
  *   Count = 5  --> LEDs = 00000101 (P1.0 and P1.2 ON)
  *   Count = 255 --> LEDs = 11111111 (All LEDs ON)
  *
+ * Section Profiling (PROFILE=1, Common/profile.c):
+ *   Each pass of the loop and the delay_ms(1000) inside it are timed in
+ *   machine cycles with Timer2. Read profile_data[] in the Keil Watch
+ *   window: a 1 s delay should be 921600 cycles at 11.0592 MHz, so the
+ *   delay_ms entry shows how far the calibrated loop is off.
+ *
  * Crystal Frequency: 11.0592 MHz
  ******************************************************************************/
 
 #include <reg51.h>      // Standard 8051 register definitions
 
+// Profiled Sections (Common/profile.h)
+#define PROFILE_SECTIONS(X)                 \
+    X(PROF_COUNT,     "count")              \
+    X(PROF_DELAY,     "delay_ms")
+#include "../../Common/profile.h"
+
+PROFILE_TABLE();
+
 /******************************************************************************
  * Function: delay_ms
  * Description: Software delay function for millisecond delays
@@ -57,13 +71,22 @@ void main() {
     
     // Configure Port 1 as output, initialize to 0
     P1 = 0x00;
+
+#if PROFILE
+    profile_init();             // Timer2 timebase
+    EA = 1;                     // Timer2 overflow interrupt extends it
+#endif
     
     // Infinite loop for continuous counting
     while(1) {
+        PROFILE_BEGIN(PROF_COUNT);
         P1 = counter;           // Display counter value on LEDs
+        PROFILE_BEGIN(PROF_DELAY);
         delay_ms(1000);         // Wait 1 second per count
+        PROFILE_END(PROF_DELAY);
         
         counter++;              // Increment counter
+        PROFILE_END(PROF_COUNT);
         
         // counter automatically wraps around from 255 to 0
         // due to 8-bit overflow (no explicit reset needed)
@@ -97,6 +120,36 @@ void main() {
 
 #endif
 
+/******************************************************************************
+ * Alternative Version: Decimal (BCD) Counter 00-99
+ * Upper nibble (P1.7-P1.4) = tens digit, lower nibble (P1.3-P1.0) = units.
+ * Uses fmt_bcd8() from Common/numfmt.c (add it to Source Group 1), which
+ * converts without the C51 divide/modulo library calls.
+ ******************************************************************************/
+#if 0  // Set to 1 to use this version instead
+
+#include "../../Common/numfmt.h"
+
+void main() {
+    unsigned char counter = 0;
+    unsigned char bcd[2];
+
+    P1 = 0x00;
+
+    while(1) {
+        fmt_bcd8(counter, bcd);
+        P1 = bcd[0];            // Packed BCD: tens << 4 | units
+        delay_ms(1000);
+
+        counter++;
+        if(counter > 99) {
+            counter = 0;
+        }
+    }
+}
+
+#endif
+
 /******************************************************************************
  * Build Instructions:
  *   1. Open Keil uVision 5
@@ -105,6 +158,10 @@ void main() {
  *   4. Set crystal frequency: 11.0592 MHz in Target Options
  *   5. Build project (Ctrl+B) to generate HEX file
  *   6. Program P89V51RD2 using FlashMagic
+ *   Profiling: also add Common/profile.c and Common/numfmt.c to Source
+ *   Group 1, add PROFILE=1 to C51 -> Preprocessor Symbols -> Define and
+ *   select the Compact memory model (the statistics need about 80
+ *   bytes of RAM)
  *
  * Expected Output:
  *   LEDs display binary counting pattern:
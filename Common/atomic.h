@@ -0,0 +1,121 @@
+/******************************************************************************
+ * ISR-Safe Access - Multi-Byte State Shared with an Interrupt
+ * Shared by: PIC18F4550 (XC8) and P89V51RD2 (Keil C51) programs
+ *
+ * Description:
+ *   Both cores load and store a byte in one instruction, so a flag or a
+ *   ring index shared with an ISR needs nothing beyond volatile. Wider
+ *   values are read a byte at a time. If the ISR increments a 16-bit
+ *   counter from 0x00FF to 0x0100 between the two byte reads, main sees
+ *   0x01FF or 0x0000. Clearing GIE or EA around the read fixes that but
+ *   delays every interrupt source in the program. These macros cost
+ *   about the same and hold up one source at most:
+ *
+ *   ATOMIC_READ(dst, var)
+ *       Snapshot of one counter: read it until two reads agree. No
+ *       interrupt is masked.
+ *   ATOMIC_SEQ_WRITE(seq) / ATOMIC_SEQ_READ_BEGIN(seq) ... _END(seq)
+ *       Several fields that belong together (statistics, a record). The
+ *       ISR bumps an 8-bit sequence count after updating them; main
+ *       repeats its copy until the count is the same before and after.
+ *       No interrupt is masked.
+ *   ATOMIC_MASK_BEGIN(enable) ... ATOMIC_MASK_END(enable)
+ *       Hold off one interrupt source (its enable bit, e.g.
+ *       PIE1bits.ADIE or ET0) and put the bit back as it was. This is
+ *       for main code that writes shared state, e.g. read-and-clear.
+ *
+ * Usage:
+ *   volatile unsigned int overruns;         // ISR: overruns++;
+ *   volatile unsigned char stats_seq;       // ISR: fields, then
+ *   volatile stats_t stats;                 //      ATOMIC_SEQ_WRITE(stats_seq);
+ *
+ *   ATOMIC_READ(count, overruns);
+ *
+ *   ATOMIC_SEQ_READ_BEGIN(stats_seq)
+ *       copy.bytes = stats.bytes;
+ *       copy.errors = stats.errors;
+ *   ATOMIC_SEQ_READ_END(stats_seq)
+ *
+ *   ATOMIC_MASK_BEGIN(PIE1bits.TMR2IE)
+ *       samples = window_samples;
+ *       window_samples = 0;
+ *   ATOMIC_MASK_END(PIE1bits.TMR2IE)
+ *
+ *   BEGIN and END open and close a block, so an unpaired one does not
+ *   compile.
+ *
+ * Cost (what each primitive executes; atomic_bench.c times them):
+ *   ATOMIC_READ       per attempt: two loads of the variable, one
+ *                     compare per byte, one branch
+ *   ATOMIC_SEQ_WRITE  one increment of a byte (one instruction)
+ *   ATOMIC_SEQ_READ   around the copy: two loads of the count, a
+ *                     compare and a branch
+ *   ATOMIC_MASK       a bit test and set to save the enable bit, a bit
+ *                     clear, and a test and set or clear to restore it
+ *   A retry costs one more attempt (one more copy for SEQ_READ). It
+ *   only happens when the writer ran in between, at most once per
+ *   writer interrupt. Clearing GIE is two bit instructions, a few
+ *   cycles cheaper than saving and masking one bit, but the delay it
+ *   causes falls on every source.
+ *
+ * Rules:
+ *   - One writer, an ISR. Readers are main or a lower-priority ISR,
+ *     i.e. code the writer can interrupt. A reader that preempts the
+ *     writer sees a half-written value twice and returns it.
+ *   - Shared variables are volatile, including the fields under a
+ *     sequence count, so the compiler keeps every access in order
+ *   - ATOMIC_READ and SEQ_READ retry while the writer keeps running:
+ *     keep the copy well under the writer's period
+ *   - The 8-bit sequence count misses exactly 256 updates during one
+ *     copy; no copy here comes near that
+ *   - ATOMIC_MASK on the PIC18: the handler must test the enable bit as
+ *     well as the flag, or a request that arrives as the bit is cleared
+ *     (or any other source's interrupt) runs it inside the block. The
+ *     drivers' handlers do (uart_rx_isr returns while RCIE is clear), as
+ *     do the TMR2 sample handlers; check a new handler before masking
+ *     its source. The request then waits for ATOMIC_MASK_END. The
+ *     8051 holds off an interrupt for one instruction after any write to
+ *     IE, so it needs no such test. Blocks for different sources may
+ *     nest.
+ ******************************************************************************/
+
+#ifndef ATOMIC_H
+#define ATOMIC_H
+
+// Saved enable bit: a bit variable on the 8051, a byte on the PIC18
+#if defined(__C51__)
+#define ATOMIC_SAVED_T          bit
+#else
+#define ATOMIC_SAVED_T          unsigned char
+#endif
+
+// Read var into dst until the two reads in one pass agree
+#define ATOMIC_READ(dst, var) {                                             \
+    do {                                                                    \
+        (dst) = (var);                                                      \
+    } while((dst) != (var));                                                \
+}
+
+// Writer (ISR): after updating the fields guarded by seq
+#define ATOMIC_SEQ_WRITE(seq)   { (seq)++; }
+
+// Reader: copy the fields between BEGIN and END; repeated if seq moved
+#define ATOMIC_SEQ_READ_BEGIN(seq) {                                        \
+    unsigned char atomic_seq_;                                              \
+    do {                                                                    \
+        atomic_seq_ = (seq);
+
+#define ATOMIC_SEQ_READ_END(seq)                                            \
+    } while(atomic_seq_ != (seq));                                          \
+}
+
+// Hold off one interrupt source; its enable bit is restored, not set
+#define ATOMIC_MASK_BEGIN(enable) {                                         \
+    ATOMIC_SAVED_T atomic_saved_ = (enable);                                \
+    (enable) = 0;
+
+#define ATOMIC_MASK_END(enable)                                             \
+    (enable) = atomic_saved_;                                               \
+}
+
+#endif
@@ -0,0 +1,149 @@
+/******************************************************************************
+ * ISR-Safe Access Benchmark - Cycles per Primitive in atomic.h
+ * Builds for both PIC18F4550 (XC8) and P89V51RD2 (Keil C51)
+ *
+ * Description:
+ *   Times each primitive once, with no interrupt running, so the figure
+ *   is the cost of one attempt (a retry repeats it). A hardware timer is
+ *   started and stopped around each one and the elapsed count, minus
+ *   the measured start/stop overhead, is stored in cycles[]:
+ *     [0] plain 16-bit read (may tear; for comparison)
+ *     [1] ATOMIC_READ, 16-bit
+ *     [2] ATOMIC_READ, 32-bit
+ *     [3] ATOMIC_SEQ_WRITE
+ *     [4] plain copy of a 6-byte record (32 + 16 bits)
+ *     [5] the same copy inside ATOMIC_SEQ_READ_BEGIN/END
+ *     [6] ATOMIC_MASK_BEGIN + END with nothing in between
+ *     [7] GIE (EA) off, then on: the wholesale mask, for comparison
+ *   The SEQ_READ overhead is [5] - [4].
+ *
+ * Timer Units:
+ *   PIC18F4550: Timer1, Fosc/4, 1:1  -> instruction cycles
+ *   P89V51RD2:  Timer0 mode 1        -> machine cycles (12 clocks each)
+ *
+ * Project Setup:
+ *   Add this file and atomic.h to a new project for either device.
+ *   Nothing is printed; results are read in the debugger.
+ *
+ * Reading Results:
+ *   MPLAB X Simulator or Keil Debug (simulator): run until the program
+ *   reaches the final while(1), then add cycles to the Watch window.
+ *   Compare [1]-[3], [5] - [4] and [6] with [0] and [7].
+ *
+ * What to Expect (from the code; this bench has not been run yet):
+ *   ATOMIC_READ is a little over twice the plain read: two loads and a
+ *   compare. SEQ_WRITE is one increment. MASK costs a few cycles more
+ *   than [7] because it saves the bit instead of assuming it was set.
+ ******************************************************************************/
+
+#include "atomic.h"
+#include "bench.h"
+
+#if defined(__C51__)
+
+// A source to mask: serial port; and the global enable
+#define BENCH_ENABLE    ES
+#define BENCH_GLOBAL    EA
+
+#else
+
+// A source to mask: UART receive; and the global enable
+#define BENCH_ENABLE    PIE1bits.RCIE
+#define BENCH_GLOBAL    INTCONbits.GIE
+
+#endif
+
+#define NUM_OPS     8
+
+typedef struct {
+    unsigned long bytes;
+    unsigned int errors;
+} bench_record_t;
+
+// Shared state as an ISR would see it
+volatile unsigned int shared16 = 0x1234;
+volatile unsigned long shared32 = 0x12345678UL;
+volatile unsigned char shared_seq = 0;
+volatile bench_record_t shared_record;
+
+unsigned int bench_ticks;
+unsigned int bench_overhead;
+unsigned int cycles[NUM_OPS];
+unsigned int copy16;
+unsigned long copy32;
+bench_record_t copy_record;
+
+/******************************************************************************
+ * Function: bench_store
+ * Description: Store one measurement, minus the start/stop overhead
+ * Parameters: op - result index
+ * Returns: None
+ ******************************************************************************/
+static void bench_store(unsigned char op) {
+    cycles[op] = bench_ticks - bench_overhead;
+}
+
+/******************************************************************************
+ * Function: main
+ * Description: Time every primitive once
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void main(void) {
+    BENCH_TIMER_INIT();
+    shared_record.bytes = 100000UL;
+    shared_record.errors = 7;
+
+    BENCH_OVERHEAD();
+
+    BENCH_START();
+    copy16 = shared16;
+    BENCH_STOP();
+    bench_store(0);
+
+    BENCH_START();
+    ATOMIC_READ(copy16, shared16);
+    BENCH_STOP();
+    bench_store(1);
+
+    BENCH_START();
+    ATOMIC_READ(copy32, shared32);
+    BENCH_STOP();
+    bench_store(2);
+
+    BENCH_START();
+    ATOMIC_SEQ_WRITE(shared_seq);
+    BENCH_STOP();
+    bench_store(3);
+
+    BENCH_START();
+    copy_record.bytes = shared_record.bytes;
+    copy_record.errors = shared_record.errors;
+    BENCH_STOP();
+    bench_store(4);
+
+    BENCH_START();
+    ATOMIC_SEQ_READ_BEGIN(shared_seq)
+        copy_record.bytes = shared_record.bytes;
+        copy_record.errors = shared_record.errors;
+    ATOMIC_SEQ_READ_END(shared_seq)
+    BENCH_STOP();
+    bench_store(5);
+
+    BENCH_ENABLE = 1;               // Masked and restored, never serviced:
+    BENCH_START();                  // the global enable is still off
+    ATOMIC_MASK_BEGIN(BENCH_ENABLE)
+    ATOMIC_MASK_END(BENCH_ENABLE)
+    BENCH_STOP();
+    bench_store(6);
+    BENCH_ENABLE = 0;
+
+    BENCH_START();
+    BENCH_GLOBAL = 0;
+    BENCH_GLOBAL = 1;
+    BENCH_STOP();
+    bench_store(7);
+    BENCH_GLOBAL = 0;
+
+    while(1);   // Inspect results in the Watch window
+}
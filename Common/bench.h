@@ -0,0 +1,80 @@
+/******************************************************************************
+ * Cycle Benchmarks - Shared Timer and Device Setup
+ * Used by: Common atomic, cmd_parser, filter and numfmt benches;
+ *          Q6_Buzzer_Timer_Interrupt/timer_wheel_bench.c
+ *
+ * Description:
+ *   Every bench times a stretch of code by starting a 16-bit hardware
+ *   timer from 0, stopping it and reading the count. This header holds
+ *   that part once, for both cores:
+ *     PIC18F4550: Timer1 (or Timer3 with BENCH_TIMER 3), Fosc/4, 1:1
+ *                 -> instruction cycles. Also sets the configuration
+ *                 bits, so include it from the bench's main file only.
+ *     P89V51RD2:  Timer0 mode 1 -> machine cycles (12 clocks each)
+ *
+ * Usage:
+ *   unsigned int bench_ticks;               // Defined by the bench
+ *   unsigned int bench_overhead;
+ *
+ *   BENCH_TIMER_INIT();
+ *   BENCH_OVERHEAD();                       // Start/stop cost alone
+ *   BENCH_START();
+ *   ... code under test ...
+ *   BENCH_STOP();                           // bench_ticks = elapsed
+ *   result = bench_ticks - bench_overhead;
+ *
+ * Notes:
+ *   - A count is good up to 65535; split longer runs
+ *   - Interrupts that fire between START and STOP are counted too
+ *   - BENCH_TIMER 3 leaves Timer1 to the code under test; T3CCP2:T3CCP1
+ *     stay 00, so both CCPs keep using Timer1
+ ******************************************************************************/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#if defined(__C51__)
+
+#include <reg51.h>
+
+#define BENCH_TIMER_INIT()  { TMOD = (TMOD & 0xF0) | 0x01; }    // Timer0 mode 1 (16-bit), gate off
+#define BENCH_START()       { TR0 = 0; TH0 = 0; TL0 = 0; TR0 = 1; }
+#define BENCH_STOP()        { TR0 = 0; bench_ticks = ((unsigned int)TH0 << 8) | TL0; }
+
+#else
+
+#include <xc.h>
+#include <pic18f4550.h>
+
+// Configuration Bits
+#pragma config FOSC = INTOSCIO_EC   // Internal oscillator
+#pragma config WDTE = OFF           // Watchdog Timer disabled
+#pragma config PWRTE = OFF          // Power-up Timer disabled
+#pragma config BOREN = OFF          // Brown-out Reset disabled
+#pragma config PBADEN = OFF         // PORTB pins as digital I/O
+#pragma config LVP = OFF            // Low-Voltage Programming disabled
+#pragma config MCLRE = OFF          // MCLR function disabled
+
+// Timer used on the PIC18 (1 or 3)
+#ifndef BENCH_TIMER
+#define BENCH_TIMER         1
+#endif
+
+#if BENCH_TIMER == 3
+#define BENCH_TIMER_INIT()  { T3CON = 0x80; }   // 16-bit read/write, Fosc/4, 1:1, off
+#define BENCH_START()       { T3CONbits.TMR3ON = 0; TMR3H = 0; TMR3L = 0; T3CONbits.TMR3ON = 1; }
+#define BENCH_STOP()        { T3CONbits.TMR3ON = 0; bench_ticks = TMR3L; bench_ticks |= (unsigned int)TMR3H << 8; }
+#elif BENCH_TIMER == 1
+#define BENCH_TIMER_INIT()  { T1CON = 0x80; }   // 16-bit read/write, Fosc/4, 1:1, off
+#define BENCH_START()       { T1CONbits.TMR1ON = 0; TMR1H = 0; TMR1L = 0; T1CONbits.TMR1ON = 1; }
+#define BENCH_STOP()        { T1CONbits.TMR1ON = 0; bench_ticks = TMR1L; bench_ticks |= (unsigned int)TMR1H << 8; }
+#else
+#error "BENCH_TIMER must be 1 or 3"
+#endif
+
+#endif
+
+// Cost of starting and stopping the timer with nothing in between
+#define BENCH_OVERHEAD()    { BENCH_START(); BENCH_STOP(); bench_overhead = bench_ticks; }
+
+#endif
@@ -0,0 +1,241 @@
+/******************************************************************************
+ * Streaming Command Parser - Implementation
+ * See cmd_parser.h for the line format and table rules.
+ *
+ * Compilers: XC8 (PIC18F4550), Keil C51 (P89V51RD2)
+ ******************************************************************************/
+
+#include "cmd_parser.h"
+
+// Parser States
+#define ST_IDLE         0           // Start of line, nothing seen yet
+#define ST_NAME         1           // Reading the command name
+#define ST_GAP          2           // Between tokens
+#define ST_SIGN         3           // '-' seen, expecting a digit
+#define ST_ARG          4           // Reading a numeric argument
+#define ST_UNKNOWN      5           // Name did not match, skip to line end
+#define ST_BAD_ARGS     6           // Argument error, skip to line end
+
+#define NAME_CHAR(p, i) ((p)->table[i].name[(p)->pos])
+
+/******************************************************************************
+ * Function: parser_reset
+ * Description: Prepare for the next line
+ * Parameters: p - parser
+ * Returns: None
+ ******************************************************************************/
+static void parser_reset(cmd_parser_t *p) {
+    p->lo = 0;
+    p->hi = p->count;
+    p->pos = 0;
+    p->state = ST_IDLE;
+    p->argc = 0;
+}
+
+/******************************************************************************
+ * Function: cmd_parser_init
+ * Description: Attach a sorted command table and reset the parser
+ * Parameters: p     - parser
+ *             table - command table sorted by name
+ *             count - number of entries
+ * Returns: None
+ ******************************************************************************/
+void cmd_parser_init(cmd_parser_t *p, const cmd_entry_t *table, unsigned char count) {
+    p->table = table;
+    p->count = count;
+    parser_reset(p);
+}
+
+/******************************************************************************
+ * Function: name_step
+ * Description: Descend one trie level - keep only names whose character at
+ *              the current position equals c
+ * Parameters: p - parser, c - name character
+ * Returns: None
+ ******************************************************************************/
+static void name_step(cmd_parser_t *p, char c) {
+    while(p->lo < p->hi && NAME_CHAR(p, p->lo) < c) {
+        p->lo++;
+    }
+    while(p->hi > p->lo && NAME_CHAR(p, p->hi - 1) > c) {
+        p->hi--;
+    }
+    p->pos++;
+}
+
+/******************************************************************************
+ * Function: name_matched
+ * Description: Check that a name ends exactly at the current position.
+ *              The shortest candidate sorts first, so only table[lo] needs
+ *              to be checked.
+ * Parameters: p - parser
+ * Returns: 1 if table[lo] is the complete name typed, 0 otherwise
+ ******************************************************************************/
+static unsigned char name_matched(cmd_parser_t *p) {
+    return p->lo < p->hi && NAME_CHAR(p, p->lo) == '\0';
+}
+
+/******************************************************************************
+ * Function: add_digit
+ * Description: Append one digit to the argument being read, unless the
+ *              result would leave the int range (CMD_ARG_MAX, one more
+ *              when negative). Compares against constants only, so no
+ *              division runs per digit.
+ * Parameters: p - parser, digit - 0-9
+ * Returns: 1 if the digit was added, 0 if the value is out of range
+ ******************************************************************************/
+static unsigned char add_digit(cmd_parser_t *p, unsigned char digit) {
+    if(p->value > CMD_ARG_MAX / 10 ||
+       (p->value == CMD_ARG_MAX / 10 && digit > CMD_ARG_MAX % 10 + p->negative)) {
+        return 0;
+    }
+    p->value = (p->value << 3) + (p->value << 1) + digit;
+    return 1;
+}
+
+/******************************************************************************
+ * Function: end_arg
+ * Description: Store the argument being read. A negative value is formed
+ *              as -(value - 1) - 1 so that -(CMD_ARG_MAX + 1) never passes
+ *              through an int that cannot hold it.
+ * Parameters: p - parser
+ * Returns: None
+ ******************************************************************************/
+static void end_arg(cmd_parser_t *p) {
+    if(p->negative && p->value) {
+        p->argv[p->argc++] = -(int)(p->value - 1) - 1;
+    } else {
+        p->argv[p->argc++] = (int)p->value;
+    }
+}
+
+/******************************************************************************
+ * Function: end_line
+ * Description: Finish the line: dispatch the matched command or report why
+ *              not. Runs in constant time - the command is already known.
+ * Parameters: p - parser
+ * Returns: CMD_DISPATCHED, CMD_EMPTY, CMD_UNKNOWN or CMD_BAD_ARGS
+ ******************************************************************************/
+static unsigned char end_line(cmd_parser_t *p) {
+    unsigned char result;
+
+    switch(p->state) {
+        case ST_IDLE:
+            result = CMD_EMPTY;
+            break;
+        case ST_NAME:
+            result = name_matched(p) ? CMD_DISPATCHED : CMD_UNKNOWN;
+            break;
+        case ST_ARG:
+            end_arg(p);
+            result = CMD_DISPATCHED;
+            break;
+        case ST_GAP:
+            result = CMD_DISPATCHED;
+            break;
+        case ST_UNKNOWN:
+            result = CMD_UNKNOWN;
+            break;
+        default:                        // ST_SIGN, ST_BAD_ARGS
+            result = CMD_BAD_ARGS;
+            break;
+    }
+
+    if(result == CMD_DISPATCHED) {
+        p->table[p->lo].handler(p->argc, p->argv);
+    }
+    parser_reset(p);
+    return result;
+}
+
+/******************************************************************************
+ * Function: cmd_parser_feed
+ * Description: Advance the parser by one received character
+ * Parameters: p - parser
+ *             c - received character ('\r' or '\n' ends the line)
+ * Returns: CMD_PENDING until a line ends, then the line result
+ ******************************************************************************/
+unsigned char cmd_parser_feed(cmd_parser_t *p, char c) {
+    if(c == '\r' || c == '\n') {
+        return end_line(p);
+    }
+    if(c >= 'a' && c <= 'z') {
+        c -= 'a' - 'A';                 // Fold to upper case
+    }
+
+    switch(p->state) {
+        case ST_IDLE:
+            if(c == ' ') {
+                break;                  // Skip leading spaces
+            }
+            p->state = ST_NAME;
+            name_step(p, c);
+            break;
+
+        case ST_NAME:
+            if(c != ' ') {
+                name_step(p, c);
+            } else if(name_matched(p)) {
+                p->state = ST_GAP;
+            } else {
+                p->state = ST_UNKNOWN;
+            }
+            break;
+
+        case ST_GAP:
+            if(c == ' ') {
+                break;
+            }
+            if(p->argc >= CMD_MAX_ARGS) {
+                p->state = ST_BAD_ARGS;
+                break;
+            }
+            p->value = 0;
+            p->negative = (c == '-');
+            if(p->negative) {
+                p->state = ST_SIGN;
+                break;
+            }
+            // fall through - first digit
+        case ST_SIGN:
+        case ST_ARG:
+            if(c >= '0' && c <= '9' && add_digit(p, c - '0')) {
+                p->state = ST_ARG;
+            } else if(c == ' ' && p->state == ST_ARG) {
+                end_arg(p);
+                p->state = ST_GAP;
+            } else {
+                p->state = ST_BAD_ARGS;
+            }
+            break;
+
+        default:                        // ST_UNKNOWN, ST_BAD_ARGS
+            break;
+    }
+    return CMD_PENDING;
+}
+
+/******************************************************************************
+ * Function: cmd_table_check
+ * Description: Verify that a command table is sorted (debug aid)
+ * Parameters: table - command table, count - number of entries
+ * Returns: Index of the first entry not greater than its predecessor,
+ *          or count if the table is correctly sorted
+ ******************************************************************************/
+unsigned char cmd_table_check(const cmd_entry_t *table, unsigned char count) {
+    unsigned char i;
+    const char *a, *b;
+
+    for(i = 1; i < count; i++) {
+        a = table[i - 1].name;
+        b = table[i].name;
+        while(*a && *a == *b) {
+            a++;
+            b++;
+        }
+        if((unsigned char)*a >= (unsigned char)*b) {
+            return i;
+        }
+    }
+    return count;
+}
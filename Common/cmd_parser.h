@@ -0,0 +1,70 @@
+/******************************************************************************
+ * Streaming Command Parser - Byte-at-a-Time Trie Dispatch
+ * Shared by: PIC18F4550 (XC8) and P89V51RD2 (Keil C51) programs
+ *
+ * Description:
+ *   Parses lines of the form "NAME [arg1 [arg2 ...]]" one received byte
+ *   at a time, so all the work is spread over the character arrivals
+ *   and the command is known the moment the line ending comes in.
+ *
+ *   Commands live in a constant table (program memory) sorted by name.
+ *   A sorted table is a flattened trie: all names sharing the prefix
+ *   typed so far form one contiguous range [lo, hi). Each name byte
+ *   narrows that range by one trie level, moving lo up and hi down;
+ *   since neither ever moves back, a whole line costs at most
+ *   (table size + line length) character compares, however many
+ *   commands there are. At the line ending the match is table[lo]
+ *   (if its name ends exactly there), so dispatch is a fixed number of
+ *   steps regardless of the table size.
+ *
+ *   Numeric arguments are accumulated digit by digit as they arrive
+ *   (value * 10 via shifts and adds). An optional leading '-' makes a
+ *   value negative. Values outside -32768..32767 (int on both targets)
+ *   make the line CMD_BAD_ARGS instead of wrapping. Letters are folded
+ *   to upper case.
+ *
+ * Table Rules:
+ *   - Sorted in ascending ASCII order of name (strcmp order)
+ *   - Names use printable characters other than space
+ *   - At most 255 entries
+ *   cmd_table_check() returns the first entry that breaks the order.
+ ******************************************************************************/
+
+#ifndef CMD_PARSER_H
+#define CMD_PARSER_H
+
+// Limits
+#define CMD_MAX_ARGS        4       // Numeric arguments per command
+#define CMD_ARG_MAX         32767U  // Largest argument; -(CMD_ARG_MAX + 1) is the lowest
+
+// cmd_parser_feed() results
+#define CMD_PENDING         0       // Line not finished yet
+#define CMD_DISPATCHED      1       // Handler was called
+#define CMD_EMPTY           2       // Blank line (nothing to do)
+#define CMD_UNKNOWN         3       // No command with this name
+#define CMD_BAD_ARGS        4       // Non-numeric, out of range or too many arguments
+
+typedef void (*cmd_handler_t)(unsigned char argc, const int *argv);
+
+typedef struct {
+    const char *name;               // Upper-case command name
+    cmd_handler_t handler;          // Called with the parsed arguments
+} cmd_entry_t;
+
+typedef struct {
+    const cmd_entry_t *table;       // Sorted command table
+    unsigned char count;            // Entries in table
+    unsigned char lo, hi;           // Candidate range for the prefix so far
+    unsigned char pos;              // Name characters consumed
+    unsigned char state;            // Parser state (see cmd_parser.c)
+    unsigned char argc;             // Arguments completed so far
+    unsigned char negative;         // Current argument has a '-' sign
+    unsigned int value;             // Current argument magnitude
+    int argv[CMD_MAX_ARGS];
+} cmd_parser_t;
+
+void cmd_parser_init(cmd_parser_t *p, const cmd_entry_t *table, unsigned char count);
+unsigned char cmd_parser_feed(cmd_parser_t *p, char c);
+unsigned char cmd_table_check(const cmd_entry_t *table, unsigned char count);
+
+#endif
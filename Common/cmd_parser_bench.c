@@ -0,0 +1,150 @@
+/******************************************************************************
+ * Command Parser Benchmark - Streaming Trie vs strcmp Chain
+ * Builds for both PIC18F4550 (XC8) and P89V51RD2 (Keil C51)
+ *
+ * Description:
+ *   Feeds test lines one character at a time to cmd_parser_feed() with a
+ *   52-entry command table and records:
+ *     cycles_byte_max[i] - slowest single character of line i
+ *     cycles_eol[i]      - the line ending: lookup finish plus dispatch
+ *   The same lines are then run through the buffer-then-strcmp approach
+ *   of the original process_command(), which compares the finished line
+ *   against each name in turn:
+ *     cycles_strcmp[i]   - the line ending: strcmp search plus dispatch
+ *   Handlers are empty, so the figures are parser/lookup cost only.
+ *
+ * Timer Units:
+ *   PIC18F4550: Timer1, Fosc/4, 1:1  -> instruction cycles
+ *   P89V51RD2:  Timer0 mode 1        -> machine cycles (12 clocks each)
+ *
+ * Project Setup:
+ *   Add this file, cmd_parser.c and cmd_parser.h to a new project for
+ *   either device. Nothing is printed; results are read in the debugger
+ *   (add the three result arrays and bench_hits to the Watch window and
+ *   run to the final while(1)). bench_hits counts dispatches and should
+ *   be 2 * (NUM_LINES - 1): the unknown line matches in neither method.
+ *   Keil C51: handlers reached through a function pointer are outside
+ *   the linker's call tree; if the linker warns, add an OVERLAY directive
+ *   as described in the BL51 manual.
+ *
+ * What to Expect (from the code; this bench has not been run yet):
+ *   strcmp cost grows with the position of the command in the table -
+ *   "VOLT" is compared against every entry before it. The trie cost per
+ *   byte depends on how many neighbouring names are skipped at that
+ *   level, never on the whole table, and the line ending costs the same
+ *   for the first, middle and last command.
+ ******************************************************************************/
+
+#include <string.h>
+#include "cmd_parser.h"
+#include "bench.h"
+
+#define NUM_LINES   6
+#define LINE_SIZE   16
+
+unsigned int bench_ticks;
+unsigned int bench_overhead;
+unsigned int bench_hits;
+unsigned int cycles_byte_max[NUM_LINES];
+unsigned int cycles_eol[NUM_LINES];
+unsigned int cycles_strcmp[NUM_LINES];
+
+static void h(unsigned char argc, const int *argv) {
+    bench_hits++;
+}
+
+// 52 commands, sorted (see cmd_table_check)
+static const cmd_entry_t table[] = {
+    {"ADC_AVG", h}, {"ADC_CH", h}, {"ADC_RATE", h}, {"ADC_READ", h},
+    {"ADC_SCAN", h}, {"BAUD", h}, {"BEEP", h}, {"BLINK", h},
+    {"BUZZ_OFF", h}, {"BUZZ_ON", h}, {"CAL_HI", h}, {"CAL_LO", h},
+    {"CAL_SAVE", h}, {"CAPTURE", h}, {"CLEAR", h}, {"DAC", h},
+    {"DUMP", h}, {"ECHO", h}, {"EE_READ", h}, {"EE_WRITE", h},
+    {"FILTER", h}, {"GAIN", h}, {"HELP", h}, {"ID", h},
+    {"LCD_CLR", h}, {"LCD_PUT", h}, {"LED", h}, {"LED_OFF", h},
+    {"LED_ON", h}, {"LOG_START", h}, {"LOG_STOP", h}, {"MELODY", h},
+    {"MODE", h}, {"PING", h}, {"PROFILE", h}, {"PWM_DUTY", h},
+    {"PWM_FREQ", h}, {"PWM_OFF", h}, {"RESET", h}, {"RXSTATS", h},
+    {"SCAN", h}, {"SEQ", h}, {"STATUS", h}, {"STEP", h},
+    {"TEMP", h}, {"TIMER", h}, {"TONE", h}, {"TRIGGER", h},
+    {"TXBENCH", h}, {"UPTIME", h}, {"VERSION", h}, {"VOLT", h},
+};
+#define NUM_COMMANDS    (sizeof(table) / sizeof(table[0]))
+
+static const char *const lines[NUM_LINES] = {
+    "ADC_AVG\r",            // First entry
+    "LED_ON\r",             // Middle
+    "VOLT\r",               // Last entry
+    "PWM_FREQ 2000\r",      // Numeric argument
+    "LED 1\r",              // Prefix of two other names
+    "LEDX\r"                // Unknown
+};
+
+/******************************************************************************
+ * Function: strcmp_dispatch
+ * Description: Reference method - compare the buffered name against every
+ *              table entry in order, as the original if/else chain did
+ * Parameters: name - command name (arguments already split off)
+ * Returns: None
+ ******************************************************************************/
+static void strcmp_dispatch(const char *name) {
+    unsigned char i;
+
+    for(i = 0; i < NUM_COMMANDS; i++) {
+        if(strcmp(name, table[i].name) == 0) {
+            table[i].handler(0, 0);
+            return;
+        }
+    }
+}
+
+/******************************************************************************
+ * Function: main
+ * Description: Time both methods over every test line
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void main(void) {
+    static cmd_parser_t parser;
+    static char name[LINE_SIZE];
+    unsigned char i, len;
+    const char *s;
+
+    BENCH_TIMER_INIT();
+    cmd_parser_init(&parser, table, NUM_COMMANDS);
+    if(cmd_table_check(table, NUM_COMMANDS) != NUM_COMMANDS) {
+        while(1);                   // Table out of order - fix before timing
+    }
+
+    BENCH_OVERHEAD();
+
+    for(i = 0; i < NUM_LINES; i++) {
+        // Streaming parser: time every character separately
+        cycles_byte_max[i] = 0;
+        for(s = lines[i]; *s != '\r'; s++) {
+            BENCH_START();
+            cmd_parser_feed(&parser, *s);
+            BENCH_STOP();
+            if(bench_ticks - bench_overhead > cycles_byte_max[i]) {
+                cycles_byte_max[i] = bench_ticks - bench_overhead;
+            }
+        }
+        BENCH_START();
+        cmd_parser_feed(&parser, '\r');
+        BENCH_STOP();
+        cycles_eol[i] = bench_ticks - bench_overhead;
+
+        // Buffer the name, then search at the line ending
+        len = 0;
+        for(s = lines[i]; *s != '\r' && *s != ' '; s++) {
+            name[len++] = *s;
+        }
+        name[len] = '\0';
+        BENCH_START();
+        strcmp_dispatch(name);
+        BENCH_STOP();
+        cycles_strcmp[i] = bench_ticks - bench_overhead;
+    }
+
+    while(1);   // Inspect results in the Watch window
+}
@@ -0,0 +1,139 @@
+/******************************************************************************
+ * Fixed-Point Sample Filters - Implementation
+ * See filter.h for the filter types and their coefficient ranges.
+ ******************************************************************************/
+
+#include "filter.h"
+
+// 8x8 -> 16 bit multiply; one MULWF (PIC18) or MUL AB (8051)
+#define MUL8X8(a, b)    ((unsigned int)(unsigned char)(a) * (unsigned char)(b))
+
+// Exchange a and b so that a <= b
+#define SORT2(a, b)     { if((a) > (b)) { t = (a); (a) = (b); (b) = t; } }
+
+/******************************************************************************
+ * Function: filter_init
+ * Description: Select the filter type; history is filled by the first
+ *              sample passed to filter_run()
+ * Parameters: f    - filter state
+ *             type - FILTER_xxx
+ *             coef - BOXCAR: log2 window (1-4), IIR: shift (1 to
+ *                    FILTER_IIR_MAX_SHIFT), IIR_Q15: alpha * 32768
+ *                    (1-32767), others: ignored. Shifts above the
+ *                    maximum are clamped to it.
+ * Returns: None
+ ******************************************************************************/
+void filter_init(filter_t *f, unsigned char type, unsigned int coef) {
+    if(type == FILTER_BOXCAR && coef > FILTER_BOXCAR_MAX_SHIFT) {
+        coef = FILTER_BOXCAR_MAX_SHIFT;
+    }
+    if(type == FILTER_IIR && coef > FILTER_IIR_MAX_SHIFT) {
+        coef = FILTER_IIR_MAX_SHIFT;
+    }
+    f->type = type;
+    f->coef = coef;
+    f->primed = 0;
+    f->pos = 0;
+    f->state = 0;
+}
+
+/******************************************************************************
+ * Function: q15_step
+ * Description: alpha * diff / 32768, rounded, from four 8x8 multiplies
+ * Parameters: alpha - Q15 coefficient (0-32767)
+ *             diff  - magnitude of the difference (0-32767)
+ * Returns: Scaled magnitude
+ ******************************************************************************/
+static unsigned int q15_step(unsigned int alpha, unsigned int diff) {
+    unsigned char al = (unsigned char)alpha, ah = (unsigned char)(alpha >> 8);
+    unsigned char dl = (unsigned char)diff, dh = (unsigned char)(diff >> 8);
+    unsigned long product;
+
+    product  = MUL8X8(al, dl);
+    product += (unsigned long)MUL8X8(al, dh) << 8;
+    product += (unsigned long)MUL8X8(ah, dl) << 8;
+    product += (unsigned long)MUL8X8(ah, dh) << 16;
+
+    // >> 15 as << 1 then take the upper word: byte moves, no shift loop
+    return (unsigned int)(((product + 0x4000UL) << 1) >> 16);
+}
+
+/******************************************************************************
+ * Function: filter_run
+ * Description: Feed one sample and return the filtered value
+ * Parameters: f - filter state, x - new sample (0-4095)
+ * Returns: Filtered value, same scale as x
+ ******************************************************************************/
+unsigned int filter_run(filter_t *f, unsigned int x) {
+    unsigned int a, b, c, d, e, t;
+    unsigned char i;
+
+    if(!f->primed) {
+        f->primed = 1;
+        for(i = 0; i < FILTER_HISTORY; i++) {
+            f->hist[i] = x;
+        }
+        if(f->type == FILTER_BOXCAR || f->type == FILTER_IIR) {
+            f->state = x << f->coef;
+        } else if(f->type == FILTER_IIR_Q15) {
+            f->state = x << FILTER_Q15_FRAC;
+        }
+    }
+
+    switch(f->type) {
+    case FILTER_BOXCAR:
+        // Window of 2^coef slots: add the new sample, drop the oldest
+        i = f->pos;
+        f->state += x - f->hist[i];
+        f->hist[i] = x;
+        f->pos = (i + 1) & ((1 << f->coef) - 1);
+        return f->state >> f->coef;
+
+    case FILTER_IIR:
+        // state = y * 2^coef: state += x - y
+        f->state += x - (f->state >> f->coef);
+        return f->state >> f->coef;
+
+    case FILTER_IIR_Q15:
+        a = x << FILTER_Q15_FRAC;
+        if(a >= f->state) {
+            f->state += q15_step(f->coef, a - f->state);
+        } else {
+            f->state -= q15_step(f->coef, f->state - a);
+        }
+        return (f->state + (1 << (FILTER_Q15_FRAC - 1))) >> FILTER_Q15_FRAC;
+
+    case FILTER_MEDIAN3:
+        i = f->pos;
+        f->hist[i] = x;
+        f->pos = (i == 2) ? 0 : i + 1;
+        a = f->hist[0];
+        b = f->hist[1];
+        c = f->hist[2];
+        SORT2(a, b);                        // a <= b
+        if(c >= b) return b;
+        return (c > a) ? c : a;
+
+    case FILTER_MEDIAN5:
+        i = f->pos;
+        f->hist[i] = x;
+        f->pos = (i == 4) ? 0 : i + 1;
+        a = f->hist[0];
+        b = f->hist[1];
+        c = f->hist[2];
+        d = f->hist[3];
+        e = f->hist[4];
+        // 7 compare-exchanges leave the median in c
+        SORT2(a, b);
+        SORT2(d, e);
+        SORT2(a, d);
+        SORT2(b, e);
+        SORT2(b, c);
+        SORT2(c, d);
+        SORT2(b, c);
+        return c;
+
+    default:
+        return x;
+    }
+}
@@ -0,0 +1,77 @@
+/******************************************************************************
+ * Fixed-Point Sample Filters - Boxcar, Single-Pole IIR, Median
+ * Shared by: PIC18F4550 (XC8) and P89V51RD2 (Keil C51) programs
+ *
+ * Description:
+ *   Integer-only filters for ADC results of up to 12 bits, one filter_t
+ *   per channel, each with its own type. No floats, no division: every
+ *   filter is cheap enough to run inside an ADC interrupt.
+ *
+ *   FILTER_BOXCAR    Mean of the last 2^coef samples (coef 1-4). A
+ *                    running sum is updated with the new sample and the
+ *                    one leaving the window, so the cost does not grow
+ *                    with the length.
+ *   FILTER_IIR       y += (x - y) / 2^coef (coef 1 to FILTER_IIR_MAX_SHIFT,
+ *                    4 for 12-bit input). The state holds y * 2^coef, so
+ *                    the fraction is kept and the output settles to
+ *                    within 1 LSB of a constant input.
+ *   FILTER_IIR_Q15   y += alpha * (x - y) with alpha = coef / 32768
+ *                    (coef 1-32767) for time constants that are not a
+ *                    power of two. State is 12.3 fixed point; the
+ *                    15 x 15 bit product is built from four 8 x 8
+ *                    hardware multiplies (MULWF on PIC18, MUL AB on 8051).
+ *                    Settles within 1 LSB for alpha >= 0.1 (3277); the
+ *                    error grows as 1/(16 * alpha) below that.
+ *   FILTER_MEDIAN3   Median of the last 3 (or 5) samples: removes single
+ *   FILTER_MEDIAN5   (or double) spikes completely instead of smearing
+ *                    them, and passes steps without rounding them.
+ *   FILTER_NONE      Output = input.
+ *
+ *   The first sample fills the whole history, so there is no start-up
+ *   ramp from zero.
+ *
+ * Cost per Sample (PIC18F4550, instruction cycles, estimates for XC8 in
+ * free mode until measured with filter_bench.c):
+ *   NONE ~10   BOXCAR ~50   IIR ~40 + 6 per coef step   IIR_Q15 ~110
+ *   MEDIAN3 ~50   MEDIAN5 ~150
+ *   At 8 MHz that is 5-75 us; the 8051 needs roughly as many machine
+ *   cycles (1.085 us each at 11.0592 MHz).
+ ******************************************************************************/
+
+#ifndef FILTER_H
+#define FILTER_H
+
+// Filter Types
+#define FILTER_NONE         0
+#define FILTER_BOXCAR       1
+#define FILTER_IIR          2
+#define FILTER_IIR_Q15      3
+#define FILTER_MEDIAN3      4
+#define FILTER_MEDIAN5      5
+
+// Longest boxcar window (2^4 samples; sum of 16 x 4095 fits 16 bits)
+#define FILTER_BOXCAR_MAX_SHIFT 4
+#define FILTER_HISTORY      (1 << FILTER_BOXCAR_MAX_SHIFT)
+
+// Longest IIR shift (4095 x 2^4 fits the 16-bit state; a project whose
+// inputs are all 10-bit may define 6)
+#ifndef FILTER_IIR_MAX_SHIFT
+#define FILTER_IIR_MAX_SHIFT    4
+#endif
+
+// Fraction bits of the IIR_Q15 state (12-bit input + 3 = 15 bits)
+#define FILTER_Q15_FRAC     3
+
+typedef struct {
+    unsigned char type;             // FILTER_xxx
+    unsigned char primed;           // History holds real samples
+    unsigned char pos;              // Next history slot
+    unsigned int coef;              // Shift (BOXCAR, IIR) or Q15 alpha
+    unsigned int state;             // Running sum or IIR state
+    unsigned int hist[FILTER_HISTORY];
+} filter_t;
+
+void filter_init(filter_t *f, unsigned char type, unsigned int coef);
+unsigned int filter_run(filter_t *f, unsigned int x);
+
+#endif
@@ -0,0 +1,103 @@
+/******************************************************************************
+ * Sample Filter Benchmark - Cycles per Sample for Each Filter Type
+ * Builds for both PIC18F4550 (XC8) and P89V51RD2 (Keil C51)
+ *
+ * Description:
+ *   Feeds the same noisy test signal through every filter type in
+ *   filter.h and times each filter_run() call with a hardware timer.
+ *   For each type the shortest and longest call are kept (the median
+ *   and IIR_Q15 paths depend on the data), minus the measured
+ *   start/stop overhead.
+ *
+ * Timer Units:
+ *   PIC18F4550: Timer1, Fosc/4, 1:1  -> instruction cycles
+ *   P89V51RD2:  Timer0 mode 1        -> machine cycles (12 clocks each)
+ *
+ * Project Setup:
+ *   Add this file, filter.c and filter.h to a new project for either
+ *   device. Nothing is printed; results are read in the debugger.
+ *
+ * Reading Results:
+ *   MPLAB X Simulator or Keil Debug (simulator): run until the program
+ *   reaches the final while(1), then add cycles_min and cycles_max to
+ *   the Watch window. Entry [i] belongs to filter type i (FILTER_NONE,
+ *   BOXCAR, IIR, IIR_Q15, MEDIAN3, MEDIAN5). Copy the figures into the
+ *   "Cost per Sample" table in filter.h.
+ *
+ * What to Expect (from the code; this bench has not been run yet):
+ *   BOXCAR and IIR cost the same for every sample and do not depend on
+ *   the window length (IIR only adds one 16-bit shift step per coef).
+ *   IIR_Q15 pays four 8x8 multiplies: single instructions on both cores,
+ *   so the 32-bit additions around them dominate. MEDIAN5 is the most
+ *   expensive: seven compare-exchanges of 16-bit values.
+ ******************************************************************************/
+
+#include "filter.h"
+#include "bench.h"
+
+#define NUM_TYPES   6
+#define NUM_SAMPLES 64
+
+// Coefficient used for each type (NONE, BOXCAR 16, IIR 1/16, Q15 0.1, -, -)
+static const unsigned int bench_coef[NUM_TYPES] = {0, 4, 4, 3277, 0, 0};
+
+unsigned int bench_ticks;
+unsigned int bench_overhead;
+unsigned int cycles_min[NUM_TYPES];
+unsigned int cycles_max[NUM_TYPES];
+unsigned int bench_output;
+filter_t bench_filter;
+
+/******************************************************************************
+ * Function: test_sample
+ * Description: Test signal: a slow ramp with pseudo-random noise of a
+ *              few LSB and an occasional spike
+ * Parameters: n - sample number
+ * Returns: 12-bit sample
+ ******************************************************************************/
+static unsigned int test_sample(unsigned char n) {
+    static unsigned int lfsr = 0xACE1;
+
+    lfsr = (lfsr >> 1) ^ (-(lfsr & 1) & 0xB400);    // 16-bit Galois LFSR
+    if((n & 15) == 7) {
+        return 4000;                                // Spike
+    }
+    return 1000 + ((unsigned int)n << 4) + (lfsr & 7);
+}
+
+/******************************************************************************
+ * Function: main
+ * Description: Run the test signal through every filter type and record
+ *              the fastest and slowest call
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void main(void) {
+    unsigned char type, n;
+    unsigned int x;
+
+    BENCH_TIMER_INIT();
+
+    BENCH_OVERHEAD();
+
+    for(type = 0; type < NUM_TYPES; type++) {
+        filter_init(&bench_filter, type, bench_coef[type]);
+        cycles_min[type] = 0xFFFF;
+        cycles_max[type] = 0;
+
+        // First call fills the history: not part of the steady state
+        bench_output = filter_run(&bench_filter, test_sample(0));
+
+        for(n = 1; n < NUM_SAMPLES; n++) {
+            x = test_sample(n);
+            BENCH_START();
+            bench_output = filter_run(&bench_filter, x);
+            BENCH_STOP();
+            bench_ticks -= bench_overhead;
+            if(bench_ticks < cycles_min[type]) cycles_min[type] = bench_ticks;
+            if(bench_ticks > cycles_max[type]) cycles_max[type] = bench_ticks;
+        }
+    }
+
+    while(1);   // Inspect results in the Watch window
+}
@@ -0,0 +1,184 @@
+/******************************************************************************
+ * Binary Frame Codec - Implementation
+ * See frame.h for the frame layout.
+ *
+ * Compilers: XC8 (PIC18F4550), Keil C51 (P89V51RD2), g++ (host tools)
+ ******************************************************************************/
+
+#include "frame.h"
+
+#if FRAME_RAW_MAX > 253
+#error "FRAME_MAX_PAYLOAD too large: frame_encode() assumes a single COBS block"
+#endif
+
+#define CRC_INIT    0xFFFF
+
+/******************************************************************************
+ * Function: frame_crc16
+ * Description: Add one byte to a CRC-16/CCITT-FALSE
+ *              (bytewise form of the 0x1021 polynomial, no table)
+ * Parameters: crc  - CRC so far (start with 0xFFFF)
+ *             data - next byte
+ * Returns: Updated CRC
+ ******************************************************************************/
+unsigned int frame_crc16(unsigned int crc, unsigned char data) {
+    unsigned char x;
+
+    x = (unsigned char)(crc >> 8) ^ data;
+    x ^= x >> 4;
+    crc = (crc << 8) ^ ((unsigned int)x << 12) ^ ((unsigned int)x << 5) ^ x;
+    return crc & 0xFFFF;
+}
+
+/******************************************************************************
+ * Function: frame_encode
+ * Description: Build the wire form of one frame. Every raw frame is
+ *              shorter than 254 bytes, so COBS needs exactly one code
+ *              byte in front plus one for each 0x00 in the data: each
+ *              zero is replaced by the distance to the next zero (or to
+ *              the end of the frame).
+ * Parameters: out     - destination, FRAME_ENCODED_MAX bytes
+ *             type    - message type
+ *             seq     - sequence number
+ *             payload - payload bytes (may be 0 if length is 0)
+ *             length  - payload bytes, at most FRAME_MAX_PAYLOAD
+ * Returns: Bytes written including the delimiter, 0 if length too large
+ ******************************************************************************/
+unsigned char frame_encode(unsigned char *out, unsigned char type, unsigned char seq,
+                           const unsigned char *payload, unsigned char length) {
+    unsigned int crc = CRC_INIT;
+    unsigned char code_pos = 0;         // Where the current code byte goes
+    unsigned char pos = 1;
+    unsigned char i, data;
+
+    if(length > FRAME_MAX_PAYLOAD) {
+        return 0;
+    }
+
+    for(i = 0; i < length + FRAME_OVERHEAD; i++) {
+        if(i == 0) {
+            data = type;
+        } else if(i == 1) {
+            data = seq;
+        } else if(i < length + 2) {
+            data = payload[i - 2];
+        } else if(i == length + 2) {
+            data = (unsigned char)crc;
+        } else {
+            data = (unsigned char)(crc >> 8);
+        }
+        if(i < length + 2) {
+            crc = frame_crc16(crc, data);
+        }
+
+        if(data == 0) {
+            out[code_pos] = pos - code_pos; // Distance to this zero
+            code_pos = pos++;
+        } else {
+            out[pos++] = data;
+        }
+    }
+    out[code_pos] = pos - code_pos;
+    out[pos++] = FRAME_DELIMITER;
+    return pos;
+}
+
+/******************************************************************************
+ * Function: frame_decoder_init
+ * Description: Reset a decoder to wait for the start of a frame
+ * Parameters: d - decoder
+ * Returns: None
+ ******************************************************************************/
+void frame_decoder_init(frame_decoder_t *d) {
+    d->len = 0;
+    d->code = 0;
+    d->left = 0;
+    d->error = 0;
+}
+
+/******************************************************************************
+ * Function: frame_end
+ * Description: Check a complete raw frame and publish its fields
+ * Parameters: d - decoder
+ * Returns: FRAME_OK, FRAME_BAD_CRC or FRAME_BAD_FORMAT
+ ******************************************************************************/
+static unsigned char frame_end(frame_decoder_t *d) {
+    unsigned int crc = CRC_INIT;
+    unsigned char i, n;
+
+    if(d->error || d->left != 0 || d->len < FRAME_OVERHEAD) {
+        return FRAME_BAD_FORMAT;
+    }
+
+    n = d->len - 2;
+    for(i = 0; i < n; i++) {
+        crc = frame_crc16(crc, d->buf[i]);
+    }
+    if(d->buf[n] != (unsigned char)crc || d->buf[n + 1] != (unsigned char)(crc >> 8)) {
+        return FRAME_BAD_CRC;
+    }
+
+    d->type = d->buf[0];
+    d->seq = d->buf[1];
+    d->payload = &d->buf[2];
+    d->length = n - 2;
+    return FRAME_OK;
+}
+
+/******************************************************************************
+ * Function: frame_put
+ * Description: Store one decoded byte, flagging frames that are too long
+ * Parameters: d - decoder, data - decoded byte
+ * Returns: None
+ ******************************************************************************/
+static void frame_put(frame_decoder_t *d, unsigned char data) {
+    if(d->len < FRAME_RAW_MAX) {
+        d->buf[d->len++] = data;
+    } else {
+        d->error = 1;
+    }
+}
+
+/******************************************************************************
+ * Function: frame_decoder_feed
+ * Description: Process one received byte. A code byte n announces n - 1
+ *              data bytes followed by a zero; the zero is only written
+ *              once the next code byte shows the frame continues (the
+ *              last block's zero is not part of the frame). Code 0xFF
+ *              (254 data bytes, no zero) cannot occur with these frame
+ *              sizes and is handled by the length check.
+ * Parameters: d    - decoder
+ *             data - received byte
+ * Returns: FRAME_PENDING, or the frame result when a delimiter arrives
+ ******************************************************************************/
+unsigned char frame_decoder_feed(frame_decoder_t *d, unsigned char data) {
+    unsigned char result;
+
+    if(data == FRAME_DELIMITER) {
+        if(d->len == 0 && d->code == 0 && !d->error) {
+            return FRAME_PENDING;           // Empty frame: just resync
+        }
+        result = frame_end(d);
+        d->len = 0;
+        d->code = 0;
+        d->left = 0;
+        d->error = 0;
+        return result;
+    }
+
+    if(d->error) {
+        return FRAME_PENDING;               // Skip to the next delimiter
+    }
+
+    if(d->left == 0) {
+        if(d->code != 0 && d->code != 0xFF) {
+            frame_put(d, 0);                // Zero implied by the previous block
+        }
+        d->code = data;
+        d->left = data - 1;
+    } else {
+        frame_put(d, data);
+        d->left--;
+    }
+    return FRAME_PENDING;
+}
@@ -0,0 +1,74 @@
+/******************************************************************************
+ * Binary Frame Codec - COBS Framing with CRC-16
+ * Shared by: PIC18F4550 (XC8), P89V51RD2 (Keil C51) and the Linux host
+ *            tools in Host/ (compiled there as C++)
+ *
+ * Description:
+ *   Packs a message into a self-delimiting frame for a byte stream such
+ *   as the UART:
+ *
+ *     raw frame:   [type][seq][payload 0..FRAME_MAX_PAYLOAD][crc lo][crc hi]
+ *     on the wire: COBS(raw frame) 0x00
+ *
+ *   COBS (Consistent Overhead Byte Stuffing) removes every 0x00 from the
+ *   frame at a cost of one extra byte (frames here are shorter than 254
+ *   bytes), so 0x00 only ever appears as the frame delimiter. A receiver
+ *   that joins mid-stream or loses a byte resynchronises at the next
+ *   0x00; no escape sequences or length fields are needed.
+ *
+ *   The CRC is CRC-16/CCITT-FALSE (polynomial 0x1021, initial 0xFFFF)
+ *   over type, seq and payload, sent low byte first. It is computed
+ *   byte-wise without a table (a few shifts and XORs per byte).
+ *
+ * Encoding:
+ *   frame_encode() writes a complete wire frame (delimiter included) to
+ *   a buffer of FRAME_ENCODED_MAX bytes. The caller then hands the bytes
+ *   to its transmitter at whatever pace it allows.
+ *
+ * Decoding:
+ *   frame_decoder_feed() takes one received byte at a time and undoes
+ *   the COBS stuffing as it goes. When the delimiter arrives it checks
+ *   length and CRC and returns FRAME_OK with type, seq, payload and
+ *   length filled in. Empty frames (back-to-back delimiters) are ignored,
+ *   so a sender may start with 0x00 to flush a half-received frame.
+ ******************************************************************************/
+
+#ifndef FRAME_H
+#define FRAME_H
+
+// Frame Sizes
+#define FRAME_MAX_PAYLOAD   64
+#define FRAME_OVERHEAD      4       // type + seq + 2 CRC bytes
+#define FRAME_RAW_MAX       (FRAME_MAX_PAYLOAD + FRAME_OVERHEAD)
+#define FRAME_ENCODED_MAX   (FRAME_RAW_MAX + 2)     // COBS code + delimiter
+#define FRAME_DELIMITER     0x00
+
+// frame_decoder_feed() results
+#define FRAME_PENDING       0       // Frame not complete yet
+#define FRAME_OK            1       // Valid frame available in the decoder
+#define FRAME_BAD_CRC       2       // Frame complete but CRC mismatch
+#define FRAME_BAD_FORMAT    3       // Broken COBS, too short or too long
+
+typedef struct {
+    unsigned char buf[FRAME_RAW_MAX];   // Decoded raw frame
+    unsigned char len;                  // Bytes in buf
+    unsigned char code;                 // Current COBS code byte
+    unsigned char left;                 // Data bytes left in this COBS block
+    unsigned char error;                // Frame is broken, wait for delimiter
+
+    // Valid after FRAME_OK (until the next byte is fed)
+    unsigned char type;
+    unsigned char seq;
+    unsigned char *payload;
+    unsigned char length;               // Payload bytes
+} frame_decoder_t;
+
+unsigned int frame_crc16(unsigned int crc, unsigned char data);
+
+unsigned char frame_encode(unsigned char *out, unsigned char type, unsigned char seq,
+                           const unsigned char *payload, unsigned char length);
+
+void frame_decoder_init(frame_decoder_t *d);
+unsigned char frame_decoder_feed(frame_decoder_t *d, unsigned char data);
+
+#endif
@@ -0,0 +1,234 @@
+/******************************************************************************
+ * Number Formatting Library - Implementation
+ * See numfmt.h for the API, width/padding rules and buffer sizes.
+ *
+ * Compilers: XC8 (PIC18F4550), Keil C51 (P89V51RD2)
+ *
+ * Double Dabble (shift-and-add-3):
+ *   The binary value is shifted into a packed BCD register one bit at a
+ *   time, MSB first. Before each shift, every BCD digit >= 5 gets 3 added
+ *   so that doubling it carries correctly into the next decimal digit.
+ *   A 16-bit value needs at most 16 shifts of a 3-byte BCD register (leading
+ *   zero bits are skipped); no divide or modulo is ever executed.
+ ******************************************************************************/
+
+#include "numfmt.h"
+
+/******************************************************************************
+ * Function: bcd_shift_in
+ * Description: One double-dabble step - add 3 to digits >= 5, then shift
+ *              the packed BCD register left by one bit
+ * Parameters: bcd   - packed BCD register, least significant byte first
+ *             n     - register length in bytes
+ *             carry - binary bit shifted into the least significant digit
+ * Returns: None
+ ******************************************************************************/
+static void bcd_shift_in(unsigned char *bcd, unsigned char n, unsigned char carry) {
+    unsigned char b;
+
+    while(n--) {
+        b = *bcd;
+        if((b & 0x0F) >= 0x05) b += 0x03;   // Low digit >= 5
+        if(b >= 0x50) b += 0x30;            // High digit >= 5
+        *bcd++ = (unsigned char)(b << 1) | carry;
+        carry = b >> 7;
+    }
+}
+
+/******************************************************************************
+ * Function: bcd_to_text
+ * Description: Write packed BCD digits as right-aligned ASCII text
+ * Parameters: buf     - output buffer
+ *             bcd     - packed BCD digits, least significant byte first
+ *             ndigits - number of digits held in bcd
+ *             width   - minimum field width (0 = no padding)
+ *             pad     - ' ' or '0'
+ *             sign    - '-' for negative values, 0 otherwise
+ * Returns: Number of characters written (excluding '\0')
+ ******************************************************************************/
+static unsigned char bcd_to_text(char *buf, const unsigned char *bcd,
+                                 unsigned char ndigits, unsigned char width,
+                                 char pad, char sign) {
+    unsigned char sig, len, fill, d;
+    char *p = buf;
+
+    // Count significant digits (at least one, so zero prints as "0")
+    sig = ndigits;
+    while(sig > 1) {
+        d = bcd[(sig - 1) >> 1];
+        if((sig - 1) & 1) d >>= 4;
+        if(d & 0x0F) break;
+        sig--;
+    }
+
+    len = sig + (sign ? 1 : 0);
+    fill = (width > len) ? (width - len) : 0;
+
+    if(pad == '0') {
+        if(sign) *p++ = sign;
+        while(fill--) *p++ = '0';
+    } else {
+        while(fill--) *p++ = pad;
+        if(sign) *p++ = sign;
+    }
+
+    while(sig--) {
+        d = bcd[sig >> 1];
+        if(sig & 1) d >>= 4;
+        *p++ = '0' + (d & 0x0F);
+    }
+    *p = '\0';
+
+    return (unsigned char)(p - buf);
+}
+
+/******************************************************************************
+ * Function: fmt_bcd8 / fmt_bcd16 / fmt_bcd32
+ * Description: Convert binary to packed BCD (e.g. 1234 -> 0x34, 0x12, 0x00)
+ * Parameters: value - binary input
+ *             bcd   - output, 2 / 3 / 5 bytes, least significant first
+ * Returns: None
+ ******************************************************************************/
+void fmt_bcd8(unsigned char value, unsigned char *bcd) {
+    unsigned char i;
+
+    bcd[0] = 0;
+    bcd[1] = 0;
+    for(i = 0; i < 8 && !(value & 0x80); i++) {
+        value <<= 1;                        // Skip leading zero bits
+    }
+    for(; i < 8; i++) {
+        bcd_shift_in(bcd, 2, value >> 7);
+        value <<= 1;
+    }
+}
+
+void fmt_bcd16(unsigned int value, unsigned char *bcd) {
+    unsigned char i;
+
+    bcd[0] = 0;
+    bcd[1] = 0;
+    bcd[2] = 0;
+    for(i = 0; i < 16 && !(value & 0x8000u); i++) {
+        value <<= 1;                        // Skip leading zero bits
+    }
+    for(; i < 16; i++) {
+        bcd_shift_in(bcd, 3, (value & 0x8000u) ? 1 : 0);
+        value <<= 1;
+    }
+}
+
+void fmt_bcd32(unsigned long value, unsigned char *bcd) {
+    unsigned char i;
+
+    for(i = 0; i < 5; i++) {
+        bcd[i] = 0;
+    }
+    for(i = 0; i < 32 && !(value & 0x80000000ul); i++) {
+        value <<= 1;                        // Skip leading zero bits
+    }
+    for(; i < 32; i++) {
+        bcd_shift_in(bcd, 5, (value & 0x80000000ul) ? 1 : 0);
+        value <<= 1;
+    }
+}
+
+/******************************************************************************
+ * Function: fmt_u8 / fmt_u16 / fmt_u32
+ * Description: Unsigned decimal text
+ * Parameters: buf   - output buffer (see numfmt.h for sizes)
+ *             value - number to convert
+ *             width - minimum field width (0 = no padding)
+ *             pad   - ' ' or '0'
+ * Returns: Number of characters written (excluding '\0')
+ ******************************************************************************/
+unsigned char fmt_u8(char *buf, unsigned char value, unsigned char width, char pad) {
+    unsigned char bcd[2];
+
+    fmt_bcd8(value, bcd);
+    return bcd_to_text(buf, bcd, 3, width, pad, 0);
+}
+
+unsigned char fmt_u16(char *buf, unsigned int value, unsigned char width, char pad) {
+    unsigned char bcd[3];
+
+    fmt_bcd16(value, bcd);
+    return bcd_to_text(buf, bcd, 5, width, pad, 0);
+}
+
+unsigned char fmt_u32(char *buf, unsigned long value, unsigned char width, char pad) {
+    unsigned char bcd[5];
+
+    fmt_bcd32(value, bcd);
+    return bcd_to_text(buf, bcd, 10, width, pad, 0);
+}
+
+/******************************************************************************
+ * Function: fmt_s8 / fmt_s16 / fmt_s32
+ * Description: Signed decimal text ('-' only for negative values)
+ * Parameters: Same as fmt_u8 / fmt_u16 / fmt_u32
+ * Returns: Number of characters written (excluding '\0')
+ ******************************************************************************/
+unsigned char fmt_s8(char *buf, signed char value, unsigned char width, char pad) {
+    unsigned char bcd[2];
+
+    if(value < 0) {
+        fmt_bcd8((unsigned char)(0 - (unsigned char)value), bcd);
+        return bcd_to_text(buf, bcd, 3, width, pad, '-');
+    }
+    fmt_bcd8((unsigned char)value, bcd);
+    return bcd_to_text(buf, bcd, 3, width, pad, 0);
+}
+
+unsigned char fmt_s16(char *buf, int value, unsigned char width, char pad) {
+    unsigned char bcd[3];
+
+    if(value < 0) {
+        fmt_bcd16(0u - (unsigned int)value, bcd);
+        return bcd_to_text(buf, bcd, 5, width, pad, '-');
+    }
+    fmt_bcd16((unsigned int)value, bcd);
+    return bcd_to_text(buf, bcd, 5, width, pad, 0);
+}
+
+unsigned char fmt_s32(char *buf, long value, unsigned char width, char pad) {
+    unsigned char bcd[5];
+
+    if(value < 0) {
+        fmt_bcd32(0ul - (unsigned long)value, bcd);
+        return bcd_to_text(buf, bcd, 10, width, pad, '-');
+    }
+    fmt_bcd32((unsigned long)value, bcd);
+    return bcd_to_text(buf, bcd, 10, width, pad, 0);
+}
+
+/******************************************************************************
+ * Function: fmt_hex8 / fmt_hex16 / fmt_hex32
+ * Description: Fixed-width upper-case hexadecimal text ("0A", "03FF", ...)
+ * Parameters: buf   - output buffer (3 / 5 / 9 bytes)
+ *             value - number to convert
+ * Returns: Number of characters written (2 / 4 / 8)
+ ******************************************************************************/
+static char hex_digit(unsigned char n) {
+    n &= 0x0F;
+    return (n < 10) ? ('0' + n) : ('A' - 10 + n);
+}
+
+unsigned char fmt_hex8(char *buf, unsigned char value) {
+    buf[0] = hex_digit(value >> 4);
+    buf[1] = hex_digit(value);
+    buf[2] = '\0';
+    return 2;
+}
+
+unsigned char fmt_hex16(char *buf, unsigned int value) {
+    fmt_hex8(buf, (unsigned char)(value >> 8));
+    fmt_hex8(buf + 2, (unsigned char)value);
+    return 4;
+}
+
+unsigned char fmt_hex32(char *buf, unsigned long value) {
+    fmt_hex16(buf, (unsigned int)(value >> 16));
+    fmt_hex16(buf + 4, (unsigned int)value);
+    return 8;
+}
@@ -0,0 +1,54 @@
+/******************************************************************************
+ * Number Formatting Library - Integer to Decimal/Hex Text
+ * Shared by: PIC18F4550 (XC8) and P89V51RD2 (Keil C51) programs
+ *
+ * Description:
+ *   Converts 8/16/32-bit integers to ASCII without division, printf or
+ *   heap. Decimal conversion uses the shift-and-add-3 ("double dabble")
+ *   algorithm into packed BCD, which costs only shifts, compares and adds
+ *   on 8-bit cores that have no hardware divider.
+ *
+ *   All text functions write into a caller-provided buffer, append '\0'
+ *   and return the number of characters written (excluding the '\0').
+ *
+ * Width and Padding (decimal functions):
+ *   width = 0    -> minimum number of digits, no padding
+ *   width = N    -> right aligned in at least N characters
+ *   pad   = ' '  -> leading spaces, sign next to the digits ("  42", " -42")
+ *   pad   = '0'  -> leading zeros, sign first ("0042", "-042")
+ *   Values wider than width are printed in full (width is a minimum).
+ *
+ * Buffer Sizes (including '\0'):
+ *   fmt_u8: 4   fmt_u16: 6   fmt_u32: 11   (or width + 1 if larger)
+ *   fmt_s8: 5   fmt_s16: 7   fmt_s32: 12
+ *   fmt_hex8: 3 fmt_hex16: 5 fmt_hex32: 9
+ *
+ * Project Setup:
+ *   Add Common/numfmt.c to Source Files and Common/numfmt.h to Header
+ *   Files (MPLAB X), or to Source Group 1 (Keil uVision).
+ ******************************************************************************/
+
+#ifndef NUMFMT_H
+#define NUMFMT_H
+
+// Packed BCD conversion (bcd[0] holds the two least significant digits)
+void fmt_bcd8(unsigned char value, unsigned char *bcd);      // bcd[2]
+void fmt_bcd16(unsigned int value, unsigned char *bcd);      // bcd[3]
+void fmt_bcd32(unsigned long value, unsigned char *bcd);     // bcd[5]
+
+// Unsigned decimal
+unsigned char fmt_u8(char *buf, unsigned char value, unsigned char width, char pad);
+unsigned char fmt_u16(char *buf, unsigned int value, unsigned char width, char pad);
+unsigned char fmt_u32(char *buf, unsigned long value, unsigned char width, char pad);
+
+// Signed decimal
+unsigned char fmt_s8(char *buf, signed char value, unsigned char width, char pad);
+unsigned char fmt_s16(char *buf, int value, unsigned char width, char pad);
+unsigned char fmt_s32(char *buf, long value, unsigned char width, char pad);
+
+// Hexadecimal, fixed width, upper case, no "0x" prefix
+unsigned char fmt_hex8(char *buf, unsigned char value);
+unsigned char fmt_hex16(char *buf, unsigned int value);
+unsigned char fmt_hex32(char *buf, unsigned long value);
+
+#endif
@@ -0,0 +1,124 @@
+/******************************************************************************
+ * Number Formatting Benchmark - Double Dabble vs Divide-by-10
+ * Builds for both PIC18F4550 (XC8) and P89V51RD2 (Keil C51)
+ *
+ * Description:
+ *   Times fmt_u16()/fmt_u32() against the classic "% 10, / 10" digit loop
+ *   used by uart_send_number() for a set of test values. A hardware timer
+ *   is started and stopped around each call and the elapsed count, minus
+ *   the measured start/stop overhead, is stored in the result arrays.
+ *
+ * Timer Units:
+ *   PIC18F4550: Timer1, Fosc/4, 1:1  -> instruction cycles
+ *   P89V51RD2:  Timer0 mode 1        -> machine cycles (12 clocks each)
+ *
+ * Project Setup:
+ *   Add this file, numfmt.c and numfmt.h to a new project for either
+ *   device. Nothing is printed; results are read in the debugger.
+ *
+ * Reading Results:
+ *   MPLAB X Simulator or Keil Debug (simulator): run until the program
+ *   reaches the final while(1), then add cycles_div16, cycles_bcd16,
+ *   cycles_div32 and cycles_bcd32 to the Watch window. Entry [i] belongs
+ *   to test16[i] / test32[i].
+ *
+ * What to Expect (from the code; this bench has not been run yet):
+ *   Both cores lack a hardware divider, so each % and / is a library
+ *   call that loops over all 16 (or 32) quotient bits; the division loop
+ *   pays two of these per decimal digit. Double dabble pays one shift of
+ *   the BCD register per significant input bit, so its advantage grows
+ *   with the number of digits and is largest for 32-bit values. For
+ *   single-digit inputs the two approaches are close.
+ ******************************************************************************/
+
+#include "numfmt.h"
+#include "bench.h"
+
+#define NUM_TESTS   5
+
+static const unsigned int test16[NUM_TESTS] = {7, 99, 1023, 12345, 65535};
+static const unsigned long test32[NUM_TESTS] = {7, 65535, 1000000, 123456789, 4294967295ul};
+
+unsigned int bench_ticks;
+unsigned int bench_overhead;
+unsigned int cycles_div16[NUM_TESTS];
+unsigned int cycles_bcd16[NUM_TESTS];
+unsigned int cycles_div32[NUM_TESTS];
+unsigned int cycles_bcd32[NUM_TESTS];
+char bench_text[12];
+
+/******************************************************************************
+ * Function: div_u16 / div_u32
+ * Description: Reference conversion using % 10 and / 10 per digit, as in
+ *              uart_send_number() before numfmt was introduced
+ * Parameters: buf - output buffer, value - number to convert
+ * Returns: None
+ ******************************************************************************/
+static void div_u16(char *buf, unsigned int value) {
+    char tmp[5];
+    unsigned char i = 0;
+
+    do {
+        tmp[i++] = (value % 10) + '0';
+        value /= 10;
+    } while(value > 0);
+
+    while(i > 0) {
+        *buf++ = tmp[--i];
+    }
+    *buf = '\0';
+}
+
+static void div_u32(char *buf, unsigned long value) {
+    char tmp[10];
+    unsigned char i = 0;
+
+    do {
+        tmp[i++] = (value % 10) + '0';
+        value /= 10;
+    } while(value > 0);
+
+    while(i > 0) {
+        *buf++ = tmp[--i];
+    }
+    *buf = '\0';
+}
+
+/******************************************************************************
+ * Function: main
+ * Description: Run every test value through both converters and record
+ *              the elapsed timer ticks
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void main(void) {
+    unsigned char i;
+
+    BENCH_TIMER_INIT();
+
+    BENCH_OVERHEAD();
+
+    for(i = 0; i < NUM_TESTS; i++) {
+        BENCH_START();
+        div_u16(bench_text, test16[i]);
+        BENCH_STOP();
+        cycles_div16[i] = bench_ticks - bench_overhead;
+
+        BENCH_START();
+        fmt_u16(bench_text, test16[i], 0, ' ');
+        BENCH_STOP();
+        cycles_bcd16[i] = bench_ticks - bench_overhead;
+
+        BENCH_START();
+        div_u32(bench_text, test32[i]);
+        BENCH_STOP();
+        cycles_div32[i] = bench_ticks - bench_overhead;
+
+        BENCH_START();
+        fmt_u32(bench_text, test32[i], 0, ' ');
+        BENCH_STOP();
+        cycles_bcd32[i] = bench_ticks - bench_overhead;
+    }
+
+    while(1);   // Inspect results in the Watch window
+}
@@ -0,0 +1,331 @@
+/******************************************************************************
+ * Section Profiler - Implementation
+ * See profile.h for how sections are declared and what is measured.
+ *
+ * Compilers: XC8 (PIC18F4550), Keil C51 (P89V51RD2)
+ ******************************************************************************/
+
+#include "profile.h"
+
+#if PROFILE
+
+#include "numfmt.h"
+#include "atomic.h"
+
+#if defined(__C51__)
+#include <reg52.h>
+#else
+#include <xc.h>
+#include <pic18f4550.h>
+#endif
+
+unsigned char profile_errors = 0;
+
+// Timer overflows so far: bits 16-31 of the timestamp
+static volatile unsigned int overflows = 0;
+
+// Cycles taken by one profile_now() call, subtracted from each section
+static unsigned long overhead = 0;
+
+// Open sections, innermost last
+static unsigned char depth = 0;
+static unsigned char open_id[PROFILE_DEPTH];
+static unsigned long open_start[PROFILE_DEPTH];
+static unsigned long open_nested[PROFILE_DEPTH];
+
+#if defined(__C51__)
+
+/******************************************************************************
+ * Function: profile_timer2_isr
+ * Description: Timer2 overflow: count bits 16-31 of the timestamp
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void profile_timer2_isr(void) interrupt 5 {
+    TF2 = 0;                        // Not cleared by hardware
+    overflows++;
+}
+
+/******************************************************************************
+ * Function: profile_now
+ * Description: 32-bit timestamp in machine cycles
+ * Parameters: None
+ * Returns: Overflow count in the high word, Timer2 in the low word
+ ******************************************************************************/
+unsigned long profile_now(void) {
+    unsigned char high, low;
+    unsigned int upper;
+
+    ATOMIC_MASK_BEGIN(ET2)          // Hold off only the overflow count
+        high = TH2;
+        low = TL2;
+        if(high != TH2) {           // TL2 wrapped between the two reads
+            high = TH2;
+            low = TL2;
+        }
+        upper = overflows;
+        if(TF2 && !(high & 0x80)) { // Wrapped before the read, not counted
+            upper++;
+        }
+    ATOMIC_MASK_END(ET2)
+    return ((unsigned long)upper << 16) | ((unsigned int)high << 8) | low;
+}
+
+/******************************************************************************
+ * Function: timer_start
+ * Description: Timer2 free running over all 16 bits (reload value 0)
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+static void timer_start(void) {
+    T2CON = 0x00;                   // Timer, auto-reload, stopped
+    RCAP2H = 0;
+    RCAP2L = 0;
+    TH2 = 0;
+    TL2 = 0;
+    TF2 = 0;
+    ET2 = 1;
+    TR2 = 1;
+}
+
+#else
+
+/******************************************************************************
+ * Function: profile_isr
+ * Description: Timer3 overflow: count bits 16-31 of the timestamp. Call
+ *              from the application's ISR.
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void profile_isr(void) {
+    if(PIE2bits.TMR3IE && PIR2bits.TMR3IF) {
+        PIR2bits.TMR3IF = 0;
+        overflows++;
+    }
+}
+
+/******************************************************************************
+ * Function: profile_now
+ * Description: 32-bit timestamp in instruction cycles
+ * Parameters: None
+ * Returns: Overflow count in the high word, Timer3 in the low word
+ ******************************************************************************/
+unsigned long profile_now(void) {
+    unsigned int low, upper;
+
+    ATOMIC_MASK_BEGIN(PIE2bits.TMR3IE)  // Hold off only the overflow count
+        low = TMR3L;                    // Latches TMR3H (RD16)
+        low |= (unsigned int)TMR3H << 8;
+        upper = overflows;
+        if(PIR2bits.TMR3IF && !(low & 0x8000)) {    // Wrapped, not counted
+            upper++;
+        }
+    ATOMIC_MASK_END(PIE2bits.TMR3IE)
+    return ((unsigned long)upper << 16) | low;
+}
+
+/******************************************************************************
+ * Function: timer_start
+ * Description: Timer3 free running at Fosc/4 1:1 with its overflow
+ *              interrupt; the caller enables PEIE and GIE
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+static void timer_start(void) {
+    // RD16, 1:1, Fosc/4, on; T3CCP2:T3CCP1 = 00 leaves both CCPs on Timer1
+    T3CON = 0x81;
+    PIR2bits.TMR3IF = 0;
+    PIE2bits.TMR3IE = 1;
+}
+
+#endif
+
+/******************************************************************************
+ * Function: profile_reset
+ * Description: Clear every section's statistics and the error count
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void profile_reset(void) {
+    unsigned char i;
+
+    for(i = 0; i < profile_count; i++) {
+        profile_data[i].count = 0;
+        profile_data[i].total = 0;
+        profile_data[i].self = 0;
+        profile_data[i].min = 0xFFFFFFFFUL;
+        profile_data[i].max = 0;
+    }
+    profile_errors = 0;
+}
+
+/******************************************************************************
+ * Function: profile_init
+ * Description: Clear the statistics, start the timer and measure the
+ *              cost of one timestamp
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void profile_init(void) {
+    unsigned long first;
+
+    profile_reset();
+    depth = 0;
+    timer_start();
+
+    first = profile_now();
+    overhead = profile_now() - first;
+}
+
+/******************************************************************************
+ * Function: profile_begin
+ * Description: Open a section; the timestamp is taken last so the
+ *              bookkeeping is not counted
+ * Parameters: id - section id from PROFILE_SECTIONS
+ * Returns: None
+ ******************************************************************************/
+void profile_begin(unsigned char id) {
+    unsigned char level = depth;
+
+    depth++;
+    if(level >= PROFILE_DEPTH) {
+        profile_errors++;           // Too deep: not recorded
+        return;
+    }
+    open_id[level] = id;
+    open_nested[level] = 0;
+    open_start[level] = profile_now();
+}
+
+/******************************************************************************
+ * Function: profile_end
+ * Description: Close the innermost section and add the pass to its
+ *              statistics; the timestamp is taken first
+ * Parameters: id - section id, must match the innermost profile_begin
+ * Returns: None
+ ******************************************************************************/
+void profile_end(unsigned char id) {
+    unsigned long now = profile_now();
+    unsigned long elapsed, self;
+    profile_section_t *s;
+
+    if(depth == 0) {
+        profile_errors++;
+        return;
+    }
+    depth--;
+    if(depth >= PROFILE_DEPTH || open_id[depth] != id) {
+        profile_errors++;
+        return;
+    }
+
+    elapsed = now - open_start[depth];
+    elapsed = elapsed > overhead ? elapsed - overhead : 0;
+    self = elapsed > open_nested[depth] ? elapsed - open_nested[depth] : 0;
+    if(depth > 0) {
+        open_nested[depth - 1] += elapsed;
+    }
+
+    s = &profile_data[id];
+    if(s->count != 0xFFFF) {
+        s->count++;
+        s->total += elapsed;
+        s->self += self;
+    }
+    if(elapsed < s->min) {
+        s->min = elapsed;
+    }
+    if(elapsed > s->max) {
+        s->max = elapsed;
+    }
+}
+
+/******************************************************************************
+ * Function: profile_report
+ * Description: One line per section that has run, e.g.
+ *                display_adc n=40 avg 2310 min 2288 max 2904 self 1350
+ *              followed by "profile errors n" if any pass was dropped
+ * Parameters: out - function that sends a string (UART, LCD, ...)
+ * Returns: None
+ ******************************************************************************/
+void profile_report(profile_out_t out) {
+    profile_section_t *s;
+    char number[11];
+    unsigned char i;
+
+    for(i = 0; i < profile_count; i++) {
+        s = &profile_data[i];
+        if(s->count == 0) {
+            continue;
+        }
+        out(profile_names[i]);
+        out(" n=");
+        fmt_u16(number, s->count, 0, ' ');
+        out(number);
+        out(" avg ");
+        fmt_u32(number, s->total / s->count, 0, ' ');
+        out(number);
+        out(" min ");
+        fmt_u32(number, s->min, 0, ' ');
+        out(number);
+        out(" max ");
+        fmt_u32(number, s->max, 0, ' ');
+        out(number);
+        out(" self ");
+        fmt_u32(number, s->self / s->count, 0, ' ');
+        out(number);
+        out("\r\n");
+    }
+    if(profile_errors) {
+        out("profile errors ");
+        fmt_u8(number, profile_errors, 0, ' ');
+        out(number);
+        out("\r\n");
+    }
+}
+
+/******************************************************************************
+ * Function: profile_cycles5
+ * Description: A cycle count in exactly 5 characters: "  2310", then
+ *              thousands ("1900k", truncated) above 99999 and millions
+ *              ("4294M") above 9999999
+ * Parameters: buf - at least 6 characters, cycles - value to print
+ * Returns: None
+ ******************************************************************************/
+static void profile_cycles5(char *buf, unsigned long cycles) {
+    if(cycles <= 99999UL) {
+        fmt_u32(buf, cycles, 5, ' ');
+        return;
+    }
+    if(cycles <= 9999999UL) {
+        fmt_u32(buf, cycles / 1000UL, 4, ' ');
+        buf[4] = 'k';
+    } else {
+        fmt_u32(buf, cycles / 1000000UL, 4, ' ');
+        buf[4] = 'M';
+    }
+    buf[5] = '\0';
+}
+
+/******************************************************************************
+ * Function: profile_summary
+ * Description: Average and maximum cycles of one section as exactly 16
+ *              characters for an LCD line: "avg   2310/ 2904", or
+ *              "avg   190k/ 230k" style above 99999 (profile_cycles5)
+ * Parameters: id - section id, line - PROFILE_SUMMARY_LEN characters
+ * Returns: None
+ ******************************************************************************/
+void profile_summary(unsigned char id, char *line) {
+    profile_section_t *s = &profile_data[id];
+
+    line[0] = 'a';
+    line[1] = 'v';
+    line[2] = 'g';
+    line[3] = ' ';
+    line[4] = ' ';
+    profile_cycles5(line + 5, s->count ? s->total / s->count : 0);
+    line[10] = '/';
+    profile_cycles5(line + 11, s->count ? s->max : 0);
+}
+
+#endif
@@ -0,0 +1,130 @@
+/******************************************************************************
+ * Section Profiler - Cycle Counts for Named Blocks of Main-Loop Code
+ * Shared by: PIC18F4550 (XC8) and P89V51RD2 (Keil C51) programs
+ *
+ * Description:
+ *   Wrap any stretch of code in PROFILE_BEGIN(id) / PROFILE_END(id) and
+ *   every pass adds to that section's call count and total, min and max
+ *   cycles. Sections may nest (up to PROFILE_DEPTH deep); each also
+ *   keeps its self time, i.e. the total minus the sections nested in it.
+ *
+ *   Sections are declared once, at compile time, by the application
+ *   before it includes this header:
+ *
+ *     #define PROFILE_SECTIONS(X)             \
+ *         X(PROF_LCD_INIT, "lcd_init")        \
+ *         X(PROF_DISPLAY,  "display_adc")
+ *     #include "../../Common/profile.h"
+ *     PROFILE_TABLE();                        // once, at file scope
+ *
+ *   which gives the ids PROF_LCD_INIT, PROF_DISPLAY and PROFILE_COUNT,
+ *   the name table and the statistics array.
+ *
+ *   With PROFILE 0 (default) the macros are empty and nothing is built;
+ *   define PROFILE=1 for the whole project to switch it on.
+ *
+ * Timebase:
+ *   A free-running 16-bit hardware timer, extended to 32 bits by counting
+ *   its overflows in an interrupt, so a section may run for minutes:
+ *     PIC18F4550: Timer3, Fosc/4, 1:1  -> instruction cycles
+ *                 (2^32 cycles = 36 min at 8 MHz). The application's ISR
+ *                 must call profile_isr().
+ *     P89V51RD2:  Timer2, 16-bit auto-reload from 0 -> machine cycles
+ *                 (12 clocks, 1.085 us at 11.0592 MHz). profile.c owns
+ *                 the Timer2 interrupt (vector 5); set EA = 1.
+ *   Reading the time masks only the timer's own interrupt enable, never
+ *   the global one. The cost of one timestamp is measured by
+ *   profile_init() and subtracted from every section.
+ *
+ * Cost (estimates, not yet measured): PROFILE_BEGIN + PROFILE_END about
+ * 150 instruction cycles on PIC18 (XC8 free mode), about 250 machine
+ * cycles on the 8051 (32-bit arithmetic). A parent's self time includes
+ * the profiler calls of the sections nested in it.
+ *
+ * Rules:
+ *   - Main context only: a section must not be opened in an ISR
+ *   - END must name the innermost open section; a mismatch, or nesting
+ *     deeper than PROFILE_DEPTH, is counted in profile_errors and the
+ *     pass is not recorded
+ *   - Timer3 can be shared with Drivers/isr_stats.c (same setting), but
+ *     not with adc_sampler.c or adc_scanner.c
+ *
+ * Reports:
+ *   profile_report(out) writes one line per section through any
+ *   "send a string" function, e.g. uart_send_string. profile_summary()
+ *   formats avg/max into 16 characters for an LCD line, switching to
+ *   k (thousands) or M (millions) of cycles above 99999. The raw figures
+ *   are in profile_data[] for a debugger Watch window.
+ ******************************************************************************/
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#ifndef PROFILE
+#define PROFILE             0
+#endif
+
+// Deepest nesting of open sections
+#ifndef PROFILE_DEPTH
+#define PROFILE_DEPTH       4
+#endif
+
+// profile_summary() buffer: one 16-column LCD line plus the terminator
+#define PROFILE_SUMMARY_LEN (16 + 1)
+
+typedef struct {
+    unsigned int count;             // Completed passes (stops at 65535)
+    unsigned long total;            // Cycles including nested sections
+    unsigned long self;             // Cycles minus nested sections
+    unsigned long min;
+    unsigned long max;
+} profile_section_t;
+
+typedef void (*profile_out_t)(const char *text);
+
+// Section ids from the application's PROFILE_SECTIONS list
+#ifdef PROFILE_SECTIONS
+#define PROFILE_ID(id, name)    id,
+#define PROFILE_NAME(id, name)  name,
+enum { PROFILE_SECTIONS(PROFILE_ID) PROFILE_COUNT };
+#endif
+
+#if PROFILE
+
+#define PROFILE_TABLE()                                                     \
+    profile_section_t profile_data[PROFILE_COUNT];                          \
+    const char * const profile_names[PROFILE_COUNT] = {                     \
+        PROFILE_SECTIONS(PROFILE_NAME)                                      \
+    };                                                                      \
+    const unsigned char profile_count = PROFILE_COUNT
+
+#define PROFILE_BEGIN(id)       profile_begin(id)
+#define PROFILE_END(id)         profile_end(id)
+
+// Defined by PROFILE_TABLE() in the application
+extern profile_section_t profile_data[];
+extern const char * const profile_names[];
+extern const unsigned char profile_count;
+
+extern unsigned char profile_errors;
+
+void profile_init(void);
+unsigned long profile_now(void);
+void profile_begin(unsigned char id);
+void profile_end(unsigned char id);
+void profile_reset(void);
+void profile_report(profile_out_t out);
+void profile_summary(unsigned char id, char *line);
+#if !defined(__C51__)
+void profile_isr(void);
+#endif
+
+#else
+
+#define PROFILE_TABLE()         extern unsigned char profile_unused
+#define PROFILE_BEGIN(id)
+#define PROFILE_END(id)
+
+#endif
+
+#endif
@@ -0,0 +1,400 @@
+/******************************************************************************
+ * Q7 Binary Link - Command Line Tool
+ *
+ * Usage:
+ *   link_cli <tty> [--baud N] ping [count]
+ *   link_cli <tty> [--baud N] status
+ *   link_cli <tty> [--baud N] led 0|1
+ *   link_cli <tty> [--baud N] stream <frames>
+ *   link_cli <tty> [--baud N] log <seconds> [file.csv]
+ *   link_cli <tty> [--baud N] scope rising|falling|level <level> <pre> <post> [file.csv]
+ *
+ *   <tty> is the USB-Serial adapter (e.g. /dev/ttyUSB0) or the pty name
+ *   printed by link_sim. --baud defaults to 9600 and must match
+ *   UART_BAUD on the board.
+ *
+ * Build (from this directory):
+ *   g++ -std=c++17 -O2 -Wall -o link_cli -x c++ ../../Common/frame.c -x none link_cli.cpp link_host.cpp
+ *
+ * stream reports the measured payload throughput and what the same
+ * samples would cost as ASCII text lines ("12345\r\n") at the same line
+ * rate.
+ * log listens to Q8 adc_logger.c: it unpacks the sample blocks (and
+ * writes one sample per line to file.csv if given), checks the block
+ * numbers for gaps and prints each ADC_STATS report from the board.
+ * scope arms Q8 adc_scope.c, waits (up to a minute) for the trigger,
+ * prints a text plot of the capture and writes "index,value" lines
+ * (index 0 = trigger sample) to file.csv if given.
+ ******************************************************************************/
+
+#include "link_host.hpp"
+#include "../../PIC18F4550/Q7_UART_Serial_Communication/link_protocol.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int REPLY_TIMEOUT_MS = 1000;
+
+double seconds_since(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+const char *status_text(uint8_t status) {
+    switch(status) {
+        case LINK_OK:         return "ok";
+        case LINK_ERR_TYPE:   return "unknown request";
+        case LINK_ERR_LENGTH: return "bad length";
+        default:              return "unknown status";
+    }
+}
+
+// Send a request and check the status byte of the reply
+bool transact(Link &link, uint8_t type, const std::vector<uint8_t> &payload, Frame &reply) {
+    if(!link.request(type, payload, reply, REPLY_TIMEOUT_MS)) {
+        std::printf("No reply (timeout)\n");
+        return false;
+    }
+    if(reply.payload.empty() || reply.payload[0] != LINK_OK) {
+        std::printf("Error: %s\n", reply.payload.empty() ? "empty reply" : status_text(reply.payload[0]));
+        return false;
+    }
+    return true;
+}
+
+int cmd_ping(Link &link, unsigned count) {
+    Frame reply;
+    std::vector<uint8_t> payload;
+    double total = 0;
+
+    for(unsigned i = 0; i < 32; i++) {
+        payload.push_back(uint8_t(i * 37));     // Includes 0x00 bytes
+    }
+    for(unsigned n = 0; n < count; n++) {
+        payload[0] = uint8_t(n);
+        auto t0 = Clock::now();
+        if(!transact(link, MSG_PING, payload, reply)) {
+            return 1;
+        }
+        total += seconds_since(t0);
+        if(std::vector<uint8_t>(reply.payload.begin() + 1, reply.payload.end()) != payload) {
+            std::printf("PING %u: echo mismatch\n", n);
+            return 1;
+        }
+    }
+    std::printf("PING ok, %u x %zu bytes, average rtt %.2f ms\n", count, payload.size(),
+                total * 1000.0 / count);
+    return 0;
+}
+
+int cmd_status(Link &link) {
+    Frame reply;
+
+    if(!transact(link, MSG_STATUS, {}, reply)) {
+        return 1;
+    }
+    if(reply.payload.size() != STATUS_REPLY_LEN) {
+        std::printf("Bad STATUS length %zu\n", reply.payload.size());
+        return 1;
+    }
+    const uint8_t *p = reply.payload.data();
+    std::printf("Baud:          %u\n", get_u32(p + 1));
+    std::printf("SPBRG:         0x%04X\n", get_u16(p + 5));
+    std::printf("Frames RX:     %u\n", get_u16(p + 7));
+    std::printf("CRC errors:    %u\n", get_u16(p + 9));
+    std::printf("Format errors: %u\n", get_u16(p + 11));
+    std::printf("UART dropped:  %u\n", get_u16(p + 13));
+    return 0;
+}
+
+int cmd_led(Link &link, unsigned on) {
+    Frame reply;
+
+    if(!transact(link, MSG_LED, {uint8_t(on ? 1 : 0)}, reply)) {
+        return 1;
+    }
+    std::printf("LED %s\n", on ? "on" : "off");
+    return 0;
+}
+
+int cmd_stream(Link &link, unsigned frames, unsigned baud) {
+    unsigned received = 0, lost = 0, bad_samples = 0;
+    uint64_t payload_bytes = 0, wire_bytes = 0, ascii_bytes = 0;
+    uint8_t expect_seq = 0;
+    uint16_t expect_sample = 0;
+    Clock::time_point first, last;
+    Frame frame, reply;
+
+    // Count everything that is not the reply
+    link.on_unsolicited = [&](const Frame &f) {
+        if(f.type != MSG_STREAM_DATA) {
+            return;
+        }
+        last = Clock::now();
+        if(received == 0) {
+            first = last;
+            expect_seq = f.seq;
+            expect_sample = get_u16(f.payload.data());
+        } else {
+            payload_bytes += f.payload.size();  // Bytes after the first frame
+            wire_bytes += f.payload.size() + FRAME_OVERHEAD + 2;
+        }
+        lost += uint8_t(f.seq - expect_seq);
+        expect_seq = uint8_t(f.seq + 1);
+        for(size_t i = 0; i + 1 < f.payload.size(); i += 2) {
+            uint16_t v = get_u16(&f.payload[i]);
+            if(v != expect_sample) {
+                bad_samples++;
+            }
+            expect_sample = uint16_t(v + 1);
+            ascii_bytes += std::to_string(v).size() + 2;    // "value\r\n"
+        }
+        received++;
+    };
+
+    std::vector<uint8_t> count;
+    put_u16(count, uint16_t(frames));
+    if(!transact(link, MSG_STREAM, count, reply)) {
+        return 1;
+    }
+    while(received + lost < frames && link.receive(frame, REPLY_TIMEOUT_MS)) {
+        link.on_unsolicited(frame);
+    }
+
+    double t = std::chrono::duration<double>(last - first).count();
+    unsigned samples = received * STREAM_WORDS;
+    std::printf("Frames:        %u received, %u lost, %u bad samples\n", received, lost, bad_samples);
+    std::printf("CRC/format:    %u / %u errors\n", link.crc_errors, link.format_errors);
+    if(received < 2 || t <= 0) {
+        std::printf("Too few frames to measure throughput\n");
+        return received == frames ? 0 : 1;
+    }
+    double payload_rate = payload_bytes / t;
+    double wire_rate = wire_bytes / t;
+    double ascii_per_byte = double(ascii_bytes) / (samples * 2.0);
+    std::printf("Payload:       %.0f bytes/s (%.0f samples/s)\n", payload_rate, payload_rate / 2);
+    std::printf("Wire:          %.0f bytes/s of %u available at %u baud\n", wire_rate, baud / 10, baud);
+    std::printf("Efficiency:    %.1f%% payload\n", 100.0 * payload_bytes / wire_bytes);
+    std::printf("ASCII equiv.:  %.2f wire bytes per payload byte -> %.0f samples/s (%.1fx slower)\n",
+                ascii_per_byte, wire_rate / ascii_per_byte / 2,
+                ascii_per_byte * payload_bytes / wire_bytes);
+    return (lost || bad_samples) ? 1 : 0;
+}
+
+int cmd_log(Link &link, unsigned seconds, const char *path) {
+    std::ofstream out;
+    unsigned blocks = 0, lost = 0;
+    uint64_t samples = 0;
+    uint16_t expect_block = 0;
+    Clock::time_point first, last;
+    Frame frame;
+
+    if(path) {
+        out.open(path);
+        if(!out) {
+            std::printf("Cannot create %s\n", path);
+            return 1;
+        }
+    }
+
+    auto t0 = Clock::now();
+    while(seconds_since(t0) < seconds) {
+        if(!link.receive(frame, REPLY_TIMEOUT_MS)) {
+            std::printf("No data from the logger (timeout)\n");
+            continue;
+        }
+        if(frame.type == MSG_ADC_BLOCK && frame.payload.size() == ADC_BLOCK_LEN) {
+            uint16_t number = get_u16(frame.payload.data());
+            last = Clock::now();
+            if(blocks == 0) {
+                first = last;
+            } else {
+                lost += uint16_t(number - expect_block);
+            }
+            expect_block = uint16_t(number + 1);
+            blocks++;
+            for(uint16_t v : unpack10(frame.payload.data() + 2, frame.payload.size() - 2)) {
+                if(out) {
+                    out << v << '\n';
+                }
+                samples++;
+            }
+        } else if(frame.type == MSG_ADC_STATS && frame.payload.size() == ADC_STATS_LEN) {
+            const uint8_t *p = frame.payload.data();
+            std::printf("Rate %5u/%u Hz  missed %u  dropped %u (host saw %u)  sent %u  headroom %u%%\n",
+                        get_u16(p), get_u16(p + 9), get_u16(p + 2), get_u16(p + 4), lost,
+                        get_u16(p + 6), p[8]);
+        }
+    }
+
+    std::printf("Received:      %u blocks, %llu samples, %u blocks lost\n", blocks,
+                (unsigned long long)samples, lost);
+    std::printf("CRC/format:    %u / %u errors\n", link.crc_errors, link.format_errors);
+    double t = std::chrono::duration<double>(last - first).count();
+    if(blocks > 1 && t > 0) {
+        std::printf("Host rate:     %.0f samples/s (block arrival times)\n",
+                    (blocks - 1 + lost) * double(ADC_BLOCK_SAMPLES) / t);
+    }
+    return lost ? 1 : 0;
+}
+
+int cmd_scope(Link &link, int argc, char **argv, int arg) {
+    static const char *const modes[] = {"rising", "falling", "level"};
+    const int plot_rows = 16, plot_cols = 64;
+    const int capture_timeout_ms = 60000;
+    Frame reply, frame;
+    int mode = -1;
+
+    if(arg + 4 > argc) {
+        return -1;
+    }
+    for(int m = 0; m < 3; m++) {
+        if(std::strcmp(argv[arg], modes[m]) == 0) {
+            mode = m;
+        }
+    }
+    if(mode < 0) {
+        return -1;
+    }
+    unsigned level = unsigned(std::strtoul(argv[arg + 1], nullptr, 10));
+    unsigned pre = unsigned(std::strtoul(argv[arg + 2], nullptr, 10));
+    unsigned post = unsigned(std::strtoul(argv[arg + 3], nullptr, 10));
+    const char *path = arg + 4 < argc ? argv[arg + 4] : nullptr;
+
+    std::vector<uint8_t> arm = {uint8_t(mode)};
+    put_u16(arm, uint16_t(level));
+    put_u16(arm, uint16_t(pre));
+    put_u16(arm, uint16_t(post));
+    if(!transact(link, MSG_SCOPE_ARM, arm, reply)) {
+        return 1;
+    }
+    std::printf("Armed: %s at %u, %u pre / %u post samples - waiting for trigger\n",
+                modes[mode], level, pre, post);
+
+    // Header, then data frames until all samples are in
+    while(link.receive(frame, capture_timeout_ms) && frame.type != MSG_SCOPE_HEADER);
+    if(frame.type != MSG_SCOPE_HEADER || frame.payload.size() != SCOPE_HEADER_LEN) {
+        std::printf("No trigger (timeout)\n");
+        return 1;
+    }
+    const uint8_t *h = frame.payload.data();
+    unsigned rate = get_u16(h + 2);
+    size_t total = get_u16(h + 4) + 1 + get_u16(h + 6);
+    std::vector<uint16_t> samples(total, 0);
+    size_t have = 0;
+    std::printf("Capture %u: %u Hz, trigger value %u\n", get_u16(h), rate, get_u16(h + 8));
+
+    while(have < total && link.receive(frame, REPLY_TIMEOUT_MS)) {
+        if(frame.type != MSG_SCOPE_DATA || frame.payload.size() < 2) {
+            continue;
+        }
+        size_t index = get_u16(frame.payload.data());
+        for(uint16_t v : unpack10(frame.payload.data() + 2, frame.payload.size() - 2)) {
+            if(index < total) {
+                samples[index++] = v;
+                have++;
+            }
+        }
+    }
+    if(have < total) {
+        std::printf("Capture incomplete: %zu of %zu samples\n", have, total);
+        return 1;
+    }
+
+    // Text plot: columns are equal slices of the capture, each drawn from
+    // its minimum to its maximum; '|' marks the trigger column
+    size_t per_col = (total + plot_cols - 1) / plot_cols;
+    int cols = int((total + per_col - 1) / per_col);
+    int trig_col = int(pre / per_col);
+    for(int row = plot_rows - 1; row >= 0; row--) {
+        std::printf("%4u ", unsigned(row * 1024 / plot_rows));
+        for(int c = 0; c < cols; c++) {
+            uint16_t lo = 1023, hi = 0;
+            for(size_t i = c * per_col; i < (c + 1) * per_col && i < total; i++) {
+                lo = std::min(lo, samples[i]);
+                hi = std::max(hi, samples[i]);
+            }
+            bool lit = int(lo * plot_rows / 1024) <= row && row <= int(hi * plot_rows / 1024);
+            std::putchar(lit ? '#' : (c == trig_col ? '|' : ' '));
+        }
+        std::putchar('\n');
+    }
+    std::printf("     %.2f ms per column, trigger at column %d\n",
+                per_col * 1000.0 / rate, trig_col);
+
+    if(path) {
+        std::ofstream out(path);
+        for(size_t i = 0; i < total; i++) {
+            out << long(i) - long(pre) << ',' << samples[i] << '\n';
+        }
+        std::printf("Wrote %s\n", path);
+    }
+    return 0;
+}
+
+void usage() {
+    std::fprintf(stderr,
+                 "usage: link_cli <tty> [--baud N] ping [count] | status | led 0|1 | stream <frames>\n"
+                 "                                 | log <seconds> [file.csv]\n"
+                 "                                 | scope rising|falling|level <level> <pre> <post> [file.csv]\n");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if(argc < 3) {
+        usage();
+        return 2;
+    }
+    std::string tty = argv[1];
+    unsigned baud = 9600;
+    int arg = 2;
+    if(std::strcmp(argv[arg], "--baud") == 0 && arg + 1 < argc) {
+        baud = unsigned(std::strtoul(argv[arg + 1], nullptr, 10));
+        arg += 2;
+    }
+    if(arg >= argc) {
+        usage();
+        return 2;
+    }
+    std::string cmd = argv[arg++];
+    unsigned value = arg < argc ? unsigned(std::strtoul(argv[arg], nullptr, 10)) : 0;
+
+    try {
+        SerialPort port(tty, baud);
+        Link link(port);
+        const uint8_t delimiter = FRAME_DELIMITER;
+        port.write_all(&delimiter, 1);      // Flush any partial frame on the board
+
+        if(cmd == "ping") {
+            return cmd_ping(link, value ? value : 1);
+        } else if(cmd == "status") {
+            return cmd_status(link);
+        } else if(cmd == "led" && arg < argc) {
+            return cmd_led(link, value);
+        } else if(cmd == "stream" && value > 0) {
+            return cmd_stream(link, value, baud);
+        } else if(cmd == "log" && value > 0) {
+            return cmd_log(link, value, arg + 1 < argc ? argv[arg + 1] : nullptr);
+        } else if(cmd == "scope") {
+            int rc = cmd_scope(link, argc, argv, arg);
+            if(rc >= 0) {
+                return rc;
+            }
+        }
+        usage();
+        return 2;
+    } catch(const std::exception &e) {
+        std::fprintf(stderr, "link_cli: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,198 @@
+/******************************************************************************
+ * Q7 Binary Link - Linux Host Library Implementation
+ * See link_host.hpp.
+ ******************************************************************************/
+
+#include "link_host.hpp"
+#include "../../PIC18F4550/Q7_UART_Serial_Communication/link_protocol.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdexcept>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+std::runtime_error sys_error(const std::string &what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+speed_t speed_for(unsigned baud) {
+    switch(baud) {
+        case 9600:    return B9600;
+        case 19200:   return B19200;
+        case 38400:   return B38400;
+        case 57600:   return B57600;
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+        case 500000:  return B500000;
+        case 1000000: return B1000000;
+        default:
+            throw std::runtime_error("unsupported baud rate " + std::to_string(baud));
+    }
+}
+
+}  // namespace
+
+/******************************************************************************
+ * SerialPort
+ ******************************************************************************/
+SerialPort::SerialPort(const std::string &path, unsigned baud) {
+    fd_ = ::open(path.c_str(), O_RDWR | O_NOCTTY);
+    if(fd_ < 0) {
+        throw sys_error("open " + path);
+    }
+
+    termios tio;
+    if(tcgetattr(fd_, &tio) < 0) {
+        ::close(fd_);
+        throw sys_error("tcgetattr " + path);
+    }
+    cfmakeraw(&tio);                    // 8-N-1, no echo, no CR/LF mapping
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~CRTSCTS;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    cfsetspeed(&tio, speed_for(baud));  // Ignored by ptys
+    if(tcsetattr(fd_, TCSANOW, &tio) < 0) {
+        ::close(fd_);
+        throw sys_error("tcsetattr " + path);
+    }
+    tcflush(fd_, TCIOFLUSH);
+}
+
+SerialPort::SerialPort(int fd) : fd_(fd) {}
+
+SerialPort::~SerialPort() {
+    ::close(fd_);
+}
+
+void SerialPort::write_all(const uint8_t *data, size_t len) {
+    while(len > 0) {
+        ssize_t n = ::write(fd_, data, len);
+        if(n < 0) {
+            if(errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            throw sys_error("write");
+        }
+        data += n;
+        len -= size_t(n);
+    }
+}
+
+size_t SerialPort::read_some(uint8_t *data, size_t len, int timeout_ms) {
+    pollfd pfd = {fd_, POLLIN, 0};
+    int r = ::poll(&pfd, 1, timeout_ms);
+    if(r < 0) {
+        if(errno == EINTR) {
+            return 0;
+        }
+        throw sys_error("poll");
+    }
+    if(r == 0) {
+        return 0;
+    }
+    ssize_t n = ::read(fd_, data, len);
+    if(n < 0) {
+        if(errno == EAGAIN || errno == EINTR) {
+            return 0;
+        }
+        throw sys_error("read");
+    }
+    if(n == 0 || (pfd.revents & POLLHUP)) {
+        throw std::runtime_error("serial port closed");
+    }
+    return size_t(n);
+}
+
+/******************************************************************************
+ * Link
+ ******************************************************************************/
+Link::Link(SerialPort &port) : port_(port) {
+    frame_decoder_init(&decoder_);
+}
+
+void Link::send(uint8_t type, uint8_t seq, const std::vector<uint8_t> &payload) {
+    if(payload.size() > FRAME_MAX_PAYLOAD) {
+        throw std::runtime_error("payload too long");
+    }
+    uint8_t out[FRAME_ENCODED_MAX];
+    unsigned char n = frame_encode(out, type, seq, payload.data(), uint8_t(payload.size()));
+    port_.write_all(out, n);
+}
+
+bool Link::receive(Frame &frame, int timeout_ms) {
+    for(;;) {
+        while(rx_pos_ < rx_len_) {
+            switch(frame_decoder_feed(&decoder_, rx_buf_[rx_pos_++])) {
+                case FRAME_OK:
+                    frame.type = decoder_.type;
+                    frame.seq = decoder_.seq;
+                    frame.payload.assign(decoder_.payload, decoder_.payload + decoder_.length);
+                    return true;
+                case FRAME_BAD_CRC:
+                    crc_errors++;
+                    break;
+                case FRAME_BAD_FORMAT:
+                    format_errors++;
+                    break;
+                default:
+                    break;
+            }
+        }
+        rx_len_ = port_.read_some(rx_buf_, sizeof(rx_buf_), timeout_ms);
+        rx_pos_ = 0;
+        bytes_rx += rx_len_;
+        if(rx_len_ == 0) {
+            return false;                   // Timed out
+        }
+    }
+}
+
+bool Link::request(uint8_t type, const std::vector<uint8_t> &payload, Frame &reply,
+                   int timeout_ms) {
+    uint8_t seq = next_seq_++;
+
+    send(type, seq, payload);
+    while(receive(reply, timeout_ms)) {
+        if(reply.type == uint8_t(type | LINK_RESPONSE) && reply.seq == seq) {
+            return true;
+        }
+        if(on_unsolicited) {
+            on_unsolicited(reply);
+        }
+    }
+    return false;
+}
+
+/******************************************************************************
+ * 10-bit Sample Packing
+ ******************************************************************************/
+std::vector<uint16_t> unpack10(const uint8_t *data, size_t len) {
+    std::vector<uint16_t> samples;
+
+    for(size_t g = 0; g + 5 <= len; g += 5) {
+        for(unsigned i = 0; i < 4; i++) {
+            samples.push_back(uint16_t(data[g + i] | (((data[g + 4] >> (2 * i)) & 0x03) << 8)));
+        }
+    }
+    return samples;
+}
+
+std::vector<uint8_t> pack10(const std::vector<uint16_t> &samples) {
+    std::vector<uint8_t> data;
+
+    for(size_t g = 0; g + 4 <= samples.size(); g += 4) {
+        uint8_t high = 0;
+        for(unsigned i = 0; i < 4; i++) {
+            data.push_back(uint8_t(samples[g + i]));
+            high |= uint8_t(((samples[g + i] >> 8) & 0x03) << (2 * i));
+        }
+        data.push_back(high);
+    }
+    return data;
+}
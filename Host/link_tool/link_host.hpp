@@ -0,0 +1,89 @@
+/******************************************************************************
+ * Q7 Binary Link - Linux Host Library
+ * Used by: link_cli.cpp (PC tool) and link_sim.cpp (pty stand-in)
+ *
+ * Description:
+ *   SerialPort opens a tty (USB-Serial adapter or pty) in raw 8-N-1 mode.
+ *   Link sends and receives frames on it with the same codec the board
+ *   uses (Common/frame.c, compiled as C++), so both ends share one
+ *   implementation of COBS and CRC-16.
+ *
+ *   Link::request() sends a request with the next sequence number and
+ *   waits for the matching response (timeout_ms is the longest gap
+ *   between frames); unsolicited frames that arrive in the meantime are
+ *   passed to on_unsolicited.
+ *
+ * Errors:
+ *   System call failures throw std::runtime_error with errno text.
+ *   Timeouts are not errors: receive()/request() return false.
+ ******************************************************************************/
+
+#ifndef LINK_HOST_HPP
+#define LINK_HOST_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// frame.c is built as C++ with the tools, so no extern "C" is needed
+#include "../../Common/frame.h"
+
+struct Frame {
+    uint8_t type = 0;
+    uint8_t seq = 0;
+    std::vector<uint8_t> payload;
+};
+
+class SerialPort {
+public:
+    SerialPort(const std::string &path, unsigned baud);
+    explicit SerialPort(int fd);        // Adopt an open descriptor (pty master)
+    ~SerialPort();
+    SerialPort(const SerialPort &) = delete;
+    SerialPort &operator=(const SerialPort &) = delete;
+
+    void write_all(const uint8_t *data, size_t len);
+    size_t read_some(uint8_t *data, size_t len, int timeout_ms);   // 0 on timeout
+
+private:
+    int fd_;
+};
+
+class Link {
+public:
+    explicit Link(SerialPort &port);
+
+    void send(uint8_t type, uint8_t seq, const std::vector<uint8_t> &payload);
+    bool receive(Frame &frame, int timeout_ms);
+    bool request(uint8_t type, const std::vector<uint8_t> &payload, Frame &reply,
+                 int timeout_ms);
+
+    std::function<void(const Frame &)> on_unsolicited;
+
+    // Statistics
+    uint64_t bytes_rx = 0;              // Raw bytes read from the port
+    unsigned crc_errors = 0;
+    unsigned format_errors = 0;
+
+private:
+    SerialPort &port_;
+    frame_decoder_t decoder_;
+    uint8_t next_seq_ = 0;
+    uint8_t rx_buf_[256];
+    size_t rx_len_ = 0;
+    size_t rx_pos_ = 0;
+};
+
+// Little-endian field helpers
+inline uint16_t get_u16(const uint8_t *p) { return uint16_t(p[0] | (p[1] << 8)); }
+inline uint32_t get_u32(const uint8_t *p) { return get_u16(p) | (uint32_t(get_u16(p + 2)) << 16); }
+inline void put_u16(std::vector<uint8_t> &v, uint16_t x) { v.push_back(uint8_t(x)); v.push_back(uint8_t(x >> 8)); }
+inline void put_u32(std::vector<uint8_t> &v, uint32_t x) { put_u16(v, uint16_t(x)); put_u16(v, uint16_t(x >> 16)); }
+
+// 10-bit samples packed 4 per 5 bytes (ADC_BLOCK layout in link_protocol.h)
+std::vector<uint16_t> unpack10(const uint8_t *data, size_t len);
+std::vector<uint8_t> pack10(const std::vector<uint16_t> &samples);
+
+#endif
@@ -0,0 +1,397 @@
+/******************************************************************************
+ * Q7 Binary Link - Board Stand-In on a Pseudo Terminal
+ *
+ * Usage:
+ *   link_sim [--baud N] [--xtal HZ] [--drop N] [--logger RATE]
+ *
+ * Description:
+ *   Opens a pty, prints its device name and answers link_cli exactly as
+ *   uart_binary_link.c does (same codec, same message handling), so the
+ *   host tools can be developed and tested without the kit.
+ *   A pty has no line rate, so output is paced to --baud (default 9600,
+ *   10 bit times per byte) to make stream throughput figures realistic.
+ *   --xtal sets the board clock (default 8000000). The SPBRG value in
+ *   STATUS replies is picked from it as Drivers/uart_baud.h does, and a
+ *   rate that header would reject (over 2% off) is refused, e.g. 115200
+ *   needs --xtal 48000000 as it needs the PLL clock on the board.
+ *   --drop N discards every Nth STREAM_DATA frame after numbering it, to
+ *   check that link_cli reports lost frames.
+ *   SCOPE_ARM requests are answered like Q8 adc_scope.c, capturing a
+ *   generated signal (noise around 200 with a decaying pulse to about
+ *   850 every 0.5 s) at 10 kHz.
+ *   --logger RATE acts as Q8 adc_logger.c instead: it streams ADC_BLOCK
+ *   frames of a 50 Hz test sine sampled at RATE Hz, plus ADC_STATS about
+ *   four times a second. Blocks that the paced line cannot carry are
+ *   dropped as on the board (ring of 4). Headroom is reported as 100%
+ *   (no CPU model).
+ *
+ * Build (from this directory):
+ *   g++ -std=c++17 -O2 -Wall -o link_sim -x c++ ../../Common/frame.c -x none link_sim.cpp link_host.cpp
+ *
+ * Example:
+ *   ./link_sim --baud 115200 --xtal 48000000 &     # prints "link_sim: board on /dev/pts/5"
+ *   ./link_cli /dev/pts/5 --baud 115200 stream 500
+ ******************************************************************************/
+
+#include "link_host.hpp"
+#include "../../PIC18F4550/Q7_UART_Serial_Communication/link_protocol.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const unsigned BAUD_MAX_ERROR_X100 = 200;   // UART_BAUD_MAX_ERROR_X100
+
+struct Board {
+    unsigned baud = 9600;
+    unsigned xtal = 8000000;                // Board clock, for the SPBRG field
+    unsigned brg = 0;
+    unsigned drop = 0;
+    bool led = false;
+    unsigned frames_rx = 0;
+    unsigned stream_left = 0;
+    uint16_t stream_sample = 0;
+    uint8_t stream_seq = 0;
+    Clock::time_point line_free = Clock::now();
+
+    // Scope capture (adc_scope.c)
+    bool scope_armed = false;
+    uint8_t scope_mode = 0;
+    unsigned scope_level = 0, scope_pre = 0, scope_post = 0;
+    uint16_t scope_captures = 0;
+};
+
+const unsigned SCOPE_RATE = 10000;
+const unsigned SCOPE_RING_SIZE = 512;
+const unsigned SCOPE_HYST = 8;
+
+// SPBRGH:SPBRG as uart_baud.h picks it: finest divisor whose rounded n
+// fits, then the same error limit. False where that header has an #error.
+bool select_brg(unsigned long xtal, unsigned long baud, unsigned &brg) {
+    static const unsigned long divisors[] = {4, 16, 64};
+    static const unsigned long limits[] = {65535, 65535, 255};
+
+    if(baud == 0 || xtal < 4 * baud) {
+        return false;
+    }
+    for(unsigned i = 0; i < 3; i++) {
+        unsigned long div = divisors[i];
+        unsigned long n = (xtal + div * baud / 2) / (div * baud) - 1;
+        if(n > limits[i]) {
+            continue;
+        }
+        unsigned long long wanted = (unsigned long long)div * (n + 1) * baud;
+        unsigned long long diff = wanted > xtal ? wanted - xtal : xtal - wanted;
+        if(diff / (wanted / 10000) > BAUD_MAX_ERROR_X100) {
+            return false;
+        }
+        brg = unsigned(n);
+        return true;
+    }
+    return false;
+}
+
+// Send a frame, then wait as long as the UART would need to shift it out
+void paced_send(Board &b, Link &link, uint8_t type, uint8_t seq, const std::vector<uint8_t> &payload) {
+    std::this_thread::sleep_until(b.line_free);
+    link.send(type, seq, payload);
+    auto bits = std::chrono::duration<double>((payload.size() + FRAME_OVERHEAD + 2) * 10.0 / b.baud);
+    b.line_free = std::max(b.line_free, Clock::now()) +
+                  std::chrono::duration_cast<Clock::duration>(bits);
+}
+
+// Same behaviour as handle_request() in uart_binary_link.c
+void handle_request(Board &b, Link &link, const Frame &req) {
+    std::vector<uint8_t> reply = {LINK_OK};
+
+    b.frames_rx++;
+    switch(req.type) {
+        case MSG_PING:
+            if(req.payload.size() > FRAME_MAX_PAYLOAD - 1) {
+                reply[0] = LINK_ERR_LENGTH;
+                break;
+            }
+            for(uint8_t byte : req.payload) {
+                reply.push_back(byte);
+            }
+            break;
+        case MSG_STATUS:
+            put_u32(reply, b.baud);
+            put_u16(reply, uint16_t(b.brg));
+            put_u16(reply, uint16_t(b.frames_rx));
+            put_u16(reply, uint16_t(link.crc_errors));
+            put_u16(reply, uint16_t(link.format_errors));
+            put_u16(reply, 0);
+            break;
+        case MSG_LED:
+            if(req.payload.size() != 1) {
+                reply[0] = LINK_ERR_LENGTH;
+                break;
+            }
+            b.led = req.payload[0] != 0;
+            std::printf("link_sim: LED %s\n", b.led ? "ON" : "OFF");
+            break;
+        case MSG_STREAM:
+            if(req.payload.size() != 2) {
+                reply[0] = LINK_ERR_LENGTH;
+                break;
+            }
+            b.stream_left = get_u16(req.payload.data());
+            break;
+        case MSG_SCOPE_ARM: {
+            if(req.payload.size() != SCOPE_ARM_LEN) {
+                reply[0] = LINK_ERR_LENGTH;
+                break;
+            }
+            const uint8_t *p = req.payload.data();
+            unsigned pre = get_u16(p + 3), post = get_u16(p + 5);
+            if(p[0] > SCOPE_LEVEL || get_u16(p + 1) > 1023 || post == 0 ||
+               pre >= SCOPE_RING_SIZE || post >= SCOPE_RING_SIZE - pre) {
+                reply[0] = LINK_ERR_LENGTH;
+                break;
+            }
+            b.scope_mode = p[0];
+            b.scope_level = get_u16(p + 1);
+            b.scope_pre = pre;
+            b.scope_post = post;
+            b.scope_armed = true;
+            break;
+        }
+        default:
+            reply[0] = LINK_ERR_TYPE;
+            break;
+    }
+    paced_send(b, link, uint8_t(req.type | LINK_RESPONSE), req.seq, reply);
+}
+
+// Test signal for the scope: noise plus a decaying pulse every 0.5 s
+uint16_t scope_signal(uint64_t n) {
+    unsigned phase = unsigned(n % (SCOPE_RATE / 2));
+    double v = 200 + (n * 7919 % 13);
+    if(phase >= 100) {
+        v += 650 * std::exp(-(double(phase) - 100) / 40.0);
+    }
+    return uint16_t(std::min(v, 1023.0));
+}
+
+// Same trigger rules as scope_sample() in adc_scope.c; runs in real time
+void run_scope_capture(Board &b, Link &link) {
+    static uint64_t n = 0;                  // Sample clock keeps running
+    unsigned invert = b.scope_mode == SCOPE_FALLING ? 0x3FF : 0;
+    unsigned fire = b.scope_level ^ invert;
+    unsigned prime = fire > SCOPE_HYST ? fire - SCOPE_HYST : 1;    // Clamped as in adc_scope.c
+    bool primed = b.scope_mode == SCOPE_LEVEL;
+    std::deque<uint16_t> history;
+    std::vector<uint16_t> capture;
+    auto t0 = Clock::now();
+    uint64_t start = n;
+
+    // Pre-trigger fill and trigger search
+    while(true) {
+        uint16_t s = scope_signal(n++);
+        unsigned x = s ^ invert;
+        bool armed = history.size() >= b.scope_pre;
+        history.push_back(s);
+        if(history.size() > b.scope_pre + 1) {
+            history.pop_front();
+        }
+        if(armed) {
+            if(primed && x >= fire) {
+                break;
+            } else if(x < prime) {
+                primed = true;
+            }
+        }
+    }
+    capture.assign(history.begin(), history.end());
+    for(unsigned i = 0; i < b.scope_post; i++) {
+        capture.push_back(scope_signal(n++));
+    }
+    std::this_thread::sleep_until(t0 + std::chrono::microseconds((n - start) * 1000000 / SCOPE_RATE));
+
+    // Dump: header, then packed chunks
+    std::vector<uint8_t> header;
+    put_u16(header, b.scope_captures++);
+    put_u16(header, SCOPE_RATE);
+    put_u16(header, uint16_t(b.scope_pre));
+    put_u16(header, uint16_t(b.scope_post));
+    put_u16(header, capture[b.scope_pre]);
+    paced_send(b, link, MSG_SCOPE_HEADER, b.stream_seq++, header);
+
+    for(size_t i = 0; i < capture.size(); i += SCOPE_CHUNK) {
+        std::vector<uint16_t> part(capture.begin() + i,
+                                   capture.begin() + std::min(capture.size(), i + SCOPE_CHUNK));
+        part.resize((part.size() + 3) & ~size_t(3), 0);
+        std::vector<uint8_t> data;
+        put_u16(data, uint16_t(i));
+        for(uint8_t byte : pack10(part)) {
+            data.push_back(byte);
+        }
+        paced_send(b, link, MSG_SCOPE_DATA, b.stream_seq++, data);
+    }
+    b.scope_armed = false;
+}
+
+void send_stream_frame(Board &b, Link &link) {
+    std::vector<uint8_t> data;
+
+    for(unsigned i = 0; i < STREAM_WORDS; i++) {
+        put_u16(data, b.stream_sample++);
+    }
+    uint8_t seq = b.stream_seq++;
+    b.stream_left--;
+    if(b.drop && seq % b.drop == b.drop - 1) {
+        return;                             // Simulated loss
+    }
+    paced_send(b, link, MSG_STREAM_DATA, seq, data);
+}
+
+// Same behaviour as adc_logger.c, with a generated signal
+void run_logger(Board &b, Link &link, unsigned rate) {
+    const auto block_time = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(double(ADC_BLOCK_SAMPLES) / rate));
+    const auto window = std::chrono::microseconds(262144);     // 2^19 cycles at 2 MIPS
+    const unsigned ring_blocks = 4;
+    unsigned dropped = 0, sent = 0, window_samples = 0;
+    uint16_t number = 0;
+    uint8_t seq = 0;
+    uint64_t n = 0;
+    auto next_block = Clock::now() + block_time;
+    auto next_stats = Clock::now() + window;
+
+    std::deque<std::vector<uint8_t>> ring;
+
+    while(true) {
+        // Wait for the next sample block or for the line to become free
+        bool line_ready = !ring.empty() && b.line_free < next_block;
+        std::this_thread::sleep_until(line_ready ? b.line_free : next_block);
+
+        if(line_ready) {
+            paced_send(b, link, MSG_ADC_BLOCK, seq++, ring.front());
+            ring.pop_front();
+            sent++;
+            continue;
+        }
+        next_block += block_time;
+
+        std::vector<uint16_t> samples;
+        for(unsigned i = 0; i < ADC_BLOCK_SAMPLES; i++, n++) {
+            samples.push_back(uint16_t(512.5 + 400.0 * std::sin(2 * M_PI * 50.0 * n / rate)));
+        }
+        window_samples += ADC_BLOCK_SAMPLES;
+
+        std::vector<uint8_t> block;
+        put_u16(block, number++);
+        for(uint8_t byte : pack10(samples)) {
+            block.push_back(byte);
+        }
+        if(ring.size() < ring_blocks - 1) {
+            ring.push_back(block);
+        } else {
+            dropped++;                      // Ring full, as on the board
+        }
+
+        if(Clock::now() >= next_stats) {
+            std::vector<uint8_t> stats;
+            put_u16(stats, uint16_t(window_samples * 1000000.0 / window.count()));
+            put_u16(stats, 0);
+            put_u16(stats, uint16_t(dropped));
+            put_u16(stats, uint16_t(sent));
+            stats.push_back(100);
+            put_u16(stats, uint16_t(rate));
+            paced_send(b, link, MSG_ADC_STATS, seq++, stats);
+            window_samples = 0;
+            next_stats += window;
+        }
+    }
+}
+
+int open_pty(std::string &name, int &slave) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if(master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+        throw std::runtime_error(std::string("pty: ") + std::strerror(errno));
+    }
+    name = ptsname(master);
+
+    // Raw mode for the slave side (set through the master)
+    termios tio;
+    tcgetattr(master, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(master, TCSANOW, &tio);
+
+    // Keep one slave descriptor open so the master does not see a hang-up
+    // every time link_cli exits
+    slave = ::open(name.c_str(), O_RDWR | O_NOCTTY);
+    return master;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Board board;
+    unsigned logger_rate = 0;
+
+    for(int i = 1; i + 1 < argc; i += 2) {
+        if(std::strcmp(argv[i], "--baud") == 0) {
+            board.baud = unsigned(std::strtoul(argv[i + 1], nullptr, 10));
+        } else if(std::strcmp(argv[i], "--xtal") == 0) {
+            board.xtal = unsigned(std::strtoul(argv[i + 1], nullptr, 10));
+        } else if(std::strcmp(argv[i], "--drop") == 0) {
+            board.drop = unsigned(std::strtoul(argv[i + 1], nullptr, 10));
+        } else if(std::strcmp(argv[i], "--logger") == 0) {
+            logger_rate = unsigned(std::strtoul(argv[i + 1], nullptr, 10));
+        }
+    }
+    if(board.baud == 0) {
+        std::fprintf(stderr, "usage: link_sim [--baud N] [--xtal HZ] [--drop N] [--logger RATE]\n");
+        return 2;
+    }
+    if(!select_brg(board.xtal, board.baud, board.brg)) {
+        std::fprintf(stderr, "link_sim: %u baud is not within 2%% at %u Hz (see Drivers/uart_baud.h)\n",
+                     board.baud, board.xtal);
+        return 2;
+    }
+
+    try {
+        std::string name;
+        int slave;
+        SerialPort port(open_pty(name, slave));
+        Link link(port);
+        Frame frame;
+
+        std::printf("link_sim: board on %s (%u baud)\n", name.c_str(), board.baud);
+        std::fflush(stdout);
+
+        if(logger_rate) {
+            run_logger(board, link, logger_rate);
+        }
+        while(true) {
+            // Requests first, as on the board; do not wait while streaming
+            if(link.receive(frame, (board.stream_left || board.scope_armed) ? 0 : 1000)) {
+                handle_request(board, link, frame);
+            } else if(board.scope_armed) {
+                run_scope_capture(board, link);
+            } else if(board.stream_left) {
+                send_stream_frame(board, link);
+            }
+        }
+    } catch(const std::exception &e) {
+        std::fprintf(stderr, "link_sim: %s\n", e.what());
+        return 1;
+    }
+}
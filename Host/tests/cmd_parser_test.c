@@ -0,0 +1,90 @@
+/******************************************************************************
+ * Host Test - cmd_parser Argument Range
+ *
+ * Description:
+ *   Feeds whole lines to cmd_parser_feed() and checks the result and the
+ *   arguments the handler received. Arguments are int on both targets
+ *   (16 bits), so anything outside -32768..32767 must be CMD_BAD_ARGS
+ *   and must not reach the handler, however wide int is on the host.
+ *
+ * Build and Run (from this directory):
+ *   gcc -std=c99 -Wall -o cmd_parser_test cmd_parser_test.c ../../Common/cmd_parser.c
+ *   ./cmd_parser_test
+ ******************************************************************************/
+
+#include <stdio.h>
+
+#include "../../Common/cmd_parser.h"
+
+static unsigned char calls;
+static unsigned char last_argc;
+static int last_argv[CMD_MAX_ARGS];
+
+static void cmd_led(unsigned char argc, const int *argv) {
+    unsigned char i;
+
+    calls++;
+    last_argc = argc;
+    for(i = 0; i < argc; i++) {
+        last_argv[i] = argv[i];
+    }
+}
+
+static const cmd_entry_t commands[] = {
+    {"LED", cmd_led}
+};
+
+static int failures = 0;
+
+/******************************************************************************
+ * Function: check
+ * Description: Feed one line plus '\r' and compare the outcome
+ * Parameters: line - text without the line ending
+ *             expected - cmd_parser_feed() result at the line ending
+ *             value - the single argument expected (if dispatched)
+ * Returns: None
+ ******************************************************************************/
+static void check(const char *line, unsigned char expected, int value) {
+    cmd_parser_t parser;
+    unsigned char result;
+    const char *c;
+
+    cmd_parser_init(&parser, commands, sizeof(commands) / sizeof(commands[0]));
+    calls = 0;
+    for(c = line; *c; c++) {
+        if(cmd_parser_feed(&parser, *c) != CMD_PENDING) {
+            printf("FAIL \"%s\": result before the line ending\n", line);
+            failures++;
+            return;
+        }
+    }
+    result = cmd_parser_feed(&parser, '\r');
+
+    if(result != expected) {
+        printf("FAIL \"%s\": result %u, expected %u\n", line, result, expected);
+        failures++;
+    } else if(expected == CMD_DISPATCHED &&
+              (calls != 1 || last_argc != 1 || last_argv[0] != value)) {
+        printf("FAIL \"%s\": handler got %u call(s), argc %u, argv[0] %d\n",
+               line, calls, last_argc, last_argv[0]);
+        failures++;
+    } else if(expected != CMD_DISPATCHED && calls != 0) {
+        printf("FAIL \"%s\": handler ran for a rejected line\n", line);
+        failures++;
+    }
+}
+
+int main(void) {
+    check("LED 1",          CMD_DISPATCHED, 1);
+    check("LED 32767",      CMD_DISPATCHED, 32767);
+    check("LED -32768",     CMD_DISPATCHED, -32768);
+    check("LED -0",         CMD_DISPATCHED, 0);
+    check("LED 0032767",    CMD_DISPATCHED, 32767);
+    check("LED 32768",      CMD_BAD_ARGS,   0);
+    check("LED -32769",     CMD_BAD_ARGS,   0);
+    check("LED 70000",      CMD_BAD_ARGS,   0);
+    check("LED 4294967296", CMD_BAD_ARGS,   0);
+
+    printf("%s\n", failures ? "cmd_parser_test: FAILED" : "cmd_parser_test: ok");
+    return failures ? 1 : 0;
+}
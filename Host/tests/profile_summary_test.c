@@ -0,0 +1,85 @@
+/******************************************************************************
+ * Host Test - profile_summary() Always Fits One 16-Column LCD Line
+ *
+ * Description:
+ *   Fills profile_data[] with average/maximum pairs from 0 to the 32-bit
+ *   limit and checks that every line is exactly 16 characters, matches
+ *   the expected text, and leaves the bytes after PROFILE_SUMMARY_LEN
+ *   alone. The widest case is display_adc() in adc_lcd.c with PROFILE=1
+ *   (about 190000 cycles average at 8 MHz).
+ *
+ * Build and Run (from this directory):
+ *   gcc -std=c99 -Wall -DPROFILE=1 -Istub -o profile_summary_test profile_summary_test.c ../../Common/profile.c ../../Common/numfmt.c
+ *   ./profile_summary_test
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <pic18f4550.h>
+
+#define PROFILE_SECTIONS(X)     X(PROF_TEST, "test")
+#include "../../Common/profile.h"
+
+PROFILE_TABLE();
+STUB_PIC18F4550_REGISTERS;
+
+#define GUARD       4               // Bytes checked after the buffer
+#define GUARD_BYTE  '#'
+
+static int failures = 0;
+
+/******************************************************************************
+ * Function: check
+ * Description: Summarise one average/maximum pair and compare the line
+ * Parameters: avg, max - cycles, expected - the 16-character line
+ * Returns: None
+ ******************************************************************************/
+static void check(unsigned long avg, unsigned long max, const char *expected) {
+    char line[PROFILE_SUMMARY_LEN + GUARD];
+    unsigned char i;
+
+    memset(line, GUARD_BYTE, sizeof(line));
+    profile_data[PROF_TEST].count = 1;
+    profile_data[PROF_TEST].total = avg;
+    profile_data[PROF_TEST].max = max;
+    profile_summary(PROF_TEST, line);
+
+    for(i = PROFILE_SUMMARY_LEN; i < sizeof(line); i++) {
+        if(line[i] != GUARD_BYTE) {
+            printf("FAIL %lu/%lu: wrote past PROFILE_SUMMARY_LEN\n", avg, max);
+            failures++;
+            return;
+        }
+    }
+    if(strlen(line) != 16 || strcmp(line, expected) != 0) {
+        printf("FAIL %lu/%lu: \"%s\" (len %u), expected \"%s\"\n",
+               avg, max, line, (unsigned)strlen(line), expected);
+        failures++;
+    }
+}
+
+int main(void) {
+    check(0, 0,                         "avg      0/    0");
+    check(2310, 2904,                   "avg   2310/ 2904");
+    check(99999, 99999,                 "avg  99999/99999");
+    check(100000, 123456,               "avg   100k/ 123k");
+    check(190000, 230000,               "avg   190k/ 230k");
+    check(9999999, 10000000,            "avg  9999k/  10M");
+    check(0xFFFFFFFFUL, 0xFFFFFFFFUL,   "avg  4294M/4294M");
+
+    profile_data[PROF_TEST].count = 0;  // Never run: zeros, not a division
+    profile_data[PROF_TEST].total = 5;
+    profile_data[PROF_TEST].max = 5;
+    {
+        char line[PROFILE_SUMMARY_LEN];
+        profile_summary(PROF_TEST, line);
+        if(strcmp(line, "avg      0/    0") != 0) {
+            printf("FAIL count 0: \"%s\"\n", line);
+            failures++;
+        }
+    }
+
+    printf("%s\n", failures ? "profile_summary_test: FAILED" : "profile_summary_test: ok");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,26 @@
+/******************************************************************************
+ * Host Test Stand-In for <pic18f4550.h>
+ * Only the registers used by the Common/ sources under test, as plain
+ * variables (defined in the test). Reads return whatever the test stored.
+ ******************************************************************************/
+
+#ifndef STUB_PIC18F4550_H
+#define STUB_PIC18F4550_H
+
+typedef struct { unsigned char GIE, PEIE; } stub_intcon_t;
+typedef struct { unsigned char TMR3IF; } stub_pir2_t;
+typedef struct { unsigned char TMR3IE; } stub_pie2_t;
+
+extern volatile unsigned char T3CON, TMR3H, TMR3L;
+extern volatile stub_intcon_t INTCONbits;
+extern volatile stub_pir2_t PIR2bits;
+extern volatile stub_pie2_t PIE2bits;
+
+// Defines the variables above; once, in the test's own source
+#define STUB_PIC18F4550_REGISTERS                                           \
+    volatile unsigned char T3CON, TMR3H, TMR3L;                             \
+    volatile stub_intcon_t INTCONbits;                                      \
+    volatile stub_pir2_t PIR2bits;                                          \
+    volatile stub_pie2_t PIE2bits
+
+#endif
@@ -0,0 +1,10 @@
+/******************************************************************************
+ * Host Test Stand-In for <xc.h>
+ * Lets the Common/ sources build with gcc; the registers they touch are
+ * declared in stub/pic18f4550.h. Nothing here models the hardware.
+ ******************************************************************************/
+
+#ifndef STUB_XC_H
+#define STUB_XC_H
+
+#endif
@@ -0,0 +1,140 @@
+/******************************************************************************
+ * PIC18F4550 ADC Timing - Compile-Time ADCS/ACQT Selection
+ * Used by: Drivers/adc_sampler.c, Drivers/adc_scanner.c and the Q8 programs
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ *
+ * Description:
+ *   Picks the fastest legal A/D clock (ADCS) and the shortest automatic
+ *   acquisition time (ACQT) for _XTAL_FREQ (system_config.h) and the
+ *   impedance of the signal source, entirely in the preprocessor, and
+ *   stops the build with #error if no legal setting exists. The results
+ *   are exported as constants so sampling code can size its periods and
+ *   buffers from the real conversion time instead of guessing.
+ *
+ * Data Sheet Limits (PIC18F4550, VDD = 5 V):
+ *   TAD: 0.7 us minimum (1.4 us for PIC18LF parts: define
+ *        ADC_TAD_MIN_NS=1400), 25 us maximum
+ *   ADCS: Fosc/2, /4, /8, /16, /32, /64 (FRC is left for Sleep use)
+ *   ACQT: 2, 4, 6, 8, 12, 16 or 20 TAD (0 = software timed, not used,
+ *         because triggered conversions need the hardware delay)
+ *   Acquisition: TACQ = TAMP + TC + TCOFF
+ *     TAMP  = 0.2 us amplifier settling
+ *     TC    = CHOLD (RIC + RSS + RS) ln(2048)
+ *           = 25 pF * (1 k + 2 k + RS) * 7.62 -> 1.05 us at RS = 2.5 k
+ *     TCOFF = 1.2 us (temperature term at 85 C)
+ *     -> 2.45 us for the recommended maximum RS of 2.5 k
+ *   Conversion: ACQT + 11 TAD from GO to the result, then 2 TAD before
+ *   the next acquisition may start.
+ *
+ * Results:
+ *   Clock     ADCS    TAD       ACQT    GO->result   Max rate
+ *   8 MHz     Fosc/8  1.00 us   4 TAD   15 us (30)   58.8 kHz
+ *   20 MHz    Fosc/16 0.80 us   4 TAD   12 us (60)   73.5 kHz
+ *   48 MHz    Fosc/64 1.33 us   2 TAD   17 us (208)  50.0 kHz
+ *   (GO->result in instruction cycles in brackets; the max rate is the
+ *   ADC alone, without any interrupt work. RS = 2.5 k.)
+ *   The old adc_init() setting (Fosc/64, 16 TAD) took 216 us at 8 MHz.
+ *
+ * Outputs:
+ *   ADC_ADCS_BITS, ADC_ACQT_BITS     ADCON2 fields
+ *   ADC_ADCON2_RIGHT, ADC_ADCON2_LEFT ADCON2 values (ADFM = 1 / 0)
+ *   ADC_CLOCK_DIV                     Fosc divider (2-64)
+ *   ADC_TAD_NS, ADC_TACQ_NS           TAD and required acquisition time
+ *   ADC_ACQT_TAD                      Acquisition time in TAD
+ *   ADC_CONVERSION_NS/_CYCLES         GO to result
+ *   ADC_MIN_PERIOD_CYCLES             Shortest conversion-to-conversion
+ *   ADC_MAX_SAMPLE_RATE               In Hz, from ADC_MIN_PERIOD_CYCLES
+ ******************************************************************************/
+
+#ifndef ADC_CONFIG_H
+#define ADC_CONFIG_H
+
+#include "system_config.h"
+
+// Source impedance of the analog inputs in ohms (data sheet maximum 2.5 k)
+#ifndef ADC_SOURCE_OHMS
+#define ADC_SOURCE_OHMS     2500UL
+#endif
+
+// Shortest legal TAD in nanoseconds (1400 for PIC18LF4550)
+#ifndef ADC_TAD_MIN_NS
+#define ADC_TAD_MIN_NS      700UL
+#endif
+#define ADC_TAD_MAX_NS      25000UL
+
+// Required acquisition time in ns: 200 + 25 pF * (3 k + RS) * 7.625 + 1200
+#define ADC_TACQ_NS         (200UL + ((3000UL + (ADC_SOURCE_OHMS)) * 191UL + 999UL) / 1000UL + 1200UL)
+
+// Divider gives a legal TAD (kHz keeps the products within 32 bits)
+#define ADC_TAD_OK(div)     ((div) * 1000000UL >= (ADC_TAD_MIN_NS) * ((_XTAL_FREQ) / 1000UL))
+
+#if ADC_TAD_OK(2UL)
+#define ADC_CLOCK_DIV       2UL
+#define ADC_ADCS_BITS       0x00
+#elif ADC_TAD_OK(4UL)
+#define ADC_CLOCK_DIV       4UL
+#define ADC_ADCS_BITS       0x04
+#elif ADC_TAD_OK(8UL)
+#define ADC_CLOCK_DIV       8UL
+#define ADC_ADCS_BITS       0x01
+#elif ADC_TAD_OK(16UL)
+#define ADC_CLOCK_DIV       16UL
+#define ADC_ADCS_BITS       0x05
+#elif ADC_TAD_OK(32UL)
+#define ADC_CLOCK_DIV       32UL
+#define ADC_ADCS_BITS       0x02
+#elif ADC_TAD_OK(64UL)
+#define ADC_CLOCK_DIV       64UL
+#define ADC_ADCS_BITS       0x06
+#else
+#error "_XTAL_FREQ too high: no ADCS divider gives TAD >= ADC_TAD_MIN_NS"
+#endif
+
+// TAD in ns, rounded down (so the acquisition check errs on the safe side)
+#define ADC_TAD_NS          ((ADC_CLOCK_DIV) * 1000000UL / ((_XTAL_FREQ) / 1000UL))
+
+#if ADC_TAD_NS > ADC_TAD_MAX_NS
+#error "_XTAL_FREQ too low: TAD exceeds 25 us even at Fosc/2 (use the FRC clock)"
+#endif
+
+#if 2 * ADC_TAD_NS >= ADC_TACQ_NS
+#define ADC_ACQT_TAD        2
+#define ADC_ACQT_BITS       0x01
+#elif 4 * ADC_TAD_NS >= ADC_TACQ_NS
+#define ADC_ACQT_TAD        4
+#define ADC_ACQT_BITS       0x02
+#elif 6 * ADC_TAD_NS >= ADC_TACQ_NS
+#define ADC_ACQT_TAD        6
+#define ADC_ACQT_BITS       0x03
+#elif 8 * ADC_TAD_NS >= ADC_TACQ_NS
+#define ADC_ACQT_TAD        8
+#define ADC_ACQT_BITS       0x04
+#elif 12 * ADC_TAD_NS >= ADC_TACQ_NS
+#define ADC_ACQT_TAD        12
+#define ADC_ACQT_BITS       0x05
+#elif 16 * ADC_TAD_NS >= ADC_TACQ_NS
+#define ADC_ACQT_TAD        16
+#define ADC_ACQT_BITS       0x06
+#elif 20 * ADC_TAD_NS >= ADC_TACQ_NS
+#define ADC_ACQT_TAD        20
+#define ADC_ACQT_BITS       0x07
+#else
+#error "ADC_SOURCE_OHMS too high: acquisition needs more than 20 TAD (buffer the signal)"
+#endif
+
+// ADCON2 = ADFM | ACQT2:0 << 3 | ADCS2:0
+#define ADC_ADCON2_RIGHT    (0x80 | (ADC_ACQT_BITS << 3) | ADC_ADCS_BITS)
+#define ADC_ADCON2_LEFT     ((ADC_ACQT_BITS << 3) | ADC_ADCS_BITS)
+
+// Timing in TAD: acquisition + 11 to the result, + 2 before the next one
+#define ADC_CONVERSION_TAD  (ADC_ACQT_TAD + 11)
+#define ADC_CONVERSION_NS   (ADC_CONVERSION_TAD * ADC_TAD_NS)
+
+// Instruction cycles (TAD = ADC_CLOCK_DIV / 4 cycles), rounded up
+#define ADC_CONVERSION_CYCLES   ((ADC_CONVERSION_TAD * ADC_CLOCK_DIV + 3) / 4)
+#define ADC_MIN_PERIOD_CYCLES   (((ADC_CONVERSION_TAD + 2) * ADC_CLOCK_DIV + 3) / 4)
+#define ADC_MAX_SAMPLE_RATE     (((_XTAL_FREQ) / 4) / ADC_MIN_PERIOD_CYCLES)
+
+#endif
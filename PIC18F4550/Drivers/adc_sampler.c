@@ -0,0 +1,155 @@
+/******************************************************************************
+ * PIC18F4550 ADC Sampler - Implementation
+ * See adc_sampler.h for the trigger and block ring rules.
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "../../Common/atomic.h"
+#include "adc_sampler.h"
+
+// Block Ring: fill index owned by the ISR, read index owned by main
+static unsigned int blocks[ADC_SAMPLER_BLOCKS][ADC_SAMPLER_BLOCK];
+static volatile unsigned char block_fill = 0;
+static volatile unsigned char block_read = 0;
+static unsigned char sample_pos = 0;
+static volatile unsigned int overruns = 0;
+
+/******************************************************************************
+ * Function: adc_sampler_init
+ * Description: Configure the ADC for one channel; result right justified.
+ *              ACQT must not be 0: the trigger only sets GO, so the
+ *              acquisition time has to be inserted by the hardware.
+ *              AN0 up to the channel are made analog (PCFG), as
+ *              adc_scanner does.
+ * Parameters: channel - analog channel 0-12 (AN0-AN12)
+ * Returns: 1 if configured, 0 if the channel does not exist (the ADC
+ *          is left as it was; do not start the sampler)
+ ******************************************************************************/
+unsigned char adc_sampler_init(unsigned char channel) {
+    if(channel > 12) {
+        return 0;
+    }
+    ADCON1 = 14 - channel;                  // PCFG: AN0..channel analog, VREF = VDD/VSS
+    ADCON2 = ADC_ADCON2_RIGHT;              // Timing from adc_config.h
+    ADCON0 = (unsigned char)((channel & 0x0F) << 2) | 0x01;     // ADON
+    PIE1bits.ADIE = 0;
+    PIR1bits.ADIF = 0;
+    return 1;
+}
+
+/******************************************************************************
+ * Function: adc_sampler_start
+ * Description: Start triggered sampling. Timer3 counts instruction cycles
+ *              (1:1) and is reset by the CCP2 match, so the period is
+ *              CCPR2 + 1 cycles.
+ * Parameters: period - sample period in instruction cycles
+ *                      (at least ADC_SAMPLER_MIN_PERIOD)
+ * Returns: None
+ ******************************************************************************/
+void adc_sampler_start(unsigned int period) {
+    adc_sampler_stop();
+
+    block_fill = 0;
+    block_read = 0;
+    sample_pos = 0;
+    overruns = 0;
+
+    T3CON = 0x88;                           // RD16, Timer3 -> CCP2, 1:1, off
+    TMR3H = 0;
+    TMR3L = 0;
+    CCPR2H = (unsigned char)((period - 1) >> 8);
+    CCPR2L = (unsigned char)(period - 1);
+    CCP2CON = 0x0B;                         // Compare, special event trigger
+
+    PIR1bits.ADIF = 0;
+    PIE1bits.ADIE = 1;
+    INTCONbits.PEIE = 1;
+    INTCONbits.GIE = 1;
+    T3CONbits.TMR3ON = 1;
+}
+
+/******************************************************************************
+ * Function: adc_sampler_stop
+ * Description: Stop the trigger and the ADC interrupt
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void adc_sampler_stop(void) {
+    T3CONbits.TMR3ON = 0;
+    CCP2CON = 0x00;
+    PIE1bits.ADIE = 0;
+}
+
+/******************************************************************************
+ * Function: adc_sampler_get_block
+ * Description: Oldest full block, if any. It stays valid until
+ *              adc_sampler_release_block() is called.
+ * Parameters: None
+ * Returns: Pointer to ADC_SAMPLER_BLOCK results, or 0 if none is ready
+ ******************************************************************************/
+const unsigned int *adc_sampler_get_block(void) {
+    if(block_read == block_fill) {
+        return 0;
+    }
+    return blocks[block_read];
+}
+
+/******************************************************************************
+ * Function: adc_sampler_release_block
+ * Description: Return the block from adc_sampler_get_block() to the ISR
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void adc_sampler_release_block(void) {
+    if(block_read != block_fill) {
+        block_read = (block_read + 1) & ADC_SAMPLER_MASK;
+    }
+}
+
+/******************************************************************************
+ * Function: adc_sampler_overruns
+ * Description: Blocks overwritten because main did not release them in
+ *              time. The 16-bit count is read until two reads agree
+ *              (Common/atomic.h), so ADIE is never masked, and stays off
+ *              after adc_sampler_stop().
+ * Parameters: None
+ * Returns: Overrun count since adc_sampler_start()
+ ******************************************************************************/
+unsigned int adc_sampler_overruns(void) {
+    unsigned int count;
+
+    ATOMIC_READ(count, overruns);
+    return count;
+}
+
+/******************************************************************************
+ * Function: adc_sampler_isr
+ * Description: Store a finished conversion; call from the ISR. The sample
+ *              was taken at the trigger, so entry latency does not matter
+ *              as long as the result is read before the next trigger.
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void adc_sampler_isr(void) {
+    unsigned char next;
+
+    if(!(PIE1bits.ADIE && PIR1bits.ADIF)) {
+        return;
+    }
+    PIR1bits.ADIF = 0;
+
+    blocks[block_fill][sample_pos] = ((unsigned int)ADRESH << 8) | ADRESL;
+    if(++sample_pos == ADC_SAMPLER_BLOCK) {
+        sample_pos = 0;
+        next = (block_fill + 1) & ADC_SAMPLER_MASK;
+        if(next != block_read) {
+            block_fill = next;              // Publish the full block
+        } else {
+            overruns++;                     // Ring full: refill this block
+        }
+    }
+}
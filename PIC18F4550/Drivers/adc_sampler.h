@@ -0,0 +1,54 @@
+/******************************************************************************
+ * PIC18F4550 ADC Sampler - CCP2 Special-Event Triggered Acquisition
+ * Used by: Experiment Q8 (adc_jitter_bench.c)
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ *
+ * Description:
+ *   Samples one analog channel at an exact period without CPU polling.
+ *   CCP2 runs in compare mode with special event trigger (CCP2M = 1011)
+ *   on Timer3: when TMR3 reaches CCPR2 the hardware resets TMR3 and sets
+ *   GO, so every conversion starts on the same instruction cycle of its
+ *   period regardless of interrupts or what main is doing. The ADIF
+ *   interrupt only collects the finished result; its latency no longer
+ *   affects when the sample was taken.
+ *
+ *   Results are collected into blocks of ADC_SAMPLER_BLOCK samples held
+ *   in a ring of ADC_SAMPLER_BLOCKS. The application takes a full block
+ *   with adc_sampler_get_block(), processes it and hands it back with
+ *   adc_sampler_release_block(). If all blocks are full when the ISR
+ *   needs a new one, the block being filled is overwritten and counted
+ *   as an overrun.
+ *
+ * Resources:
+ *   Timer3 (time base of CCP2; T3CCP2:T3CCP1 = 01 leaves Timer1 free and
+ *   assigned to CCP1), CCP2 (no pin activity in this mode), the ADC
+ *   and its interrupt.
+ *
+ * Interrupt Hook:
+ *   The application's ISR must call adc_sampler_isr().
+ ******************************************************************************/
+
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include "adc_config.h"
+
+// Block Ring (ADC_SAMPLER_BLOCKS must be a power of two)
+#define ADC_SAMPLER_BLOCK   32
+#define ADC_SAMPLER_BLOCKS  4
+#define ADC_SAMPLER_MASK    (ADC_SAMPLER_BLOCKS - 1)
+
+// Shortest period in instruction cycles: conversion plus the ISR
+#define ADC_SAMPLER_MIN_PERIOD  (ADC_CONVERSION_CYCLES + 70)
+
+unsigned char adc_sampler_init(unsigned char channel);
+void adc_sampler_start(unsigned int period);
+void adc_sampler_stop(void);
+const unsigned int *adc_sampler_get_block(void);
+void adc_sampler_release_block(void);
+unsigned int adc_sampler_overruns(void);
+void adc_sampler_isr(void);
+
+#endif
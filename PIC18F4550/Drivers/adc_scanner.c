@@ -0,0 +1,192 @@
+/******************************************************************************
+ * PIC18F4550 ADC Scanner - Implementation
+ * See adc_scanner.h for channel order, oversampling and snapshot rules.
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "../../Common/filter.h"
+#include "../../Common/atomic.h"
+#include "adc_scanner.h"
+
+// Channel List: ADCON0 values (CHS bits + ADON), one per entry
+static unsigned char channel_select[ADC_SCAN_MAX_CHANNELS];
+static unsigned char channel_count = 0;
+
+// Scan Position (ISR only)
+static unsigned char scan_pos = 0;              // Entry being converted
+static unsigned char scan_round = 0;            // Conversions per entry so far
+static unsigned int sums[ADC_SCAN_MAX_CHANNELS];
+static unsigned int staged[ADC_SCAN_MAX_CHANNELS];  // Filtered, not yet published
+static filter_t filters[ADC_SCAN_MAX_CHANNELS];
+
+// Published Snapshot
+static volatile unsigned int results[ADC_SCAN_MAX_CHANNELS];
+static volatile unsigned char results_seq = 0;
+
+/******************************************************************************
+ * Function: adc_scanner_start
+ * Description: Configure the ADC for the channel list and start the
+ *              CCP2 trigger. The period is CCPR2 + 1 Timer3 cycles.
+ * Parameters: channels - list of analog channel numbers (0-12)
+ *             count    - entries in the list (1-ADC_SCAN_MAX_CHANNELS)
+ *             period   - cycles between conversions (Fosc/4, at least
+ *                        ADC_SCAN_MIN_PERIOD)
+ * Returns: 1 if started, 0 if the list is empty, too long or invalid
+ ******************************************************************************/
+unsigned char adc_scanner_start(const unsigned char *channels, unsigned char count,
+                                unsigned int period) {
+    unsigned char i, highest = 0;
+
+    if(count == 0 || count > ADC_SCAN_MAX_CHANNELS) {
+        return 0;
+    }
+    for(i = 0; i < count; i++) {
+        if(channels[i] > 12) {
+            return 0;
+        }
+        if(channels[i] > highest) {
+            highest = channels[i];
+        }
+    }
+
+    adc_scanner_stop();
+
+    for(i = 0; i < count; i++) {
+        channel_select[i] = (unsigned char)(channels[i] << 2) | 0x01;
+        sums[i] = 0;
+        results[i] = 0;
+        filter_init(&filters[i], FILTER_NONE, 0);
+    }
+    channel_count = count;
+    scan_pos = 0;
+    scan_round = 0;
+
+    ADCON1 = 14 - highest;                      // PCFG: AN0..highest analog
+    ADCON2 = ADC_ADCON2_RIGHT;                  // Timing from adc_config.h
+    ADCON0 = channel_select[0];
+
+    T3CON = 0x88;                               // RD16, Timer3 -> CCP2, 1:1, off
+    TMR3H = 0;
+    TMR3L = 0;
+    CCPR2H = (unsigned char)((period - 1) >> 8);
+    CCPR2L = (unsigned char)(period - 1);
+    CCP2CON = 0x0B;                             // Compare, special event trigger
+
+    PIR1bits.ADIF = 0;
+    PIE1bits.ADIE = 1;
+    INTCONbits.PEIE = 1;
+    INTCONbits.GIE = 1;
+    T3CONbits.TMR3ON = 1;
+    return 1;
+}
+
+/******************************************************************************
+ * Function: adc_scanner_stop
+ * Description: Stop the trigger and the ADC interrupt; the last snapshot
+ *              stays readable
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void adc_scanner_stop(void) {
+    T3CONbits.TMR3ON = 0;
+    CCP2CON = 0x00;
+    PIE1bits.ADIE = 0;
+}
+
+/******************************************************************************
+ * Function: adc_scanner_set_filter
+ * Description: Select the filter for one entry of the channel list. May be
+ *              called while scanning; the ADC interrupt is masked while
+ *              the filter is reset.
+ * Parameters: index - position in the list given to adc_scanner_start()
+ *             type  - FILTER_xxx (Common/filter.h)
+ *             coef  - filter coefficient (see filter_init())
+ * Returns: 1 if set, 0 if index is outside the channel list
+ ******************************************************************************/
+unsigned char adc_scanner_set_filter(unsigned char index, unsigned char type,
+                                     unsigned int coef) {
+    if(index >= channel_count) {
+        return 0;
+    }
+    ATOMIC_MASK_BEGIN(PIE1bits.ADIE)
+        filter_init(&filters[index], type, coef);
+    ATOMIC_MASK_END(PIE1bits.ADIE)
+    return 1;
+}
+
+/******************************************************************************
+ * Function: adc_scanner_seq
+ * Description: Sequence number of the latest snapshot, to poll for news
+ * Parameters: None
+ * Returns: Sequence number (wraps at 256)
+ ******************************************************************************/
+unsigned char adc_scanner_seq(void) {
+    return results_seq;
+}
+
+/******************************************************************************
+ * Function: adc_scanner_read
+ * Description: Copy the latest snapshot. The ISR publishes a snapshot in
+ *              one go and bumps results_seq; ATOMIC_SEQ_READ repeats the
+ *              copy until no publish happened during it.
+ * Parameters: snapshot - destination
+ * Returns: Sequence number of the copied snapshot
+ ******************************************************************************/
+unsigned char adc_scanner_read(adc_snapshot_t *snapshot) {
+    unsigned char i;
+
+    ATOMIC_SEQ_READ_BEGIN(results_seq)
+        snapshot->seq = results_seq;
+        for(i = 0; i < channel_count; i++) {
+            snapshot->value[i] = results[i];
+        }
+    ATOMIC_SEQ_READ_END(results_seq)
+
+    snapshot->count = channel_count;
+    return snapshot->seq;
+}
+
+/******************************************************************************
+ * Function: adc_scanner_isr
+ * Description: Switch to the next channel, add the finished conversion
+ *              to its sum, filter the sum after the channel's last
+ *              conversion for this snapshot and publish when every
+ *              channel is done; call from the ISR
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void adc_scanner_isr(void) {
+    unsigned char pos, i;
+
+    if(!(PIE1bits.ADIE && PIR1bits.ADIF)) {
+        return;
+    }
+    PIR1bits.ADIF = 0;
+
+    // Select the next channel first: it acquires until the next trigger
+    pos = scan_pos;
+    if(++scan_pos == channel_count) {
+        scan_pos = 0;
+    }
+    ADCON0 = channel_select[scan_pos];
+
+    sums[pos] += ((unsigned int)ADRESH << 8) | ADRESL;
+
+    if(scan_round == ADC_SCAN_OS_COUNT - 1) {
+        // Decimate and filter this channel only: one filter per interrupt
+        staged[pos] = filter_run(&filters[pos], sums[pos] >> ADC_SCAN_OS_BITS);
+        sums[pos] = 0;
+    }
+
+    if(scan_pos == 0 && ++scan_round == ADC_SCAN_OS_COUNT) {
+        scan_round = 0;
+        for(i = 0; i < channel_count; i++) {
+            results[i] = staged[i];
+        }
+        ATOMIC_SEQ_WRITE(results_seq);
+    }
+}
@@ -0,0 +1,99 @@
+/******************************************************************************
+ * PIC18F4550 ADC Scanner - Multi-Channel Oversampling Round Robin
+ * Used by: Experiment Q8 (adc_scan_monitor.c)
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ *
+ * Description:
+ *   Cycles through a list of up to ADC_SCAN_MAX_CHANNELS analog inputs
+ *   (any of AN0-AN12, in any order) entirely in the ADC interrupt.
+ *   Conversions are started by the CCP2 special event trigger on Timer3
+ *   (as in adc_sampler.c), one per period, and the ISR moves on to the
+ *   next channel in the list after every conversion.
+ *
+ *   Each channel is converted 4^ADC_SCAN_OS_BITS times per snapshot and
+ *   the sum is shifted right by ADC_SCAN_OS_BITS: every factor of 4 in
+ *   oversampling gives one extra bit, so results are 11 (n = 1) or 12
+ *   (n = 2) bits wide. The extra bits are only real if the input carries
+ *   at least about 1 LSB of noise; a perfectly quiet input just gives
+ *   the 10-bit value shifted left.
+ *
+ * Acquisition Time:
+ *   The ISR selects the next channel as its very first action, right
+ *   after the previous conversion finished. The hold capacitor then
+ *   tracks the new input until the next trigger (almost a whole period)
+ *   and ACQT adds ADC_ACQT_TAD more after the trigger, which alone meets
+ *   ADC_TACQ_NS for ADC_SOURCE_OHMS (adc_config.h).
+ *
+ * Snapshots:
+ *   When every channel has had its 4^n conversions, the ISR publishes all
+ *   results at once and increments a sequence counter. adc_scanner_read()
+ *   copies the results and repeats the copy if the counter changed while
+ *   it was copying, so the values it returns always belong together.
+ *
+ * Filters:
+ *   Each channel can have its own filter (Common/filter.h), selected
+ *   with adc_scanner_set_filter(); the default is FILTER_NONE. The
+ *   filter runs in the ISR on the decimated result, once per snapshot.
+ *   Each channel is filtered right after its last conversion for the
+ *   snapshot, so one interrupt never runs more than one filter (up to
+ *   ~150 cycles for MEDIAN5) and ADC_SCAN_MIN_PERIOD still holds.
+ *
+ * Rates (per channel):
+ *   snapshot rate = conversion rate / (channels * 4^n)
+ *   e.g. 8000 conversions/s, 4 channels, n = 2 -> 125 Hz at 12 bits.
+ *   See the table in adc_scan_monitor.c for CPU load.
+ *
+ * Pins:
+ *   The driver sets ADCON1 so that AN0 up to the highest listed channel
+ *   are analog (the PCFG ranges cannot skip pins) but does not touch TRIS.
+ *   AN0-AN4 = RA0-RA3, RA5; AN5-AN7 = RE0-RE2; AN8-AN12 = RB2, RB3, RB1,
+ *   RB4, RB0 (shared with the kit's LEDs and LCD data lines).
+ *
+ * Resources:
+ *   Timer3, CCP2 and the ADC with its interrupt, like adc_sampler.c;
+ *   use one of the two per program.
+ *
+ * Interrupt Hook:
+ *   The application's ISR must call adc_scanner_isr().
+ ******************************************************************************/
+
+#ifndef ADC_SCANNER_H
+#define ADC_SCANNER_H
+
+#include "adc_config.h"
+
+// Channel List
+#define ADC_SCAN_MAX_CHANNELS   8
+
+// Oversampling: 4^n conversions per result, 10 + n bits
+#ifndef ADC_SCAN_OS_BITS
+#define ADC_SCAN_OS_BITS        2
+#endif
+#if ADC_SCAN_OS_BITS < 0 || ADC_SCAN_OS_BITS > 3
+#error "ADC_SCAN_OS_BITS must be 0-3 (the 16-bit sums hold 64 samples)"
+#endif
+#define ADC_SCAN_OS_COUNT       (1 << (2 * ADC_SCAN_OS_BITS))
+#define ADC_SCAN_RESULT_BITS    (10 + ADC_SCAN_OS_BITS)
+
+// Shortest conversion period in instruction cycles: the conversion plus
+// the ISR with one MEDIAN5 filter or a snapshot publish of 8 channels
+#define ADC_SCAN_MIN_PERIOD     (ADC_CONVERSION_CYCLES + 220)
+
+typedef struct {
+    unsigned char seq;                          // Snapshot sequence number
+    unsigned char count;                        // Channels in value[]
+    unsigned int value[ADC_SCAN_MAX_CHANNELS];  // In channel list order
+} adc_snapshot_t;
+
+unsigned char adc_scanner_start(const unsigned char *channels, unsigned char count,
+                                unsigned int period);
+void adc_scanner_stop(void);
+unsigned char adc_scanner_set_filter(unsigned char index, unsigned char type,
+                                     unsigned int coef);
+unsigned char adc_scanner_seq(void);
+unsigned char adc_scanner_read(adc_snapshot_t *snapshot);
+void adc_scanner_isr(void);
+
+#endif
@@ -0,0 +1,75 @@
+/******************************************************************************
+ * PIC18F4550 Data EEPROM - Implementation
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "eeprom.h"
+
+/******************************************************************************
+ * Function: eeprom_read_byte
+ * Description: Read one byte of data EEPROM
+ * Parameters: addr - address (0-255)
+ * Returns: Stored byte (0xFF if never written)
+ ******************************************************************************/
+unsigned char eeprom_read_byte(unsigned char addr) {
+    EEADR = addr;
+    EECON1bits.EEPGD = 0;       // Data EEPROM, not flash
+    EECON1bits.CFGS = 0;
+    EECON1bits.RD = 1;
+    return EEDATA;              // Available in the next cycle
+}
+
+/******************************************************************************
+ * Function: eeprom_write_byte
+ * Description: Write one byte and wait for completion (~4 ms). Skipped if
+ *              the cell already holds the value.
+ * Parameters: addr - address (0-255), value - byte to store
+ * Returns: None
+ ******************************************************************************/
+void eeprom_write_byte(unsigned char addr, unsigned char value) {
+    unsigned char gie;
+
+    if(eeprom_read_byte(addr) == value) {
+        return;
+    }
+
+    EEADR = addr;
+    EEDATA = value;
+    EECON1bits.EEPGD = 0;
+    EECON1bits.CFGS = 0;
+    EECON1bits.WREN = 1;
+
+    // Required unlock sequence: no interrupt may split it
+    gie = INTCONbits.GIE;
+    INTCONbits.GIE = 0;
+    EECON2 = 0x55;
+    EECON2 = 0xAA;
+    EECON1bits.WR = 1;
+    INTCONbits.GIE = gie;
+
+    while(EECON1bits.WR);       // Cleared by hardware when done
+    EECON1bits.WREN = 0;
+    PIR2bits.EEIF = 0;
+}
+
+/******************************************************************************
+ * Function: eeprom_read_block / eeprom_write_block
+ * Description: Copy len bytes from / to consecutive EEPROM addresses
+ * Parameters: addr - first address, data - buffer, len - byte count
+ * Returns: None
+ ******************************************************************************/
+void eeprom_read_block(unsigned char addr, unsigned char *data, unsigned char len) {
+    while(len--) {
+        *data++ = eeprom_read_byte(addr++);
+    }
+}
+
+void eeprom_write_block(unsigned char addr, const unsigned char *data, unsigned char len) {
+    while(len--) {
+        eeprom_write_byte(addr++, *data++);
+    }
+}
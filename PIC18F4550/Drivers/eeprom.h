@@ -0,0 +1,29 @@
+/******************************************************************************
+ * PIC18F4550 Data EEPROM - Byte Read/Write
+ * Used by: Experiment Q8 (adc_lcd.c calibration)
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ *
+ * Description:
+ *   Direct EECON1 access to the 256-byte data EEPROM, independent of the
+ *   compiler's library helpers. Reads take a few cycles. A write takes
+ *   about 4 ms, during which eeprom_write_byte() waits, and the cell is
+ *   only rewritten if its value changes (endurance is about 1,000,000
+ *   erase/write cycles per byte).
+ *
+ *   Interrupts are disabled for the five-instruction unlock sequence
+ *   (0x55, 0xAA, WR) that the hardware requires, then restored.
+ ******************************************************************************/
+
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#define EEPROM_SIZE     256
+
+unsigned char eeprom_read_byte(unsigned char addr);
+void eeprom_write_byte(unsigned char addr, unsigned char value);
+void eeprom_read_block(unsigned char addr, unsigned char *data, unsigned char len);
+void eeprom_write_block(unsigned char addr, const unsigned char *data, unsigned char len);
+
+#endif
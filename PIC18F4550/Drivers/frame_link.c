@@ -0,0 +1,119 @@
+/******************************************************************************
+ * PIC18F4550 Binary Link - Implementation
+ * See frame_link.h for the send/receive rules.
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "frame_link.h"
+#include "uart_driver.h"
+
+frame_decoder_t link_rx;
+link_stats_t link_stats;
+
+// Frame being queued into the UART TX ring
+static unsigned char tx_frame[FRAME_ENCODED_MAX];
+static unsigned char tx_len = 0;
+static unsigned char tx_pos = 0;
+
+/******************************************************************************
+ * Function: link_init
+ * Description: Reset decoder, statistics and the pending frame. Queues a
+ *              delimiter so the host drops any partial frame it holds.
+ *              Call after uart_init().
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void link_init(void) {
+    unsigned char delimiter = FRAME_DELIMITER;
+
+    frame_decoder_init(&link_rx);
+    link_stats.frames_rx = 0;
+    link_stats.frames_tx = 0;
+    link_stats.crc_errors = 0;
+    link_stats.format_errors = 0;
+    tx_len = 0;
+    tx_pos = 0;
+    uart_write((const char *)&delimiter, 1);
+}
+
+/******************************************************************************
+ * Function: link_receive
+ * Description: Feed waiting bytes to the decoder until a valid frame is
+ *              complete or the receive ring is empty
+ * Parameters: None
+ * Returns: FRAME_OK when link_rx holds a new frame, FRAME_PENDING otherwise
+ ******************************************************************************/
+unsigned char link_receive(void) {
+    unsigned char data;
+
+    while(uart_read(&data)) {
+        switch(frame_decoder_feed(&link_rx, data)) {
+            case FRAME_OK:
+                link_stats.frames_rx++;
+                return FRAME_OK;
+            case FRAME_BAD_CRC:
+                link_stats.crc_errors++;
+                break;
+            case FRAME_BAD_FORMAT:
+                link_stats.format_errors++;
+                break;
+            default:
+                break;
+        }
+    }
+    return FRAME_PENDING;
+}
+
+/******************************************************************************
+ * Function: link_tx_poll
+ * Description: Move as much of the pending frame as fits into the TX ring
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void link_tx_poll(void) {
+    if(tx_pos < tx_len) {
+        tx_pos += uart_write((const char *)&tx_frame[tx_pos], tx_len - tx_pos);
+    }
+}
+
+/******************************************************************************
+ * Function: link_tx_busy
+ * Description: Check whether the previous frame is still being queued
+ * Parameters: None
+ * Returns: 1 if link_send() would refuse a new frame, 0 otherwise
+ ******************************************************************************/
+unsigned char link_tx_busy(void) {
+    link_tx_poll();
+    return tx_pos < tx_len;
+}
+
+/******************************************************************************
+ * Function: link_send
+ * Description: Encode one frame and start queueing it
+ * Parameters: type    - message type
+ *             seq     - sequence number
+ *             payload - payload bytes
+ *             length  - payload bytes, at most FRAME_MAX_PAYLOAD
+ * Returns: 1 if accepted, 0 if busy with the previous frame or too long
+ ******************************************************************************/
+unsigned char link_send(unsigned char type, unsigned char seq,
+                        const unsigned char *payload, unsigned char length) {
+    unsigned char len;
+
+    if(link_tx_busy()) {
+        return 0;
+    }
+    len = frame_encode(tx_frame, type, seq, payload, length);
+    if(len == 0) {
+        return 0;
+    }
+    tx_len = len;
+    tx_pos = 0;
+    link_stats.frames_tx++;
+    link_tx_poll();
+    return 1;
+}
@@ -0,0 +1,50 @@
+/******************************************************************************
+ * PIC18F4550 Binary Link - COBS Frames over the EUSART Driver
+ * Used by: Experiment Q7 (uart_binary_link.c)
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ *
+ * Description:
+ *   Connects the frame codec (Common/frame.c) to the interrupt-driven
+ *   UART rings (uart_driver.c). Neither direction ever waits:
+ *
+ *   - link_send() encodes a frame into a private buffer and queues as
+ *     much of it as the TX ring has room for; link_tx_poll() queues the
+ *     rest later. Only one frame is in flight, so link_send() refuses
+ *     (returns 0) while the previous one is still being queued.
+ *   - link_receive() drains the RX ring into the decoder and stops at
+ *     the first complete, CRC-checked frame, which is then available in
+ *     link_rx until the next call.
+ *
+ * Message Classes (see Q7_UART_Serial_Communication/link_protocol.h):
+ *   Requests from the host carry the host's sequence number; the reply
+ *   uses the request type with LINK_RESPONSE set and the same number.
+ *   Unsolicited (streaming) messages use the board's own counter, which
+ *   increases by one per message so the host can count lost frames.
+ ******************************************************************************/
+
+#ifndef FRAME_LINK_H
+#define FRAME_LINK_H
+
+#include "../../Common/frame.h"
+
+// Link Statistics
+typedef struct {
+    unsigned int frames_rx;     // Valid frames received
+    unsigned int frames_tx;     // Frames queued for transmission
+    unsigned int crc_errors;    // Frames dropped for a bad CRC
+    unsigned int format_errors; // Frames dropped for bad COBS or length
+} link_stats_t;
+
+extern frame_decoder_t link_rx;
+extern link_stats_t link_stats;
+
+void link_init(void);
+unsigned char link_receive(void);
+unsigned char link_send(unsigned char type, unsigned char seq,
+                        const unsigned char *payload, unsigned char length);
+void link_tx_poll(void);
+unsigned char link_tx_busy(void);
+
+#endif
@@ -0,0 +1,92 @@
+/******************************************************************************
+ * PIC18F4550 Interrupt Priorities - High/Low Vector Split
+ * Used by: programs with more than one interrupt source (Q6, Q7, Q8)
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ *
+ * Description:
+ *   With one vector every source waits for whichever handler is running,
+ *   so the worst-case latency of a sample timer or UART RX is the
+ *   longest handler in the program (the tick, the TX ring, ADC post-
+ *   processing) plus the context save. With IPEN set, a high-priority
+ *   source interrupts a low-priority handler. Its worst case is then its
+ *   own vector's context save and the other high-priority handlers,
+ *   however long the low-priority work is.
+ *
+ *   Rule of thumb for this repo:
+ *     high  UART RX (a byte must be read within 2 character times),
+ *           sample timers (the sample instant is the measurement)
+ *     low   Timer1 tick, UART TX, LCD and ADC post-processing: work that
+ *           only has to finish before its next event
+ *
+ *   XC8 returns from the high vector with RETFIE FAST (WREG, STATUS and
+ *   BSR come back from the shadow registers) and saves them in software
+ *   on the low vector, because a high interrupt would overwrite the
+ *   shadow copy. Functions called from both vectors are duplicated by
+ *   the compiler, so each vector gets its own locals.
+ *
+ * Usage:
+ *   IRQ_PRIORITY_INIT();                   // first thing in main
+ *   IRQ_SET(IPR1bits.RCIP, IRQ_HIGH);      // raise the critical sources
+ *   ... driver init: they set PEIE (= GIEL) and GIE (= GIEH) as before
+ *
+ *   void IRQ_LOW_HANDLER isr_low(void) {   // bookkeeping sources
+ *       uart_tx_isr();
+ *   }
+ *   void __interrupt(high_priority) ISR(void) {
+ *       uart_rx_isr();
+ *       IRQ_CALL_LOW(isr_low);
+ *   }
+ *
+ *   IRQ_PRIORITY 0 (project define) restores the single vector: isr_low
+ *   becomes a plain function called at the end of the high handler, in
+ *   the order the sources were serviced before. Build both ways and
+ *   compare with Q6_Buzzer_Timer_Interrupt/irq_priority_bench.c (the
+ *   before/after latency figures are not recorded yet).
+ *
+ * Notes:
+ *   - IRQ_PRIORITY_INIT() puts every source on the low vector, so a
+ *     source nobody raised is never high by accident (the reset state
+ *     is all high). INT0 has no priority bit and is always high.
+ *   - INTCONbits.GIE = 0 in main (GIEH) still masks both vectors.
+ *   - Data shared between a high and a low handler needs the same care
+ *     as data shared with main: the low handler can be interrupted.
+ ******************************************************************************/
+
+#ifndef IRQ_PRIORITY_H
+#define IRQ_PRIORITY_H
+
+#ifndef IRQ_PRIORITY
+#define IRQ_PRIORITY        1
+#endif
+
+#define IRQ_HIGH            1
+#define IRQ_LOW             0
+
+#if IRQ_PRIORITY
+
+#define IRQ_PRIORITY_INIT() {                                               \
+    IPR1 = 0x00;                                                            \
+    IPR2 = 0x00;                                                            \
+    INTCON2bits.TMR0IP = 0;                                                 \
+    INTCON2bits.RBIP = 0;                                                   \
+    INTCON3bits.INT1IP = 0;                                                 \
+    INTCON3bits.INT2IP = 0;                                                 \
+    RCONbits.IPEN = 1;                                                      \
+}
+
+#define IRQ_SET(ip_bit, level)  { ip_bit = (level); }
+#define IRQ_LOW_HANDLER         __interrupt(low_priority)
+#define IRQ_CALL_LOW(handler)
+
+#else
+
+#define IRQ_PRIORITY_INIT()     { RCONbits.IPEN = 0; }
+#define IRQ_SET(ip_bit, level)
+#define IRQ_LOW_HANDLER
+#define IRQ_CALL_LOW(handler)   handler()
+
+#endif
+
+#endif
@@ -0,0 +1,86 @@
+/******************************************************************************
+ * PIC18F4550 Fast ISRs - Shadow Registers and Access-Bank State
+ * Used by: Drivers/timer_wheel.c, Drivers/uart_driver.c, Experiments Q6/Q7
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ *
+ * Description:
+ *   On an interrupt the PIC18 copies WREG, STATUS and BSR into shadow
+ *   registers, and RETFIE FAST copies them back in one instruction. XC8
+ *   returns from the high-priority vector that way, so those three cost
+ *   nothing there. Everything else the handler touches is saved and
+ *   restored in software by XC8: FSR0-2, PRODL/H, TBLPTR/TABLAT, PCLATH/U
+ *   and its own temporaries (btemp). This applies to the handler and to
+ *   every function it calls. For a handler whose body is a flag test and
+ *   a counter increment, that prologue and epilogue cost more than the
+ *   body.
+ *
+ *   ISR_FAST (project define, default 0) builds the hot handlers so the
+ *   shadow registers are all they need:
+ *     - the body is written inline in the high-priority ISR: no CALL, so
+ *       no callee save set and no return-stack use
+ *     - variables it touches are ISR_NEAR (XC8 __near = access bank):
+ *       addressed with a = 0, so no MOVLB and BSR does not matter
+ *     - no pointers or arrays (FSR), no multiply (PROD), no const
+ *       tables (TBLPTR), no arithmetic wider than the counter itself
+ *   Entry plus exit is then the hardware latency (3-4 cycles), the GOTO
+ *   at 0x0008 (2) and RETFIE FAST (2): about 8 cycles around the body.
+ *
+ * Only the High Vector:
+ *   The shadow registers hold a single copy. A high-priority interrupt
+ *   arriving during a low-priority handler overwrites them, so the low
+ *   vector (Drivers/irq_priority.h) always saves WREG/STATUS/BSR in
+ *   software. A fast handler must therefore be high priority: raise its
+ *   source with IRQ_SET(..., IRQ_HIGH). A short fast handler can be on
+ *   the high vector even though it is only bookkeeping. It delays the
+ *   other high sources by less than their own context save would. With
+ *   IRQ_PRIORITY 0 the single vector is the high one and RETFIE FAST
+ *   applies as well.
+ *
+ * Measuring the Saving:
+ *   The entry plus exit figure above is the data sheet's (latency, GOTO,
+ *   RETFIE FAST); what ISR_FAST 0 adds to it is XC8's generated save
+ *   set, which depends on the compiler version and mode. The cycles
+ *   saved per interrupt have NOT been measured yet: that part of the
+ *   change is still open. Q6_Buzzer_Timer_Interrupt/isr_fast_bench.c
+ *   measures the whole cost per tick both ways in the MPLAB X simulator
+ *   (low_cycles, fast_cycles, saved_cycles); record its results here.
+ *   RX keeps its function, so the FSR0 save for the ring store stays;
+ *   its access-bank indices and statistics drop the bank selects, and
+ *   nothing else changes.
+ *
+ * Checking a Build:
+ *   In the listing (Disassembly Listing File) the high ISR should be the
+ *   body followed by RETFIE 1. Any MOVFF to ??_ISR or a CALL in it means a
+ *   rule above was broken and XC8 went back to saving context.
+ *
+ * Notes:
+ *   - Access RAM is 96 bytes (0x00-0x5F) shared with XC8's temporaries;
+ *     ISR_NEAR is only for the few bytes a fast handler uses
+ *   - Not with ISR_STATS: its hooks use banked slots and the tick's
+ *     latency calls into isr_stats.c from the handler, which is
+ *     exactly the save set this mode removes
+ *   - TIMER1_PERIOD_CCP 0: the reload written inline may take a different
+ *     number of cycles from read to write than inside timer_wheel_isr();
+ *     check TIMER1_RELOAD_LAG with tick_drift_bench.c
+ ******************************************************************************/
+
+#ifndef ISR_FAST_H
+#define ISR_FAST_H
+
+#ifndef ISR_FAST
+#define ISR_FAST            0
+#endif
+
+#if ISR_FAST
+#define ISR_NEAR            __near
+#else
+#define ISR_NEAR
+#endif
+
+#if ISR_FAST && defined(ISR_STATS) && ISR_STATS
+#error "ISR_STATS adds calls to the handlers; measure ISR_FAST with isr_fast_bench.c instead"
+#endif
+
+#endif
@@ -0,0 +1,256 @@
+/******************************************************************************
+ * PIC18F4550 ISR Statistics - Implementation
+ * See isr_stats.h for what is measured and what it costs.
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "isr_stats.h"
+
+#if ISR_STATS
+
+#include "system_config.h"
+#include "timer1_period.h"
+#include "uart_driver.h"
+#include "../../Common/numfmt.h"
+
+volatile unsigned char isr_stats_active[ISR_STATS_SOURCES];
+volatile unsigned char isr_stats_ready[ISR_STATS_SOURCES];
+volatile unsigned int isr_stats_stamp[ISR_STATS_SOURCES];
+volatile unsigned int isr_stats_end[ISR_STATS_SOURCES];
+volatile unsigned int isr_stats_latency[ISR_STATS_SOURCES];
+volatile unsigned int isr_stats_missed[ISR_STATS_SOURCES];
+
+// Records, written only by isr_stats_poll() in main
+static isr_stats_t stats[ISR_STATS_SOURCES];
+
+/******************************************************************************
+ * Function: isr_stats_clear
+ * Description: Empty one source's record
+ * Parameters: s - record to clear
+ * Returns: None
+ ******************************************************************************/
+static void isr_stats_clear(isr_stats_t *s) {
+    unsigned char i;
+
+    s->count = 0;
+    s->missed = 0;
+    s->latency_min = 0xFFFF;
+    s->latency_max = 0;
+    for(i = 0; i < ISR_STATS_BUCKETS; i++) {
+        s->histogram[i] = 0;
+    }
+    s->exec_min = 0xFFFF;
+    s->exec_max = 0;
+    s->exec_total = 0;
+}
+
+/******************************************************************************
+ * Function: isr_stats_init
+ * Description: Clear every source and start Timer3 free running at
+ *              Fosc/4 1:1. Call before interrupts are enabled.
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void isr_stats_init(void) {
+    unsigned char i;
+
+    for(i = 0; i < ISR_STATS_SOURCES; i++) {
+        isr_stats_active[i] = 0;
+        isr_stats_ready[i] = 0;
+        isr_stats_missed[i] = 0;
+        isr_stats_clear(&stats[i]);
+    }
+
+    // RD16, 1:1, Fosc/4, on; T3CCP2:T3CCP1 = 00 leaves both CCPs on Timer1
+    T3CON = 0x81;
+}
+
+/******************************************************************************
+ * Function: isr_stats_tmr1_cycles
+ * Description: Cycles since Timer1 restarted its period (CCP1 match or
+ *              overflow), for the tick's latency
+ * Parameters: None
+ * Returns: Timer1 count times its prescaler
+ ******************************************************************************/
+unsigned int isr_stats_tmr1_cycles(void) {
+    unsigned int count;
+
+    count = TMR1L;                      // Latches TMR1H (RD16)
+    count |= (unsigned int)TMR1H << 8;
+    return count * (unsigned int)TIMER1_PERIOD_PRESCALE;
+}
+
+/******************************************************************************
+ * Function: isr_stats_fold
+ * Description: Add the run waiting in a source's slot to its record
+ * Parameters: src - source id (slot ready)
+ * Returns: None
+ ******************************************************************************/
+static void isr_stats_fold(unsigned char src) {
+    isr_stats_t *s = &stats[src];
+    unsigned int exec, latency;
+    unsigned char bucket;
+
+    // Wraps correctly below 65536
+    exec = isr_stats_end[src] - isr_stats_stamp[src];
+    latency = isr_stats_latency[src];
+
+    s->count++;
+    s->exec_total += exec;
+    if(exec < s->exec_min) {
+        s->exec_min = exec;
+    }
+    if(exec > s->exec_max) {
+        s->exec_max = exec;
+    }
+
+    if(latency == ISR_LATENCY_NONE) {
+        return;
+    }
+    if(latency < s->latency_min) {
+        s->latency_min = latency;
+    }
+    if(latency > s->latency_max) {
+        s->latency_max = latency;
+    }
+    bucket = (latency >> ISR_STATS_SHIFT) < ISR_STATS_BUCKETS ?
+             (unsigned char)(latency >> ISR_STATS_SHIFT) : ISR_STATS_BUCKETS - 1;
+    if(s->histogram[bucket] != 0xFFFF) {
+        s->histogram[bucket]++;
+    }
+}
+
+/******************************************************************************
+ * Function: isr_stats_poll
+ * Description: Fold every finished run into its source's record and free
+ *              the slot for the next one. Call from the main loop; the
+ *              ISR does not touch a slot while it is ready, so nothing
+ *              is masked.
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void isr_stats_poll(void) {
+    unsigned char src;
+
+    for(src = 0; src < ISR_STATS_SOURCES; src++) {
+        if(isr_stats_ready[src]) {
+            isr_stats_fold(src);
+            isr_stats_ready[src] = 0;
+        }
+    }
+}
+
+/******************************************************************************
+ * Function: isr_stats_get
+ * Description: Copy one source's record, including a run that finished
+ *              since the last poll. No interrupt is masked, so reading
+ *              the statistics does not add to the latency they measure.
+ * Parameters: src - source id, copy - destination
+ * Returns: None
+ ******************************************************************************/
+void isr_stats_get(unsigned char src, isr_stats_t *copy) {
+    isr_stats_poll();
+    *copy = stats[src];
+    ATOMIC_READ(copy->missed, isr_stats_missed[src]);
+}
+
+/******************************************************************************
+ * Function: isr_stats_reset
+ * Description: Start one source's record again. Call through
+ *              ISR_STATS_RESET, which masks the source: its ISR writes
+ *              the slot and the 16-bit missed count.
+ * Parameters: src - source id
+ * Returns: None
+ ******************************************************************************/
+void isr_stats_reset(unsigned char src) {
+    isr_stats_ready[src] = 0;           // Drop a run not folded in yet
+    isr_stats_missed[src] = 0;
+    isr_stats_clear(&stats[src]);
+}
+
+/******************************************************************************
+ * Function: send
+ * Description: Queue a string on the UART, waiting while the ring is full
+ * Parameters: str - null-terminated string
+ * Returns: None
+ ******************************************************************************/
+static void send(const char *str) {
+    while(*str) {
+        str += uart_write_string(str);
+    }
+}
+
+/******************************************************************************
+ * Function: send_u32
+ * Description: Queue a number on the UART
+ * Parameters: value - number to print
+ * Returns: None
+ ******************************************************************************/
+static void send_u32(unsigned long value) {
+    char number[11];
+
+    fmt_u32(number, value, 0, ' ');
+    send(number);
+}
+
+/******************************************************************************
+ * Function: isr_stats_report
+ * Description: Print one source's record over the UART (Drivers/uart_driver.c),
+ *              e.g.
+ *                TICK n=5000 missed 0 exec 58..71 avg 59 cyc
+ *                  latency 41..187 cyc: 0-15:0 16-31:0 32-47:4987 ... 112+:2
+ *              The latency line is left out for ISR_LATENCY_NONE sources.
+ * Parameters: src - source id, name - label for the line
+ * Returns: None
+ ******************************************************************************/
+void isr_stats_report(unsigned char src, const char *name) {
+    isr_stats_t s;
+    unsigned char i;
+
+    isr_stats_get(src, &s);
+
+    send(name);
+    send(" n=");
+    send_u32(s.count);
+    send(" missed ");
+    send_u32(s.missed);
+    if(s.count == 0) {
+        send("\r\n");
+        return;
+    }
+    send(" exec ");
+    send_u32(s.exec_min);
+    send("..");
+    send_u32(s.exec_max);
+    send(" avg ");
+    send_u32(s.exec_total / s.count);
+    send(" cyc\r\n");
+
+    if(s.latency_max == 0 && s.latency_min == 0xFFFF) {
+        return;                         // No latency for this source
+    }
+    send("  latency ");
+    send_u32(s.latency_min);
+    send("..");
+    send_u32(s.latency_max);
+    send(" cyc:");
+    for(i = 0; i < ISR_STATS_BUCKETS; i++) {
+        send(" ");
+        send_u32((unsigned long)i << ISR_STATS_SHIFT);
+        if(i < ISR_STATS_BUCKETS - 1) {
+            send("-");
+            send_u32((((unsigned long)i + 1) << ISR_STATS_SHIFT) - 1);
+        } else {
+            send("+");
+        }
+        send(":");
+        send_u32(s.histogram[i]);
+    }
+    send("\r\n");
+}
+
+#endif
@@ -0,0 +1,167 @@
+/******************************************************************************
+ * PIC18F4550 ISR Statistics - Latency and Execution Time per Source
+ * Used by: Experiment Q6 (buzzer_timer.c), Experiment Q7
+ *          (uart_communication.c)
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ *
+ * Description:
+ *   Opt-in instrumentation for interrupt handlers. With ISR_STATS defined
+ *   to 1 (project define), each instrumented source gets:
+ *     count          handler runs measured
+ *     missed         runs not measured because the previous one had not
+ *                    been folded in yet (see below; stops at 65535)
+ *     latency        cycles from the hardware event to the first
+ *                    instruction of the handler: min, max and a histogram
+ *                    of ISR_STATS_BUCKETS buckets, each 2^ISR_STATS_SHIFT
+ *                    cycles wide (the last also counts everything above;
+ *                    each bucket stops at 65535)
+ *     exec           cycles spent in the handler: min, max, total
+ *   Latency includes the XC8 context save and any time the source waited
+ *   behind another handler or a critical section in main, which is what
+ *   delays a source. While missed is 0, exec * count is the time the
+ *   source took from main.
+ *
+ *   The handler only takes timestamps: ENTER stores the Timer3 count and
+ *   the latency, EXIT stores the Timer3 count and marks the run ready.
+ *   isr_stats_poll(), called from the main loop, turns a ready run into
+ *   the min/max/total and the histogram and frees the slot for the next
+ *   run. A run that starts while the slot is still full is counted in
+ *   missed and not timed, so call isr_stats_poll() at least as often as
+ *   the source interrupts.
+ *
+ *   exec includes the end of ENTER (the latency store) and the start of
+ *   EXIT (one bit test) and exec_total wraps after 2^32 cycles (about 36
+ *   minutes of handler time at 8 MHz).
+ *
+ *   Timestamps come from Timer3, free running at Fosc/4 1:1. Latency is
+ *   only known when the event time can be read back: for the Timer1 tick
+ *   (timer1_period.h) it is the Timer1 count at entry, because Timer1
+ *   restarted from 0 at the event. Sources such as UART RX, whose event
+ *   time the hardware does not keep, pass ISR_LATENCY_NONE and record
+ *   execution time only.
+ *
+ *   With ISR_STATS 0 (default) every macro is empty: the handlers compile
+ *   exactly as before and Timer3 stays free.
+ *
+ * Usage (in the application's ISR):
+ *   ISR_STATS_ENTER(SRC_TICK, TIMER1_PERIOD_PENDING(), ISR_LATENCY_TMR1());
+ *   timer_wheel_isr();
+ *   ISR_STATS_EXIT(SRC_TICK);
+ *   The pending condition must be tested before the handler clears it,
+ *   and must include the source's enable bit (see ISR_STATS_RESET).
+ *
+ * Usage (in main):
+ *   while(1) {
+ *       isr_stats_poll();
+ *       ...
+ *   }
+ *   ISR_STATS_RESET(SRC_RX, PIE1bits.RCIE);
+ *
+ * Cost: in the handler ENTER is the pending and slot tests, a 16-bit
+ * Timer3 read and the latency store; EXIT is a bit test, a 16-bit Timer3
+ * read and a byte store. Neither calls a function or depends on the
+ * histogram size. The compares and the histogram run in main.
+ * Reporting masks no interrupt, so it adds nothing to the latency
+ * figures; ISR_STATS_RESET holds off only the source it clears
+ * (ATOMIC_MASK, Common/atomic.h).
+ *
+ * Resources:
+ *   Timer3 (so not together with adc_sampler.c or adc_scanner.c).
+ ******************************************************************************/
+
+#ifndef ISR_STATS_H
+#define ISR_STATS_H
+
+#ifndef ISR_STATS
+#define ISR_STATS               0
+#endif
+
+// Instrumented sources (ids 0 .. ISR_STATS_SOURCES - 1, chosen by the app)
+#ifndef ISR_STATS_SOURCES
+#define ISR_STATS_SOURCES       4
+#endif
+
+// Latency histogram: 8 buckets of 16 cycles, the last is 112 and up
+#define ISR_STATS_BUCKETS       8
+#define ISR_STATS_SHIFT         4
+
+// Latency argument for sources without a readable event time
+#define ISR_LATENCY_NONE        0xFFFF
+
+typedef struct {
+    unsigned long count;
+    unsigned int missed;
+    unsigned int latency_min;
+    unsigned int latency_max;
+    unsigned int histogram[ISR_STATS_BUCKETS];
+    unsigned int exec_min;
+    unsigned int exec_max;
+    unsigned long exec_total;
+} isr_stats_t;
+
+#if ISR_STATS
+
+#include "../../Common/atomic.h"
+
+// Per-source slot: one run, written by its ISR, folded in by main
+extern volatile unsigned char isr_stats_active[ISR_STATS_SOURCES];
+extern volatile unsigned char isr_stats_ready[ISR_STATS_SOURCES];
+extern volatile unsigned int isr_stats_stamp[ISR_STATS_SOURCES];
+extern volatile unsigned int isr_stats_end[ISR_STATS_SOURCES];
+extern volatile unsigned int isr_stats_latency[ISR_STATS_SOURCES];
+extern volatile unsigned int isr_stats_missed[ISR_STATS_SOURCES];
+
+// Timer1 counts since the period restarted, in cycles (timer1_period.h)
+#define ISR_LATENCY_TMR1()      isr_stats_tmr1_cycles()
+
+#define ISR_STATS_ENTER(src, pending, latency) {                            \
+    isr_stats_active[src] = 0;                                              \
+    if(pending) {                                                           \
+        if(isr_stats_ready[src]) {      /* Last run not folded in yet */    \
+            if(isr_stats_missed[src] != 0xFFFF) {                           \
+                isr_stats_missed[src]++;                                    \
+            }                                                               \
+        } else {                                                            \
+            isr_stats_active[src] = 1;                                      \
+            isr_stats_stamp[src] = TMR3L;   /* Latches TMR3H (RD16) */      \
+            isr_stats_stamp[src] |= (unsigned int)TMR3H << 8;               \
+            isr_stats_latency[src] = (latency);                             \
+        }                                                                   \
+    }                                                                       \
+}
+
+#define ISR_STATS_EXIT(src) {                                               \
+    if(isr_stats_active[src]) {                                             \
+        isr_stats_end[src] = TMR3L;         /* Latches TMR3H (RD16) */      \
+        isr_stats_end[src] |= (unsigned int)TMR3H << 8;                     \
+        isr_stats_ready[src] = 1;           /* For isr_stats_poll() */      \
+    }                                                                       \
+}
+
+// Start one source's record again; enable is its interrupt enable bit
+// (e.g. PIE1bits.RCIE), held off while the ISR's part is cleared
+#define ISR_STATS_RESET(src, enable) {                                      \
+    ATOMIC_MASK_BEGIN(enable)                                               \
+        isr_stats_reset(src);                                               \
+    ATOMIC_MASK_END(enable)                                                 \
+}
+
+void isr_stats_init(void);
+unsigned int isr_stats_tmr1_cycles(void);
+void isr_stats_poll(void);
+void isr_stats_get(unsigned char src, isr_stats_t *copy);
+void isr_stats_reset(unsigned char src);
+void isr_stats_report(unsigned char src, const char *name);
+
+#else
+
+#define ISR_LATENCY_TMR1()      ISR_LATENCY_NONE
+#define ISR_STATS_ENTER(src, pending, latency)
+#define ISR_STATS_EXIT(src)
+#define ISR_STATS_RESET(src, enable)
+
+#endif
+
+#endif
@@ -0,0 +1,35 @@
+/******************************************************************************
+ * PIC18F4550 System Configuration - Clock and Baud Rate
+ * Used by: the Drivers sources and the experiment programs using them
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ *
+ * Description:
+ *   One place for the values every compile-time calculation depends on.
+ *   Drivers and application files include this header, so the UART
+ *   driver and the program that calls it can never disagree about the
+ *   clock. Values may also be overridden from Project Properties ->
+ *   XC8 Compiler -> Define macros (e.g. _XTAL_FREQ=48000000).
+ *
+ * Clock Options:
+ *   8000000   Internal oscillator, OSCCON IRCF = 111 (kit default,
+ *             matches system_init() in the experiment programs)
+ *   48000000  20 MHz crystal with 96 MHz PLL / 2 (FOSC = HSPLL_HS,
+ *             PLLDIV = 5, CPUDIV = OSC1_PLL2)
+ ******************************************************************************/
+
+#ifndef SYSTEM_CONFIG_H
+#define SYSTEM_CONFIG_H
+
+// CPU Clock (Hz)
+#ifndef _XTAL_FREQ
+#define _XTAL_FREQ      8000000UL
+#endif
+
+// UART Baud Rate (checked against _XTAL_FREQ in uart_baud.h)
+#ifndef UART_BAUD
+#define UART_BAUD       9600UL
+#endif
+
+#endif
@@ -0,0 +1,187 @@
+/******************************************************************************
+ * PIC18F4550 Timer1 Period - Compile-Time Setup and Drift-Free Reload
+ * Used by: Drivers/timer_wheel.c and Experiment Q6 (tick_drift_bench.c)
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ *
+ * Description:
+ *   Turns TIMER1_PERIOD_US into Timer1 settings for _XTAL_FREQ
+ *   (system_config.h) in the preprocessor, and restarts each period
+ *   without the drift of the old "TMR1H = 0xD1; TMR1L = 0x1B" reload.
+ *   That reload runs after the interrupt latency, so every period is
+ *   longer by the latency plus the reload code and the error adds up:
+ *   about 25 cycles on a 2000-cycle tick is 1.25%, 18 minutes a day.
+ *
+ *   Two ways to restart the period are offered:
+ *
+ *   TIMER1_PERIOD_CCP = 1 (default): CCP1 compare with special event
+ *     trigger (CCP1M = 1011). The hardware resets TMR1 when it reaches
+ *     CCPR1, so the period is exactly CCPR1 + 1 counts and the interrupt
+ *     (CCP1IF) does not touch the timer at all. Prescale 1, 2, 4 or 8 is
+ *     chosen for long periods. Uses CCP1, so not with CCP1 PWM.
+ *
+ *   TIMER1_PERIOD_CCP = 0: TMR1 overflow with the reload added to the
+ *     running count. The ISR reads TMR1 (which already holds the latency)
+ *     and writes back TMR1 + 65536 - counts + TIMER1_RELOAD_LAG, where
+ *     TIMER1_RELOAD_LAG covers the cycles the read-add-write sequence
+ *     itself takes. Latency no longer matters; only a wrong LAG does,
+ *     by 1 count per tick per cycle of error. Needs prescale 1:1 (a write
+ *     clears the prescaler, losing a varying part count), so periods up
+ *     to 65536 cycles. Leaves CCP1 free.
+ *
+ * Accumulated Drift over 24 h (host model, 8 MHz, 1 ms tick, interrupt
+ * latency 20-80 cycles at random, old reload written 4 cycles after
+ * entry; 86.4 million ticks, clock tolerance not included):
+ *   Method                                    Period error  Clock after 24 h
+ *   Fixed write after latency (old Q6 code)     +2.70%      -38.9 min
+ *   Add to running count, LAG exact              0           0 s
+ *   Add to running count, LAG off by 1 cycle   +500 ppm     -43.2 s
+ *   CCP1 special event reset                     0           0 s
+ *   Check LAG for your compiler settings with tick_drift_bench.c. Note
+ *   that the internal oscillator itself is only trimmed to about 1%;
+ *   the clock source, not the reload, sets the accuracy from here on.
+ *
+ * Outputs:
+ *   TIMER1_PERIOD_CYCLES           Period in instruction cycles
+ *   TIMER1_PERIOD_PRESCALE         1, 2, 4 or 8
+ *   TIMER1_PERIOD_COUNTS           Timer1 counts per period
+ *   TIMER1_PERIOD_ERROR_PPM        Rounding error of the period
+ *   TIMER1_PERIOD_START()          Configure, enable the interrupt, run
+ *   TIMER1_PERIOD_PENDING()        Period interrupt enabled and flagged
+ *   TIMER1_PERIOD_IP               Its priority bit (Drivers/irq_priority.h)
+ *   TIMER1_PERIOD_ACK()            Clear the flag (and reload); call once
+ *                                  per period from the ISR
+ *   TIMER1_PERIOD_STOP()           Stop and disable the interrupt
+ ******************************************************************************/
+
+#ifndef TIMER1_PERIOD_H
+#define TIMER1_PERIOD_H
+
+#include "system_config.h"
+
+// Period in microseconds (at most 65536 cycles without CCP, 524288 with)
+#ifndef TIMER1_PERIOD_US
+#define TIMER1_PERIOD_US        1000UL
+#endif
+
+// 1 = CCP1 special event reset, 0 = reload added to the running count
+#ifndef TIMER1_PERIOD_CCP
+#define TIMER1_PERIOD_CCP       1
+#endif
+
+// Cycles from the TMR1L read to the TMR1L write in TIMER1_PERIOD_ACK()
+#ifndef TIMER1_RELOAD_LAG
+#define TIMER1_RELOAD_LAG       10
+#endif
+
+// Period in cycles, rounded (kHz first keeps the product within 32 bits)
+#define TIMER1_PERIOD_MCYCLES   (((_XTAL_FREQ) / 4000UL) * (TIMER1_PERIOD_US))
+#define TIMER1_PERIOD_CYCLES    ((TIMER1_PERIOD_MCYCLES + 500UL) / 1000UL)
+
+#if TIMER1_PERIOD_CYCLES < 100
+#error "TIMER1_PERIOD_US too short for a Timer1 interrupt"
+#endif
+
+#if TIMER1_PERIOD_CCP
+#if TIMER1_PERIOD_CYCLES <= 65536UL
+#define TIMER1_PERIOD_PRESCALE  1UL
+#define TIMER1_T1CKPS           0x00
+#elif TIMER1_PERIOD_CYCLES <= 131072UL
+#define TIMER1_PERIOD_PRESCALE  2UL
+#define TIMER1_T1CKPS           0x10
+#elif TIMER1_PERIOD_CYCLES <= 262144UL
+#define TIMER1_PERIOD_PRESCALE  4UL
+#define TIMER1_T1CKPS           0x20
+#elif TIMER1_PERIOD_CYCLES <= 524288UL
+#define TIMER1_PERIOD_PRESCALE  8UL
+#define TIMER1_T1CKPS           0x30
+#else
+#error "TIMER1_PERIOD_US too long for Timer1 at 1:8"
+#endif
+#else
+#if TIMER1_PERIOD_CYCLES > 65536UL
+#error "TIMER1_PERIOD_US too long for the 1:1 reload; use TIMER1_PERIOD_CCP 1"
+#endif
+#define TIMER1_PERIOD_PRESCALE  1UL
+#define TIMER1_T1CKPS           0x00
+#endif
+
+#define TIMER1_PERIOD_COUNTS    ((TIMER1_PERIOD_CYCLES + TIMER1_PERIOD_PRESCALE / 2) / TIMER1_PERIOD_PRESCALE)
+
+// (actual - wanted) / wanted in ppm, from millicycles to stay within 32 bits
+#define TIMER1_PERIOD_ACTUAL_MCYCLES    (TIMER1_PERIOD_COUNTS * TIMER1_PERIOD_PRESCALE * 1000UL)
+#if TIMER1_PERIOD_ACTUAL_MCYCLES >= TIMER1_PERIOD_MCYCLES
+#define TIMER1_PERIOD_ERROR_PPM ((long)((TIMER1_PERIOD_ACTUAL_MCYCLES - TIMER1_PERIOD_MCYCLES) * 1000UL / (TIMER1_PERIOD_MCYCLES / 1000UL)))
+#else
+#define TIMER1_PERIOD_ERROR_PPM (-(long)((TIMER1_PERIOD_MCYCLES - TIMER1_PERIOD_ACTUAL_MCYCLES) * 1000UL / (TIMER1_PERIOD_MCYCLES / 1000UL)))
+#endif
+
+#if TIMER1_PERIOD_CCP
+
+// CCPR1 match resets TMR1: period = CCPR1 + 1 counts
+#define TIMER1_PERIOD_START() {                                             \
+    T1CON = 0x80 | TIMER1_T1CKPS;           /* RD16, Fosc/4, off */         \
+    T3CONbits.T3CCP2 = 0;                   /* Timer1 clocks CCP1 */        \
+    TMR1H = 0;                                                              \
+    TMR1L = 0;                                                              \
+    CCPR1H = (unsigned char)((TIMER1_PERIOD_COUNTS - 1) >> 8);              \
+    CCPR1L = (unsigned char)(TIMER1_PERIOD_COUNTS - 1);                     \
+    CCP1CON = 0x0B;                         /* Compare, special event */    \
+    PIR1bits.CCP1IF = 0;                                                    \
+    PIE1bits.CCP1IE = 1;                                                    \
+    INTCONbits.PEIE = 1;                                                    \
+    INTCONbits.GIE = 1;                                                     \
+    T1CONbits.TMR1ON = 1;                                                   \
+}
+
+#define TIMER1_PERIOD_PENDING() (PIE1bits.CCP1IE && PIR1bits.CCP1IF)
+#define TIMER1_PERIOD_IP        IPR1bits.CCP1IP
+#define TIMER1_PERIOD_ACK()     { PIR1bits.CCP1IF = 0; }
+
+#define TIMER1_PERIOD_STOP() {                                              \
+    T1CONbits.TMR1ON = 0;                                                   \
+    PIE1bits.CCP1IE = 0;                                                    \
+    CCP1CON = 0x00;                                                         \
+}
+
+#else
+
+// Added to TMR1 at each overflow: the distance to the next overflow is
+// then exactly TIMER1_PERIOD_COUNTS from the previous one
+#define TIMER1_RELOAD_ADD       ((unsigned int)(65536UL - TIMER1_PERIOD_COUNTS + (TIMER1_RELOAD_LAG)))
+
+#define TIMER1_PERIOD_START() {                                             \
+    T1CON = 0x80;                           /* RD16, 1:1, Fosc/4, off */    \
+    TMR1H = (unsigned char)((65536UL - TIMER1_PERIOD_COUNTS) >> 8);         \
+    TMR1L = (unsigned char)(65536UL - TIMER1_PERIOD_COUNTS);                \
+    PIR1bits.TMR1IF = 0;                                                    \
+    PIE1bits.TMR1IE = 1;                                                    \
+    INTCONbits.PEIE = 1;                                                    \
+    INTCONbits.GIE = 1;                                                     \
+    T1CONbits.TMR1ON = 1;                                                   \
+}
+
+#define TIMER1_PERIOD_PENDING() (PIE1bits.TMR1IE && PIR1bits.TMR1IF)
+#define TIMER1_PERIOD_IP        IPR1bits.TMR1IP
+
+// Straight-line code so the read-to-write time is the constant LAG;
+// reading TMR1L latches TMR1H, writing TMR1L loads both bytes (RD16)
+#define TIMER1_PERIOD_ACK() {                                               \
+    unsigned int t1_count;                                                  \
+    t1_count = TMR1L;                                                       \
+    t1_count |= (unsigned int)TMR1H << 8;                                   \
+    t1_count += TIMER1_RELOAD_ADD;                                          \
+    TMR1H = (unsigned char)(t1_count >> 8);                                 \
+    TMR1L = (unsigned char)t1_count;                                        \
+    PIR1bits.TMR1IF = 0;                                                    \
+}
+
+#define TIMER1_PERIOD_STOP() {                                              \
+    T1CONbits.TMR1ON = 0;                                                   \
+    PIE1bits.TMR1IE = 0;                                                    \
+}
+
+#endif
+
+#endif
@@ -0,0 +1,223 @@
+/******************************************************************************
+ * PIC18F4550 Timer Wheel - Implementation
+ * See timer_wheel.h for the slot/rounds rules and the cost table.
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "timer_wheel.h"
+
+// List of timers due this tick, kept in heads[] after the wheel slots
+#define EXPIRED             TIMER_WHEEL_SLOTS
+
+// Timer slots as parallel arrays: byte-indexed, cheap to address on PIC18
+static unsigned char next[TIMER_WHEEL_MAX];
+static unsigned char prev[TIMER_WHEEL_MAX];
+static unsigned char list[TIMER_WHEEL_MAX];     // heads[] index or TIMER_NONE
+static unsigned int rounds[TIMER_WHEEL_MAX];
+static unsigned int periods[TIMER_WHEEL_MAX];
+static timer_callback_t callbacks[TIMER_WHEEL_MAX];
+
+static unsigned char heads[TIMER_WHEEL_SLOTS + 1];
+
+// Tick counts shared with the ISR (access bank with ISR_FAST, see
+// TIMER_WHEEL_TICK); lost_seen is timer_wheel_lost at the last report
+volatile ISR_NEAR unsigned char timer_wheel_ticks = 0;
+volatile ISR_NEAR unsigned char timer_wheel_done = 0;
+volatile ISR_NEAR unsigned char timer_wheel_lost = 0;
+static unsigned char lost_seen = 0;
+static unsigned int now = 0;
+
+/******************************************************************************
+ * Function: list_insert
+ * Description: Insert a timer at the head of a list
+ * Parameters: id - timer, head - heads[] index
+ * Returns: None
+ ******************************************************************************/
+static void list_insert(unsigned char id, unsigned char head) {
+    unsigned char first = heads[head];
+
+    next[id] = first;
+    prev[id] = TIMER_NONE;
+    if(first != TIMER_NONE) {
+        prev[first] = id;
+    }
+    heads[head] = id;
+    list[id] = head;
+}
+
+/******************************************************************************
+ * Function: list_remove
+ * Description: Remove a timer from whichever list holds it
+ * Parameters: id - timer, must be in a list
+ * Returns: None
+ ******************************************************************************/
+static void list_remove(unsigned char id) {
+    unsigned char n = next[id];
+    unsigned char p = prev[id];
+
+    if(p != TIMER_NONE) {
+        next[p] = n;
+    } else {
+        heads[list[id]] = n;
+    }
+    if(n != TIMER_NONE) {
+        prev[n] = p;
+    }
+    list[id] = TIMER_NONE;
+}
+
+/******************************************************************************
+ * Function: arm
+ * Description: Put a timer into the wheel slot of tick now + delay
+ * Parameters: id - timer, delay - ticks from now (0 is treated as 1)
+ * Returns: None
+ ******************************************************************************/
+static void arm(unsigned char id, unsigned int delay) {
+    if(delay == 0) {
+        delay = 1;
+    }
+    rounds[id] = (delay - 1) >> TIMER_WHEEL_SHIFT;
+    list_insert(id, (unsigned char)((now + delay) & TIMER_WHEEL_MASK));
+}
+
+/******************************************************************************
+ * Function: timer_wheel_init
+ * Description: Disarm all timers and start the Timer1 tick interrupt
+ *              (timer1_period.h)
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void timer_wheel_init(void) {
+    unsigned char i;
+
+    for(i = 0; i < TIMER_WHEEL_MAX; i++) {
+        list[i] = TIMER_NONE;
+    }
+    for(i = 0; i <= TIMER_WHEEL_SLOTS; i++) {
+        heads[i] = TIMER_NONE;
+    }
+    timer_wheel_ticks = 0;
+    timer_wheel_done = 0;
+    lost_seen = timer_wheel_lost;
+    now = 0;
+
+    TIMER1_PERIOD_START();
+}
+
+/******************************************************************************
+ * Function: timer_wheel_add
+ * Description: Arm a timer, replacing any earlier setting of the same id
+ * Parameters: id       - timer slot, 0 to TIMER_WHEEL_MAX - 1
+ *             delay    - ticks until the first expiry (0 = next tick)
+ *             period   - ticks between later expiries, 0 for one-shot
+ *             callback - called from timer_wheel_run() on each expiry
+ * Returns: None
+ ******************************************************************************/
+void timer_wheel_add(unsigned char id, unsigned int delay, unsigned int period, timer_callback_t callback) {
+    if(list[id] != TIMER_NONE) {
+        list_remove(id);
+    }
+    periods[id] = period;
+    callbacks[id] = callback;
+    arm(id, delay);
+}
+
+/******************************************************************************
+ * Function: timer_wheel_cancel
+ * Description: Disarm a timer. Safe on a timer that is not armed, and from
+ *              a callback, also for a timer due in the same tick.
+ * Parameters: id - timer slot
+ * Returns: None
+ ******************************************************************************/
+void timer_wheel_cancel(unsigned char id) {
+    if(list[id] != TIMER_NONE) {
+        list_remove(id);
+    }
+}
+
+/******************************************************************************
+ * Function: timer_wheel_armed
+ * Description: Whether a timer will still fire
+ * Parameters: id - timer slot
+ * Returns: 1 if armed, 0 if idle
+ ******************************************************************************/
+unsigned char timer_wheel_armed(unsigned char id) {
+    return list[id] != TIMER_NONE;
+}
+
+/******************************************************************************
+ * Function: timer_wheel_run
+ * Description: Process every tick counted since the last call: visit the
+ *              tick's slot, move the timers that are due to the expired
+ *              list, then re-arm the periodic ones and call back. The
+ *              expired list is emptied one timer at a time so callbacks
+ *              may cancel or re-add any timer. timer_wheel_done moves
+ *              only after a tick is processed, so the ISR never counts
+ *              more than TIMER_WHEEL_MAX_PENDING ahead of it.
+ * Parameters: None
+ * Returns: Number of ticks processed (more than 1 means main was late),
+ *          or TIMER_WHEEL_OVERRUN if the ISR dropped ticks since the
+ *          last call because main was TIMER_WHEEL_MAX_PENDING behind
+ ******************************************************************************/
+unsigned char timer_wheel_run(void) {
+    unsigned char processed = 0;
+    unsigned char id, following, lost;
+
+    while(timer_wheel_done != timer_wheel_ticks) {
+        processed++;
+        now++;
+
+        id = heads[now & TIMER_WHEEL_MASK];
+        while(id != TIMER_NONE) {
+            following = next[id];
+            if(rounds[id] == 0) {
+                list_remove(id);
+                list_insert(id, EXPIRED);
+            } else {
+                rounds[id]--;
+            }
+            id = following;
+        }
+
+        while((id = heads[EXPIRED]) != TIMER_NONE) {
+            list_remove(id);
+            if(periods[id] != 0) {
+                arm(id, periods[id]);
+            }
+            callbacks[id](id);
+        }
+        timer_wheel_done++;
+    }
+
+    lost = timer_wheel_lost;
+    if(lost != lost_seen) {
+        lost_seen = lost;
+        return TIMER_WHEEL_OVERRUN;
+    }
+    return processed;
+}
+
+/******************************************************************************
+ * Function: timer_wheel_now
+ * Description: Tick count processed so far (wraps every 65536 ticks)
+ * Parameters: None
+ * Returns: Current wheel time in ticks
+ ******************************************************************************/
+unsigned int timer_wheel_now(void) {
+    return now;
+}
+
+/******************************************************************************
+ * Function: timer_wheel_isr
+ * Description: Count one tick; call from the ISR. The cost does not
+ *              depend on the number of armed timers.
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void timer_wheel_isr(void) {
+    TIMER_WHEEL_TICK();
+}
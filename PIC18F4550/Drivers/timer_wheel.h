@@ -0,0 +1,130 @@
+/******************************************************************************
+ * PIC18F4550 Timer Wheel - Many Software Timers on One Timer1 Tick
+ * Used by: Experiment Q6 (buzzer_timer.c, timer_wheel_bench.c)
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ *
+ * Description:
+ *   Timer1 interrupts every TIMER_WHEEL_TICK_US, restarted without drift
+ *   by Drivers/timer1_period.h. The interrupt only counts the tick, so
+ *   its cost is the same whether no timer or all TIMER_WHEEL_MAX timers
+ *   are armed. timer_wheel_run(), called from the main loop, catches up
+ *   with the counted ticks and fires the timers that are due; callbacks
+ *   therefore run in main context and may take their time, print, or
+ *   start and cancel timers (themselves included).
+ *
+ *   The timers are TIMER_WHEEL_MAX static slots; the application names
+ *   them by index (e.g. #define TIMER_BEEP 0). Each armed timer sits in
+ *   one of TIMER_WHEEL_SLOTS lists, picked by the low bits of its due
+ *   tick, with a count of whole wheel turns still to wait:
+ *
+ *     slot   = (now + delay) % TIMER_WHEEL_SLOTS
+ *     rounds = (delay - 1) / TIMER_WHEEL_SLOTS
+ *
+ *   Each tick visits one slot only. Adding and cancelling are O(1): a
+ *   list insert at the head or an unlink through the prev/next links.
+ *   A periodic timer is re-armed from its due tick, not from the time
+ *   main got round to it, so a late main loop does not make it drift.
+ *
+ * Cost (estimates for XC8 at 8 MHz, 1 ms tick; see timer_wheel_bench.c):
+ *   Timer1 ISR: about 50 cycles per tick including context save, for
+ *   any number of armed timers (2.5% of the CPU at 2000 cycles/tick);
+ *   about 14 with TIMER_WHEEL_TICK() on the high vector (isr_fast.h,
+ *   isr_fast_bench.c measures both).
+ *
+ *   timer_wheel_run() per tick, 16 slots, timers spread evenly:
+ *     Armed   Timers in the slot   Cycles per tick (without callbacks)
+ *       1          0.06                 ~35
+ *       8          0.5                  ~45
+ *      32          2                    ~75
+ *   about 35 + 20 per timer in the visited slot, + ~60 per expiry. The
+ *   worst case is every timer hashing to the same slot (35 + 20 * N);
+ *   it is still paid by main, never by the interrupt.
+ *
+ * Rules:
+ *   - Call timer_wheel_add/cancel only from main context (callbacks are
+ *     main context). The ISR never touches the lists, so no interrupt
+ *     masking is needed anywhere.
+ *   - Call timer_wheel_run() at least every TIMER_WHEEL_MAX_PENDING
+ *     ticks. The ISR counts ticks in 8 bits and stops there instead of
+ *     wrapping: further ticks are dropped and counted in
+ *     timer_wheel_lost, and the next timer_wheel_run() returns
+ *     TIMER_WHEEL_OVERRUN. Every timer is then late by the lost ticks.
+ *
+ * Resources:
+ *   Timer1 and, with TIMER1_PERIOD_CCP 1 (default), CCP1 in compare mode
+ *   (see timer1_period.h); the CCP1 or Timer1 interrupt.
+ *
+ * Interrupt Hook:
+ *   The application's ISR must call timer_wheel_isr(), or expand
+ *   TIMER_WHEEL_TICK() in a high-priority ISR built with ISR_FAST
+ *   (Drivers/isr_fast.h): the same test, acknowledge and count, inline
+ *   on an access-bank counter, so the shadow registers are all the
+ *   context it needs.
+ ******************************************************************************/
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "timer1_period.h"
+#include "isr_fast.h"
+
+// Tick period in microseconds (set TIMER1_PERIOD_US to change it)
+#define TIMER_WHEEL_TICK_US     TIMER1_PERIOD_US
+
+// Static timer slots (timer ids 0 .. TIMER_WHEEL_MAX - 1, at most 254)
+#ifndef TIMER_WHEEL_MAX
+#define TIMER_WHEEL_MAX         32
+#endif
+
+// Wheel size (TIMER_WHEEL_SLOTS = 2^TIMER_WHEEL_SHIFT)
+#define TIMER_WHEEL_SHIFT       4
+#define TIMER_WHEEL_SLOTS       (1 << TIMER_WHEEL_SHIFT)
+#define TIMER_WHEEL_MASK        (TIMER_WHEEL_SLOTS - 1)
+
+// Empty link / "not armed"
+#define TIMER_NONE              0xFF
+
+// Most ticks the ISR holds for timer_wheel_run(); the value above it is
+// timer_wheel_run()'s report that ticks were dropped meanwhile
+#define TIMER_WHEEL_MAX_PENDING 254
+#define TIMER_WHEEL_OVERRUN     255
+
+#if TIMER1_PERIOD_CYCLES < 200
+#error "TIMER1_PERIOD_US too short: the tick interrupt would use most of the CPU"
+#endif
+
+// Ticks counted by the interrupt and ticks processed by timer_wheel_run()
+// (written only by main, read by the ISR); ticks dropped because main
+// fell TIMER_WHEEL_MAX_PENDING behind (modulo 256)
+extern volatile ISR_NEAR unsigned char timer_wheel_ticks;
+extern volatile ISR_NEAR unsigned char timer_wheel_done;
+extern volatile ISR_NEAR unsigned char timer_wheel_lost;
+
+// Interrupt body: count one tick if Timer1 ended a period, unless main
+// has TIMER_WHEEL_MAX_PENDING still to process
+#define TIMER_WHEEL_TICK() {                                                \
+    if(TIMER1_PERIOD_PENDING()) {                                           \
+        TIMER1_PERIOD_ACK();                                                \
+        if((unsigned char)(timer_wheel_ticks - timer_wheel_done) !=          \
+           TIMER_WHEEL_MAX_PENDING) {                                       \
+            timer_wheel_ticks++;                                            \
+        } else {                                                            \
+            timer_wheel_lost++;                                             \
+        }                                                                   \
+    }                                                                       \
+}
+
+// Called with the id of the timer that expired
+typedef void (*timer_callback_t)(unsigned char id);
+
+void timer_wheel_init(void);
+void timer_wheel_add(unsigned char id, unsigned int delay, unsigned int period, timer_callback_t callback);
+void timer_wheel_cancel(unsigned char id);
+unsigned char timer_wheel_armed(unsigned char id);
+unsigned char timer_wheel_run(void);
+unsigned int timer_wheel_now(void);
+void timer_wheel_isr(void);
+
+#endif
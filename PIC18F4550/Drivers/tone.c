@@ -0,0 +1,175 @@
+/******************************************************************************
+ * PIC18F4550 Tone Generator - Implementation
+ * See tone.h for the Timer2/CCP1 settings and the melody rules.
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "tone.h"
+
+// Equal temperament, A5 = 880 Hz, rounded to whole Hz
+static const tone_t note_table[NOTE_COUNT] = {
+    TONE_SETTING(523),  TONE_SETTING(554),  TONE_SETTING(587),
+    TONE_SETTING(622),  TONE_SETTING(659),  TONE_SETTING(698),
+    TONE_SETTING(740),  TONE_SETTING(784),  TONE_SETTING(831),
+    TONE_SETTING(880),  TONE_SETTING(932),  TONE_SETTING(988),
+    TONE_SETTING(1047), TONE_SETTING(1109), TONE_SETTING(1175),
+    TONE_SETTING(1245), TONE_SETTING(1319), TONE_SETTING(1397),
+    TONE_SETTING(1480), TONE_SETTING(1568), TONE_SETTING(1661),
+    TONE_SETTING(1760), TONE_SETTING(1865), TONE_SETTING(1976),
+    TONE_SETTING(2093), TONE_SETTING(2217), TONE_SETTING(2349),
+    TONE_SETTING(2489), TONE_SETTING(2637), TONE_SETTING(2794),
+    TONE_SETTING(2960), TONE_SETTING(3136), TONE_SETTING(3322),
+    TONE_SETTING(3520), TONE_SETTING(3729), TONE_SETTING(3951)
+};
+
+// Melody state: the table is owned by the ISR while busy is set
+static const melody_note_t *melody;
+static unsigned char melody_count;
+static unsigned char melody_pos;
+static unsigned char melody_repeat;
+static volatile unsigned char melody_busy = 0;
+
+/******************************************************************************
+ * Function: tone_init
+ * Description: RC2 as output (low while silent), Timer0 stopped at 1:256
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void tone_init(void) {
+    CCP1CON = 0x00;
+    T2CON = 0x00;
+    LATCbits.LATC2 = 0;
+    TRISCbits.TRISC2 = 0;       // CCP1 output
+
+    T0CON = 0x07;               // Off, 16-bit, Fosc/4, 1:256
+    INTCONbits.TMR0IF = 0;
+    INTCONbits.TMR0IE = 0;
+}
+
+/******************************************************************************
+ * Function: tone_start
+ * Description: Start (or change to) a tone. TMR2 is cleared so a shorter
+ *              PR2 takes effect at once instead of after a wrap at 255.
+ * Parameters: setting - Timer2/CCP1 values from TONE_SETTING()
+ * Returns: None
+ ******************************************************************************/
+void tone_start(const tone_t *setting) {
+    T2CON = setting->t2con;
+    PR2 = setting->pr2;
+    CCPR1L = setting->ccpr1l;
+    CCP1CON = setting->ccp1con;
+    TMR2 = 0;
+}
+
+/******************************************************************************
+ * Function: tone_note
+ * Description: Start a note from the table, or fall silent for NOTE_REST
+ * Parameters: note - NOTE_C5 .. NOTE_B7 or NOTE_REST
+ * Returns: None
+ ******************************************************************************/
+void tone_note(unsigned char note) {
+    if(note < NOTE_COUNT) {
+        tone_start(&note_table[note]);
+    } else {
+        tone_stop();
+    }
+}
+
+/******************************************************************************
+ * Function: tone_stop
+ * Description: Silence the output; RC2 returns to its latch (low)
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void tone_stop(void) {
+    CCP1CON = 0x00;
+    T2CON = 0x00;
+}
+
+/******************************************************************************
+ * Function: melody_next
+ * Description: Start note melody_pos and load Timer0 with its length
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+static void melody_next(void) {
+    const melody_note_t *n = &melody[melody_pos];
+
+    TMR0H = (unsigned char)(n->reload >> 8);    // Buffered until TMR0L
+    TMR0L = (unsigned char)n->reload;
+    tone_note(n->note);
+}
+
+/******************************************************************************
+ * Function: tone_melody_start
+ * Description: Play a table of notes in the background
+ * Parameters: notes  - MELODY_NOTE() entries (must stay valid while busy)
+ *             count  - number of entries, at least 1
+ *             repeat - 1 to loop until tone_melody_stop(), 0 to play once
+ * Returns: None
+ ******************************************************************************/
+void tone_melody_start(const melody_note_t *notes, unsigned char count, unsigned char repeat) {
+    tone_melody_stop();
+
+    melody = notes;
+    melody_count = count;
+    melody_repeat = repeat;
+    melody_pos = 0;
+    melody_busy = 1;
+
+    melody_next();
+    INTCONbits.TMR0IF = 0;
+    INTCONbits.TMR0IE = 1;
+    INTCONbits.GIE = 1;
+    T0CONbits.TMR0ON = 1;
+}
+
+/******************************************************************************
+ * Function: tone_melody_stop
+ * Description: Stop the melody and the tone
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void tone_melody_stop(void) {
+    T0CONbits.TMR0ON = 0;
+    INTCONbits.TMR0IE = 0;
+    melody_busy = 0;
+    tone_stop();
+}
+
+/******************************************************************************
+ * Function: tone_melody_busy
+ * Description: Whether a melody is still playing
+ * Parameters: None
+ * Returns: 1 while playing, 0 when finished or stopped
+ ******************************************************************************/
+unsigned char tone_melody_busy(void) {
+    return melody_busy;
+}
+
+/******************************************************************************
+ * Function: tone_isr
+ * Description: End of a note: start the next one; call from the ISR.
+ *              Runs once per note.
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void tone_isr(void) {
+    if(!(INTCONbits.TMR0IE && INTCONbits.TMR0IF)) {
+        return;
+    }
+    INTCONbits.TMR0IF = 0;
+
+    if(++melody_pos == melody_count) {
+        if(!melody_repeat) {
+            tone_melody_stop();
+            return;
+        }
+        melody_pos = 0;
+    }
+    melody_next();
+}
@@ -0,0 +1,116 @@
+/******************************************************************************
+ * PIC18F4550 Tone Generator - CCP1 PWM Tones and a Melody Player
+ * Used by: Experiment Q6 (buzzer_timer.c, melody_player.c)
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ *
+ * Description:
+ *   A tone is a square wave from CCP1 in PWM mode on Timer2, so once it
+ *   is started the CPU does nothing until the next note. Toggling the
+ *   buzzer from an interrupt cost two interrupts per cycle of the tone
+ *   (1000 per second for 500 Hz); here pitch costs none.
+ *
+ *   The Timer2 settings for every note are worked out at compile time
+ *   from _XTAL_FREQ (TONE_SETTING): the smallest prescaler (1, 4, 16)
+ *   that lets PR2 + 1 = Fcy / (prescale * Hz) fit in 8 bits, and a duty
+ *   cycle of TONE_DUTY_PERCENT of that period. Any frequency in range
+ *   is built the same way: static const tone_t beep = TONE_SETTING(500);
+ *
+ *   The melody player steps through a table of MELODY_NOTE(note, ms)
+ *   entries. Timer0 (16-bit, 1:256) is loaded with each note's length,
+ *   so the only interrupt is one Timer0 overflow per note, where the
+ *   next note's settings are written.
+ *
+ * Range:
+ *   Lowest tone Fcy / (16 * 256): 489 Hz at 8 MHz, 2930 Hz at 48 MHz.
+ *   The note table covers C5 (523 Hz) to B7 (3951 Hz), so it needs
+ *   _XTAL_FREQ = 8 MHz (the Q6 clock). Longest note TONE_MAX_MS: 8.3 s
+ *   at 8 MHz.
+ *   Pitch error from the integer PR2 is under 0.6% (10 cents) at 8 MHz.
+ *
+ * Resources:
+ *   CCP1 (PWM output on RC2), Timer2, Timer0 and its interrupt. CCP1
+ *   cannot be the Timer1 tick at the same time: with Drivers/timer_wheel.c
+ *   define TIMER1_PERIOD_CCP=0.
+ *
+ * Hardware:
+ *   CCP1 drives RC2, the relay pin on the kit; the buzzer sits on RC3.
+ *   Pull the relay jumper and wire RC2 to the buzzer transistor input.
+ *
+ * Interrupt Hook:
+ *   The application's ISR must call tone_isr().
+ ******************************************************************************/
+
+#ifndef TONE_H
+#define TONE_H
+
+#include "system_config.h"
+
+// Duty cycle of every tone in percent (50 = square wave, loudest)
+#ifndef TONE_DUTY_PERCENT
+#define TONE_DUTY_PERCENT   50UL
+#endif
+
+#define TONE_FCY            ((_XTAL_FREQ) / 4)
+#define TONE_MIN_HZ         ((TONE_FCY + 16UL * 256UL - 1) / (16UL * 256UL))
+
+#if TONE_MIN_HZ > 523
+#error "_XTAL_FREQ too high: Timer2 cannot reach the C5 at the bottom of the note table"
+#endif
+
+// Timer2 settings for hz, all constant expressions
+#define TONE_DIV(hz)        ((TONE_FCY + (hz) / 2) / (hz))
+#define TONE_PRE(hz)        (TONE_DIV(hz) <= 256UL ? 1UL : TONE_DIV(hz) <= 1024UL ? 4UL : 16UL)
+#define TONE_T2CKPS(hz)     (TONE_PRE(hz) == 1UL ? 0x00 : TONE_PRE(hz) == 4UL ? 0x01 : 0x02)
+#define TONE_PERIOD(hz)     ((TONE_DIV(hz) + TONE_PRE(hz) / 2) / TONE_PRE(hz))
+#define TONE_DUTY(hz)       (TONE_PERIOD(hz) * 4UL * TONE_DUTY_PERCENT / 100UL)
+
+#define TONE_SETTING(hz) {                                          \
+    (unsigned char)(0x04 | TONE_T2CKPS(hz)),        /* TMR2ON */    \
+    (unsigned char)(TONE_PERIOD(hz) - 1),           /* PR2 */       \
+    (unsigned char)(TONE_DUTY(hz) >> 2),            /* CCPR1L */    \
+    (unsigned char)(0x0C | ((TONE_DUTY(hz) & 3) << 4))  /* PWM, DC1B */ \
+}
+
+typedef struct {
+    unsigned char t2con;
+    unsigned char pr2;
+    unsigned char ccpr1l;
+    unsigned char ccp1con;
+} tone_t;
+
+// Notes: index into the compile-time table
+enum {
+    NOTE_C5, NOTE_CS5, NOTE_D5, NOTE_DS5, NOTE_E5, NOTE_F5,
+    NOTE_FS5, NOTE_G5, NOTE_GS5, NOTE_A5, NOTE_AS5, NOTE_B5,
+    NOTE_C6, NOTE_CS6, NOTE_D6, NOTE_DS6, NOTE_E6, NOTE_F6,
+    NOTE_FS6, NOTE_G6, NOTE_GS6, NOTE_A6, NOTE_AS6, NOTE_B6,
+    NOTE_C7, NOTE_CS7, NOTE_D7, NOTE_DS7, NOTE_E7, NOTE_F7,
+    NOTE_FS7, NOTE_G7, NOTE_GS7, NOTE_A7, NOTE_AS7, NOTE_B7,
+    NOTE_COUNT
+};
+#define NOTE_REST           0xFF
+
+// Timer0 at 1:256: counts for a note length in ms, and the longest note
+#define TONE_T0_COUNTS(ms)  (((unsigned long)(ms) * (TONE_FCY / 1000UL)) / 256UL)
+#define TONE_MAX_MS         (65535UL * 256UL / (TONE_FCY / 1000UL))
+
+// Melody entry: note (or NOTE_REST) and length, as a Timer0 reload value
+typedef struct {
+    unsigned char note;
+    unsigned int reload;
+} melody_note_t;
+
+#define MELODY_NOTE(note, ms)   { (note), (unsigned int)(65536UL - TONE_T0_COUNTS(ms)) }
+
+void tone_init(void);
+void tone_start(const tone_t *setting);
+void tone_note(unsigned char note);
+void tone_stop(void);
+void tone_melody_start(const melody_note_t *notes, unsigned char count, unsigned char repeat);
+void tone_melody_stop(void);
+unsigned char tone_melody_busy(void);
+void tone_isr(void);
+
+#endif
@@ -0,0 +1,85 @@
+/******************************************************************************
+ * PIC18F4550 EUSART Baud Rate Generator - Compile-Time Selection
+ * Used by: Drivers/uart_driver.c
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ *
+ * Description:
+ *   Picks BRG16, BRGH and SPBRGH:SPBRG for UART_BAUD at _XTAL_FREQ (both
+ *   from system_config.h) entirely in the preprocessor, and stops the
+ *   build with #error if the nearest achievable rate is off by more than
+ *   UART_BAUD_MAX_ERROR_X100 (hundredths of a percent).
+ *
+ * EUSART Modes (n = SPBRGH:SPBRG):
+ *   BRG16 BRGH  Baud rate          n range
+ *     1     1   Fosc / (4 (n+1))   0-65535
+ *     1     0   Fosc / (16 (n+1))  0-65535
+ *     0     0   Fosc / (64 (n+1))  0-255
+ *   (BRG16 = 0, BRGH = 1 is Fosc / (16 (n+1)) with n <= 255, a subset of
+ *   the second row.) Every divider the coarser modes can produce is also
+ *   a multiple of 4, so the finest mode is always at least as accurate;
+ *   the coarser modes are used only when n would exceed 65535.
+ *
+ * Exact or Near-Exact Rates (error):
+ *   Baud       8 MHz          48 MHz
+ *   9600       n=207  0.16%   n=1249  0.00%
+ *   57600      n=34   0.79%   n=207   0.16%
+ *   115200     n=16   2.12% x n=103   0.16%
+ *   230400     n=8    3.55% x n=51    0.16%
+ *   250000     n=7    0.00%   n=47    0.00%
+ *   1000000    n=1    0.00%   n=11    0.00%
+ *   (x = rejected by the default 2.00% limit)
+ *
+ * Outputs:
+ *   UART_BRG16, UART_BRGH, UART_BRG_VALUE (16-bit n), UART_BAUD_ACTUAL,
+ *   UART_BAUD_ERROR_X100
+ ******************************************************************************/
+
+#ifndef UART_BAUD_H
+#define UART_BAUD_H
+
+#include "system_config.h"
+
+// Largest accepted baud error in hundredths of a percent (200 = 2.00%)
+#ifndef UART_BAUD_MAX_ERROR_X100
+#define UART_BAUD_MAX_ERROR_X100    200
+#endif
+
+// Rounded SPBRG value for a given clock divisor (4, 16 or 64)
+#define UART_BRG_FOR(div)   (((_XTAL_FREQ) + ((div) * (UART_BAUD)) / 2) / ((div) * (UART_BAUD)) - 1)
+
+#if (_XTAL_FREQ) < 4 * (UART_BAUD)
+#error "UART_BAUD is above Fosc/4, the fastest rate the EUSART can generate"
+#elif UART_BRG_FOR(4UL) <= 65535
+#define UART_BRG16          1
+#define UART_BRGH           1
+#define UART_BRG_DIVISOR    4UL
+#elif UART_BRG_FOR(16UL) <= 65535
+#define UART_BRG16          1
+#define UART_BRGH           0
+#define UART_BRG_DIVISOR    16UL
+#elif UART_BRG_FOR(64UL) <= 255
+#define UART_BRG16          0
+#define UART_BRGH           0
+#define UART_BRG_DIVISOR    64UL
+#else
+#error "UART_BAUD is too slow for _XTAL_FREQ"
+#endif
+
+#define UART_BRG_VALUE      UART_BRG_FOR(UART_BRG_DIVISOR)
+#define UART_BRG_CLOCKS     (UART_BRG_DIVISOR * (UART_BRG_VALUE + 1))
+#define UART_BAUD_ACTUAL    ((_XTAL_FREQ) / UART_BRG_CLOCKS)
+
+// Error = |Fosc - clocks * baud| / (clocks * baud), kept within 32 bits
+#if (_XTAL_FREQ) >= UART_BRG_CLOCKS * (UART_BAUD)
+#define UART_BAUD_ERROR_X100 (((_XTAL_FREQ) - UART_BRG_CLOCKS * (UART_BAUD)) / (UART_BRG_CLOCKS * (UART_BAUD) / 10000))
+#else
+#define UART_BAUD_ERROR_X100 ((UART_BRG_CLOCKS * (UART_BAUD) - (_XTAL_FREQ)) / (UART_BRG_CLOCKS * (UART_BAUD) / 10000))
+#endif
+
+#if UART_BAUD_ERROR_X100 > UART_BAUD_MAX_ERROR_X100
+#error "UART_BAUD cannot be generated within UART_BAUD_MAX_ERROR_X100 at this _XTAL_FREQ (see table in uart_baud.h)"
+#endif
+
+#endif
@@ -0,0 +1,371 @@
+/******************************************************************************
+ * PIC18F4550 EUSART Driver - Implementation
+ * See uart_driver.h for the interrupt hook and ring ownership rules.
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "uart_driver.h"
+#include "uart_baud.h"
+#include "isr_fast.h"
+#include "../../Common/atomic.h"
+
+// Indices and statistics are ISR_NEAR: with ISR_FAST the handlers reach
+// them without a bank select (Drivers/isr_fast.h); the rings stay banked
+
+// Transmit Ring: head written by uart_write, tail written by uart_tx_isr
+static volatile unsigned char tx_buf[UART_TX_SIZE];
+static volatile ISR_NEAR unsigned char tx_head = 0;
+static volatile ISR_NEAR unsigned char tx_tail = 0;
+
+// Receive Ring: head written by uart_rx_isr, tail written by uart_read
+static volatile unsigned char rx_buf[UART_RX_SIZE];
+static volatile ISR_NEAR unsigned char rx_head = 0;
+static volatile ISR_NEAR unsigned char rx_tail = 0;
+static volatile ISR_NEAR uart_rx_stats_t rx_stats;
+static volatile ISR_NEAR unsigned char rx_stats_seq = 0;   // Common/atomic.h
+
+/******************************************************************************
+ * Function: uart_init
+ * Description: Initialize EUSART for asynchronous 8-N-1 with RX interrupt.
+ *              Baud rate registers come from uart_baud.h (UART_BAUD at
+ *              _XTAL_FREQ). The TX interrupt is enabled on demand by
+ *              uart_write().
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void uart_init(void) {
+    // -------------- UART Pin Configuration ---------------
+    TRISCbits.TRISC6 = 0;   // RC6 (TX) as output
+    TRISCbits.TRISC7 = 1;   // RC7 (RX) as input
+
+    // -------------- UART Initialization ------------------
+    TXSTA = 0x20;  // 8-bit transmission, transmitter enabled, asynchronous mode
+    RCSTA = 0x90;  // Serial port enabled, continuous reception, 8-bit reception
+
+    // Baud rate generator (selected at compile time, see uart_baud.h)
+    TXSTAbits.BRGH = UART_BRGH;
+    BAUDCONbits.BRG16 = UART_BRG16;
+    SPBRGH = (unsigned char)(UART_BRG_VALUE >> 8);
+    SPBRG = (unsigned char)UART_BRG_VALUE;
+
+    tx_head = 0;
+    tx_tail = 0;
+    rx_head = 0;
+    rx_tail = 0;
+    rx_stats.bytes = 0;
+    rx_stats.overruns = 0;
+    rx_stats.framing = 0;
+    rx_stats.dropped = 0;
+    rx_stats.high_water = 0;
+
+    // Enable receive interrupt (transmit interrupt stays off until data is queued)
+    PIE1bits.TXIE = 0;
+    PIE1bits.RCIE = 1;      // UART receive interrupt
+    INTCONbits.PEIE = 1;    // Peripheral interrupts
+    INTCONbits.GIE = 1;     // Global interrupts
+}
+
+/******************************************************************************
+ * Function: uart_autobaud
+ * Description: Measure the host baud rate from sync characters.
+ *              1. ABDEN = 1 arms the measurement; the hardware times the
+ *                 first 8 bit periods of the next byte (must be 0x55) and
+ *                 writes SPBRGH:SPBRG, then clears ABDEN.
+ *              2. The measured byte is junk and is discarded.
+ *              3. The next byte must read back as UART_SYNC_CHAR; this
+ *                 confirms the lock. Otherwise the measurement is retried.
+ *              The host should therefore send "UU" (or keep sending 'U')
+ *              until it gets a reply.
+ * Parameters: timeout_ms - approximate time to wait for a valid lock
+ * Returns: 1 if locked, 0 on timeout (compile-time rate restored)
+ ******************************************************************************/
+unsigned char uart_autobaud(unsigned int timeout_ms) {
+    // Each poll pass is roughly 16 instruction cycles
+    const unsigned long polls_per_ms = (_XTAL_FREQ / 4000UL) / 16;
+    unsigned long polls = polls_per_ms * timeout_ms;
+    unsigned char rcie = PIE1bits.RCIE;
+    unsigned char locked = 0;
+    unsigned char data;
+
+    PIE1bits.RCIE = 0;                  // Poll RCIF here, not in the ISR
+    TXSTAbits.BRGH = 1;
+    BAUDCONbits.BRG16 = 1;
+
+    while(!locked && polls) {
+        // Step 1: measure
+        BAUDCONbits.ABDOVF = 0;
+        BAUDCONbits.ABDEN = 1;
+        while(BAUDCONbits.ABDEN && --polls);
+        if(!polls) {
+            break;
+        }
+        data = RCREG;                   // Step 2: discard measured byte
+
+        if(BAUDCONbits.ABDOVF || (SPBRGH == 0 && SPBRG == 0)) {
+            continue;                   // Too slow or too fast: retry
+        }
+
+        // Step 3: confirm with the next character
+        while(!PIR1bits.RCIF && --polls);
+        if(!polls) {
+            break;
+        }
+        if(RCSTAbits.FERR) {
+            data = RCREG;
+            continue;
+        }
+        data = RCREG;
+        locked = (data == UART_SYNC_CHAR);
+    }
+
+    if(!locked) {
+        BAUDCONbits.ABDEN = 0;
+        TXSTAbits.BRGH = UART_BRGH;
+        BAUDCONbits.BRG16 = UART_BRG16;
+        SPBRGH = (unsigned char)(UART_BRG_VALUE >> 8);
+        SPBRG = (unsigned char)UART_BRG_VALUE;
+    }
+
+    // Clear any overrun collected while polling
+    if(RCSTAbits.OERR) {
+        RCSTAbits.CREN = 0;
+        RCSTAbits.CREN = 1;
+    }
+    while(PIR1bits.RCIF) {
+        data = RCREG;
+    }
+
+    PIE1bits.RCIE = rcie;
+    return locked;
+}
+
+/******************************************************************************
+ * Function: uart_get_brg
+ * Description: Current baud rate generator value (SPBRGH:SPBRG)
+ * Parameters: None
+ * Returns: 16-bit BRG value
+ ******************************************************************************/
+unsigned int uart_get_brg(void) {
+    return ((unsigned int)SPBRGH << 8) | SPBRG;
+}
+
+/******************************************************************************
+ * Function: uart_get_baud
+ * Description: Baud rate implied by the current BRG16/BRGH/SPBRG settings
+ * Parameters: None
+ * Returns: Baud rate in bits per second
+ ******************************************************************************/
+unsigned long uart_get_baud(void) {
+    unsigned long clocks;
+
+    if(BAUDCONbits.BRG16) {
+        clocks = (unsigned long)uart_get_brg() + 1;
+    } else {
+        clocks = (unsigned long)SPBRG + 1;  // 8-bit mode ignores SPBRGH
+    }
+    if(BAUDCONbits.BRG16 && TXSTAbits.BRGH) {
+        clocks *= 4;
+    } else if(BAUDCONbits.BRG16 || TXSTAbits.BRGH) {
+        clocks *= 16;
+    } else {
+        clocks *= 64;
+    }
+    return _XTAL_FREQ / clocks;
+}
+
+/******************************************************************************
+ * Function: tx_put
+ * Description: Append one byte to the transmit ring
+ * Parameters: data - byte to queue
+ * Returns: 1 if queued, 0 if the ring is full
+ ******************************************************************************/
+static unsigned char tx_put(unsigned char data) {
+    unsigned char next = (tx_head + 1) & UART_TX_MASK;
+
+    if(next == tx_tail) {
+        return 0;                       // Full
+    }
+    tx_buf[tx_head] = data;
+    tx_head = next;                     // Publish after the data is stored
+    return 1;
+}
+
+/******************************************************************************
+ * Function: uart_write
+ * Description: Queue bytes for transmission without waiting for the line
+ * Parameters: data - bytes to send
+ *             len  - number of bytes
+ * Returns: Number of bytes queued (less than len if the ring filled up)
+ ******************************************************************************/
+unsigned char uart_write(const char *data, unsigned char len) {
+    unsigned char n = 0;
+
+    while(n < len && tx_put(data[n])) {
+        n++;
+    }
+
+    if(n) {
+        PIE1bits.TXIE = 1;              // Start (or keep) the ISR draining
+    }
+    return n;
+}
+
+/******************************************************************************
+ * Function: uart_write_string
+ * Description: Queue a null-terminated string (as much as fits)
+ * Parameters: str - pointer to string
+ * Returns: Number of bytes queued
+ ******************************************************************************/
+unsigned char uart_write_string(const char *str) {
+    unsigned char len = 0;
+
+    while(str[len] && len < UART_TX_MASK) {
+        len++;
+    }
+    return uart_write(str, len);
+}
+
+/******************************************************************************
+ * Function: uart_tx_free
+ * Description: Free space in the transmit ring
+ * Parameters: None
+ * Returns: Number of bytes that can be queued right now
+ ******************************************************************************/
+unsigned char uart_tx_free(void) {
+    return (tx_tail - tx_head - 1) & UART_TX_MASK;
+}
+
+/******************************************************************************
+ * Function: uart_flush
+ * Description: Block until every queued byte has left the shift register
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void uart_flush(void) {
+    while(tx_head != tx_tail);          // Ring drained into TXREG
+    while(TXSTAbits.TRMT == 0);         // Last byte shifted out
+}
+
+/******************************************************************************
+ * Function: uart_tx_isr
+ * Description: Move the next queued byte into TXREG; call from the ISR.
+ *              TXIF stays set while TXREG is empty, so TXIE is cleared
+ *              once the ring runs dry to stop further interrupts.
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void uart_tx_isr(void) {
+    if(PIE1bits.TXIE && PIR1bits.TXIF) {
+        if(tx_tail != tx_head) {
+            TXREG = tx_buf[tx_tail];
+            tx_tail = (tx_tail + 1) & UART_TX_MASK;
+        }
+        if(tx_tail == tx_head) {
+            PIE1bits.TXIE = 0;          // Nothing left to send
+        }
+    }
+}
+
+/******************************************************************************
+ * Function: uart_read
+ * Description: Take the oldest received byte out of the receive ring
+ * Parameters: data - where to store the byte
+ * Returns: 1 if a byte was read, 0 if the ring is empty
+ ******************************************************************************/
+unsigned char uart_read(unsigned char *data) {
+    unsigned char tail = rx_tail;
+
+    if(tail == rx_head) {
+        return 0;                       // Empty
+    }
+    *data = rx_buf[tail];
+    rx_tail = (tail + 1) & UART_RX_MASK;    // Release slot after reading it
+    return 1;
+}
+
+/******************************************************************************
+ * Function: uart_rx_available
+ * Description: Number of received bytes waiting in the ring
+ * Parameters: None
+ * Returns: Byte count (0 to UART_RX_SIZE - 1)
+ ******************************************************************************/
+unsigned char uart_rx_available(void) {
+    return (rx_head - rx_tail) & UART_RX_MASK;
+}
+
+/******************************************************************************
+ * Function: uart_get_rx_stats
+ * Description: Copy the receive statistics. The copy is repeated if the
+ *              receive ISR updated them meanwhile (rx_stats_seq), so
+ *              multi-byte counters are not torn and RCIE is never masked.
+ * Parameters: stats - destination
+ * Returns: None
+ ******************************************************************************/
+void uart_get_rx_stats(uart_rx_stats_t *stats) {
+    ATOMIC_SEQ_READ_BEGIN(rx_stats_seq)
+        stats->bytes = rx_stats.bytes;
+        stats->overruns = rx_stats.overruns;
+        stats->framing = rx_stats.framing;
+        stats->dropped = rx_stats.dropped;
+        stats->high_water = rx_stats.high_water;
+    ATOMIC_SEQ_READ_END(rx_stats_seq)
+}
+
+/******************************************************************************
+ * Function: uart_rx_isr
+ * Description: Move every byte waiting in the EUSART FIFO into the receive
+ *              ring and update the statistics; call from the ISR.
+ *              FERR belongs to the byte at the top of the FIFO, so it is
+ *              checked before RCREG is read. rx_stats_seq moves only
+ *              when a statistic does, so a TX interrupt or an empty
+ *              pass never makes uart_get_rx_stats() copy again.
+ *              Nothing is done while RCIE is clear: uart_autobaud()
+ *              polls RCIF itself then, and another source's interrupt
+ *              must not take its sync bytes.
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void uart_rx_isr(void) {
+    unsigned char data, next, level;
+
+    if(!PIE1bits.RCIE) {
+        return;
+    }
+    while(PIR1bits.RCIF) {
+        if(RCSTAbits.FERR) {
+            data = RCREG;               // Discard byte with bad stop bit
+            rx_stats.framing++;
+            ATOMIC_SEQ_WRITE(rx_stats_seq);
+            continue;
+        }
+        data = RCREG;
+
+        next = (rx_head + 1) & UART_RX_MASK;
+        if(next == rx_tail) {
+            rx_stats.dropped++;         // Ring full
+            ATOMIC_SEQ_WRITE(rx_stats_seq);
+            continue;
+        }
+        rx_buf[rx_head] = data;
+        rx_head = next;                 // Publish after the data is stored
+
+        rx_stats.bytes++;
+        level = (next - rx_tail) & UART_RX_MASK;
+        if(level > rx_stats.high_water) {
+            rx_stats.high_water = level;
+        }
+        ATOMIC_SEQ_WRITE(rx_stats_seq);
+    }
+
+    // Overrun stops reception until CREN is toggled
+    if(RCSTAbits.OERR) {
+        rx_stats.overruns++;
+        RCSTAbits.CREN = 0;
+        RCSTAbits.CREN = 1;
+        ATOMIC_SEQ_WRITE(rx_stats_seq);
+    }
+}
@@ -0,0 +1,86 @@
+/******************************************************************************
+ * PIC18F4550 EUSART Driver - Interrupt-Driven Transmit and Receive
+ * Used by: Experiment Q7 (uart_communication.c)
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ *
+ * Description:
+ *   Transmit data is queued in a RAM ring buffer and moved into TXREG by
+ *   the TXIF interrupt, one byte per interrupt. uart_write() only copies
+ *   bytes into the ring and returns at once, so the CPU is free while
+ *   the line is busy instead of spinning on TXSTAbits.TRMT.
+ *
+ *   Received bytes are stored by the RCIF interrupt in a second ring and
+ *   taken out by main code with uart_read(). Nothing is overwritten while
+ *   main is busy; bytes are only lost if the whole ring fills up, and
+ *   every loss is counted in the receive statistics.
+ *
+ * Baud Rate:
+ *   Set UART_BAUD and _XTAL_FREQ in system_config.h. uart_baud.h picks the
+ *   baud generator mode at compile time and fails the build if the rate
+ *   cannot be met within UART_BAUD_MAX_ERROR_X100.
+ *
+ * Auto-Baud:
+ *   uart_autobaud() lets the EUSART measure the host's rate from a 'U'
+ *   (0x55) sync character and loads SPBRGH:SPBRG with the result, so the
+ *   same image works with whatever rate the host tool uses. It switches
+ *   to BRG16 = 1, BRGH = 1 (finest resolution, up to Fosc/4) and falls
+ *   back to the compile-time rate if no valid sync arrives in time.
+ *
+ * Interrupt Hook:
+ *   The application owns the interrupt vector. Its ISR must call
+ *   uart_rx_isr() and uart_tx_isr() on every interrupt (both check their
+ *   own flags). With ISR_FAST (Drivers/isr_fast.h) the ring indices and
+ *   the receive statistics, 16 bytes, move to the access bank so a
+ *   high-priority RX handler needs no bank selects.
+ *
+ * Single Producer / Single Consumer:
+ *   Each ring has exactly one writer per index: for RX the ISR owns head
+ *   and main owns tail, for TX main owns head and the ISR owns tail.
+ *   Indices are single bytes, so every load/store is atomic on the PIC18
+ *   and neither side ever needs to disable interrupts. A slot is published
+ *   (index advanced) only after its data byte has been written.
+ ******************************************************************************/
+
+#ifndef UART_DRIVER_H
+#define UART_DRIVER_H
+
+// Transmit Ring Size (power of two, max 128; one slot is kept empty)
+#define UART_TX_SIZE    64
+#define UART_TX_MASK    (UART_TX_SIZE - 1)
+
+// Receive Ring Size (power of two, max 128; one slot is kept empty)
+#define UART_RX_SIZE    64
+#define UART_RX_MASK    (UART_RX_SIZE - 1)
+
+// Receive Statistics (updated by uart_rx_isr)
+typedef struct {
+    unsigned long bytes;        // Bytes stored in the receive ring
+    unsigned int  overruns;     // OERR events (hardware FIFO overflowed)
+    unsigned int  framing;      // Bytes discarded with FERR set
+    unsigned int  dropped;      // Bytes lost because the ring was full
+    unsigned char high_water;   // Highest ring fill level seen
+} uart_rx_stats_t;
+
+// Auto-Baud Sync Character (alternating bits, required by the hardware)
+#define UART_SYNC_CHAR  0x55    // 'U'
+
+void uart_init(void);
+unsigned char uart_autobaud(unsigned int timeout_ms);
+unsigned int uart_get_brg(void);
+unsigned long uart_get_baud(void);
+
+unsigned char uart_write(const char *data, unsigned char len);
+unsigned char uart_write_string(const char *str);
+unsigned char uart_tx_free(void);
+void uart_flush(void);
+
+void uart_tx_isr(void);
+
+unsigned char uart_read(unsigned char *data);
+unsigned char uart_rx_available(void);
+void uart_get_rx_stats(uart_rx_stats_t *stats);
+void uart_rx_isr(void);
+
+#endif
@@ -1,40 +1,176 @@
+/******************************************************************************
+ * PIC18F4550 Buzzer Control with Timer1 Interrupt
+ * Experiment Q6: Timer Interrupt Driven Buzzer Pattern
+ *
+ * Author: Microcontroller Lab
+ * Target Device: PIC18F4550
+ * IDE: MPLAB X IDE
+ * Compiler: XC8
+ * Kit: Microembedded PIC18F4550 Development Kit
+ *
+ * Description:
+ *   Timer1 interrupts every 1 ms and drives Drivers/timer_wheel.c.
+ *   Software timers share that one interrupt:
+ *   - TIMER_GATE  (periodic, 2000 ms): switches the tone on and off
+ *   - TIMER_BLINK (periodic, 250 ms):  blinks LED RB0 as a heartbeat
+ *   Another behaviour is one more timer id and callback; the interrupt
+ *   itself never changes and costs the same however many are armed.
+ *   The tick is a low-priority interrupt (Drivers/irq_priority.h): it
+ *   only has to be counted before the next one, so it leaves the high
+ *   vector free for sources that cannot wait.
+ *
+ *   Fast tick (ISR_FAST=1 as a project define, Drivers/isr_fast.h): the
+ *   tick moves to the high vector as TIMER_WHEEL_TICK() inline on an
+ *   access-bank counter. WREG/STATUS/BSR come back from the shadow
+ *   registers and nothing else is saved (not yet measured against the
+ *   low-vector tick; isr_fast_bench.c measures both).
+ *
+ *   The 500 Hz tone uses the kit's buzzer on RC3 by default
+ *   (USE_PWM_TONE 0): a third timer, TIMER_TONE (periodic, 1 ms), toggles
+ *   RC3 from main, 1000 times a second. Opt-in (USE_PWM_TONE=1 and
+ *   TIMER1_PERIOD_CCP=0 as project defines): the tone comes from CCP1 PWM
+ *   (Drivers/tone.c) on RC2 instead, the gate starts and stops it and no
+ *   code runs in between. CCP1 then can't restart the tick, so Timer1
+ *   uses the reload mode.
+ *
+ *   ISR statistics (ISR_STATS=1 as a project define, Drivers/isr_stats.c):
+ *   the tick handler is timed with Timer3 and a fourth timer,
+ *   TIMER_REPORT, prints its latency histogram and execution time over
+ *   the UART every 5 s. Latency is the Timer1 count at entry, i.e. the
+ *   cycles since the CCP1 match or overflow that requested the tick.
+ *
+ * Hardware Configuration:
+ *   Buzzer (Output):   RC3 (HIGH = ON, LOW = OFF)
+ *   PWM tone (opt-in): RC2 (CCP1) is the relay pin: pull the relay
+ *                      jumper and wire RC2 to the buzzer input
+ *   LED (Output):      RB0
+ *   UART TX:           RC6 (ISR_STATS=1 only, 9600 8-N-1 by default)
+ *
+ * Crystal Frequency: 8 MHz (Internal Oscillator)
+ ******************************************************************************/
+
+#include <xc.h>
 #include <pic18f4550.h>
+#include "../Drivers/system_config.h"
+#include "../Drivers/timer_wheel.h"
+#include "../Drivers/tone.h"
+#include "../Drivers/isr_stats.h"
+#include "../Drivers/irq_priority.h"
+#include "../Drivers/isr_fast.h"
+#if ISR_STATS
+#include "../Drivers/uart_driver.h"
+#endif
+
+// Configuration Bits
+#pragma config FOSC = INTOSCIO_EC   // Internal oscillator
+#pragma config WDTE = OFF           // Watchdog Timer disabled
+#pragma config PWRTE = OFF          // Power-up Timer disabled
+#pragma config BOREN = OFF          // Brown-out Reset disabled
+#pragma config PBADEN = OFF         // PORTB pins as digital I/O
+#pragma config LVP = OFF            // Low-Voltage Programming disabled
+#pragma config MCLRE = OFF          // MCLR function disabled
+
+// Tone Source: 0 = software toggle of RC3 (kit wiring), 1 = CCP1 PWM on RC2
+#ifndef USE_PWM_TONE
+#define USE_PWM_TONE    0
+#endif
+
+#if USE_PWM_TONE && TIMER1_PERIOD_CCP
+#error "CCP1 makes the tone: define TIMER1_PERIOD_CCP=0 in the project (XC8 -> Define macros)"
+#endif
+
+// Pin Definitions
+#define Buzzer          LATCbits.LATC3
+#define LED             LATBbits.LATB0
+
+// Timer Slots (Drivers/timer_wheel.h)
+#define TIMER_TONE      0
+#define TIMER_GATE      1
+#define TIMER_BLINK     2
+#define TIMER_REPORT    3
+
+// ISR Statistics Source (Drivers/isr_stats.h)
+#define SRC_TICK        0
+
+// Timing in 1 ms ticks
+#define TONE_HZ         500
+#define TONE_HALF_MS    1           // 1 ms high, 1 ms low = 500 Hz
+#define GATE_MS         2000        // 2 s ON, 2 s OFF
+#define BLINK_MS        250
+#define REPORT_MS       5000
+
+#if USE_PWM_TONE
+
+static const tone_t buzzer_tone = TONE_SETTING(TONE_HZ);
+static unsigned char tone_on = 1;
+
+/******************************************************************************
+ * Function: gate_toggle
+ * Description: TIMER_GATE callback: start or silence the PWM tone
+ * Parameters: id - timer id (unused)
+ * Returns: None
+ ******************************************************************************/
+void gate_toggle(unsigned char id) {
+    tone_on = !tone_on;
+    if(tone_on) {
+        tone_start(&buzzer_tone);
+    } else {
+        tone_stop();
+    }
+}
+
+#else
+
+/******************************************************************************
+ * Function: tone_toggle
+ * Description: TIMER_TONE callback: next half cycle of the tone
+ * Parameters: id - timer id (unused)
+ * Returns: None
+ ******************************************************************************/
+void tone_toggle(unsigned char id) {
+    Buzzer = ~Buzzer;
+}
 
-// Define Buzzer as RA5 output pin
-#define Buzzer LATAbits.LATA5
-
-// Global count variable to count timer overflows
-unsigned int count = 0;
-
-// Interrupt Service Routine (ISR) for handling interrupts
-void __interrupt() Timer1_ISR(void)
-{
-    // Check if Timer1 overflow interrupt flag is set
-    if(TMR1IF == 1)
-    {
-        // Reload Timer1 registers with initial count values
-        // This preload value determines timer overflow interval (~12 ms delay)
-        TMR1L = 0x1B;
-        TMR1H = 0xD1;
-        
-        count++; // Increment overflow count
-        
-        // Toggle buzzer output every 1000 overflows (~12 ms * 1000 = ~12 seconds)
-        if(count >= 1000)
-        {
-            Buzzer = ~Buzzer; // Toggle buzzer pin
-            count = 0;        // Reset overflow count
-        }
-        
-        // Clear Timer1 interrupt flag to allow next interrupt
-        TMR1IF = 0;
+/******************************************************************************
+ * Function: gate_toggle
+ * Description: TIMER_GATE callback: start or silence the tone
+ * Parameters: id - timer id (unused)
+ * Returns: None
+ ******************************************************************************/
+void gate_toggle(unsigned char id) {
+    if(timer_wheel_armed(TIMER_TONE)) {
+        timer_wheel_cancel(TIMER_TONE);
+        Buzzer = 0;                 // Keep buzzer OFF
+    } else {
+        timer_wheel_add(TIMER_TONE, TONE_HALF_MS, TONE_HALF_MS, tone_toggle);
     }
 }
 
-void main()
-{
-    TRISAbits.TRISA5 = 0;  // Configure RA5 as output pin for buzzer
-    // Buzzer = 0;         // (Commented out) Initialize buzzer pin to LOW
+#endif
+
+/******************************************************************************
+ * Function: led_blink
+ * Description: TIMER_BLINK callback: heartbeat LED
+ * Parameters: id - timer id (unused)
+ * Returns: None
+ ******************************************************************************/
+void led_blink(unsigned char id) {
+    LED = ~LED;
+}
+
+#if ISR_STATS
+
+/******************************************************************************
+ * Function: stats_report
+ * Description: TIMER_REPORT callback: print the tick statistics
+ * Parameters: id - timer id (unused)
+ * Returns: None
+ ******************************************************************************/
+void stats_report(unsigned char id) {
+    isr_stats_report(SRC_TICK, "TICK");
+}
+
+#endif
 
 /******************************************************************************
  * Function: system_init
@@ -49,65 +185,137 @@ void system_init(void) {
     OSCCONbits.IRCF0 = 1;
     OSCCONbits.SCS1 = 1;
     OSCCONbits.SCS0 = 0;
-    
+
     // Configure Port C
     TRISCbits.TRISC3 = 0;   // RC3 (Buzzer) as output
     Buzzer = 0;             // Initialize buzzer OFF
+
+    // Configure Port B
+    TRISBbits.TRISB0 = 0;   // RB0 (LED) as output
+    LED = 0;
 }
 
+#if ISR_FAST
+
 /******************************************************************************
  * Function: __interrupt() high_priority ISR
- * Description: High-priority interrupt service routine for Timer1
+ * Description: Timer1 tick, inline: shadow registers only, no calls
  * Parameters: None
  * Returns: None
  ******************************************************************************/
 void __interrupt(high_priority) ISR(void) {
-    // Check if Timer1 interrupt occurred
-    if(PIR1bits.TMR1IF) {
-        PIR1bits.TMR1IF = 0;        // Clear interrupt flag
-        
-        // Reload Timer1 for next interrupt
-        TMR1H = TMR1_HIGH;
-        TMR1L = TMR1_LOW;
-        
-        // Toggle buzzer if enabled
-        if(buzzer_enable) {
-            Buzzer = ~Buzzer;       // Toggle buzzer pin
-        } else {
-            Buzzer = 0;             // Keep buzzer OFF
-        }
-        
-        interrupt_count++;          // Increment interrupt counter
-    }
+    TIMER_WHEEL_TICK();
+}
+
+#else
+
+/******************************************************************************
+ * Function: isr_low
+ * Description: Low-priority interrupts: Timer1 tick for the timer wheel
+ *              (and UART transmit for the statistics report)
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void IRQ_LOW_HANDLER isr_low(void) {
+    ISR_STATS_ENTER(SRC_TICK, TIMER1_PERIOD_PENDING(), ISR_LATENCY_TMR1());
+    timer_wheel_isr();
+    ISR_STATS_EXIT(SRC_TICK);
+#if ISR_STATS
+    uart_tx_isr();
+#endif
+}
+
+/******************************************************************************
+ * Function: __interrupt() high_priority ISR
+ * Description: High-priority interrupts (UART receive for the statistics
+ *              report), then the low ones when IRQ_PRIORITY is 0
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void __interrupt(high_priority) ISR(void) {
+#if ISR_STATS
+    uart_rx_isr();
+#endif
+    IRQ_CALL_LOW(isr_low);
 }
 
+#endif
+
 /******************************************************************************
  * Function: main
- * Description: Main program with buzzer ON/OFF pattern
+ * Description: Arm the timers and run their callbacks forever
  * Parameters: None
  * Returns: None
  ******************************************************************************/
 void main(void) {
     // Initialize system
     system_init();
-    
-    // Initialize Timer1 and interrupts
-    timer1_init();
-    
-    // Main loop: Buzzer ON for 2 sec, OFF for 2 sec
+
+    // The tick is bookkeeping: low priority (Drivers/irq_priority.h),
+    // unless it is short enough for the shadow registers
+    IRQ_PRIORITY_INIT();
+#if ISR_FAST
+    IRQ_SET(TIMER1_PERIOD_IP, IRQ_HIGH);
+#endif
+#if ISR_STATS
+    IRQ_SET(IPR1bits.RCIP, IRQ_HIGH);
+    isr_stats_init();
+    uart_init();
+#endif
+
+    // Start the 1 ms tick, then the buzzer pattern and the heartbeat
+    timer_wheel_init();
+#if USE_PWM_TONE
+    tone_init();
+    tone_start(&buzzer_tone);
+#else
+    timer_wheel_add(TIMER_TONE, TONE_HALF_MS, TONE_HALF_MS, tone_toggle);
+#endif
+    timer_wheel_add(TIMER_GATE, GATE_MS, GATE_MS, gate_toggle);
+    timer_wheel_add(TIMER_BLINK, BLINK_MS, BLINK_MS, led_blink);
+#if ISR_STATS
+    timer_wheel_add(TIMER_REPORT, REPORT_MS, REPORT_MS, stats_report);
+#endif
+
     while(1) {
-        // Buzzer ON for 2 seconds
-        buzzer_enable = 1;      // Enable buzzer toggling in ISR
-        delay_ms(2000);         // Wait 2 seconds
-        
-        // Buzzer OFF for 2 seconds
-        buzzer_enable = 0;      // Disable buzzer toggling
-        Buzzer = 0;             // Ensure buzzer is OFF
-        delay_ms(2000);         // Wait 2 seconds
+        timer_wheel_run();      // Fire whatever is due
+#if ISR_STATS
+        isr_stats_poll();       // Fold in the tick's last run
+#endif
     }
 }
 
-// OUTPUT:
-// Buzzer ON for approximately 1 second
-// Buzzer OFF for approximately 1 second
-// This ON/OFF cycle repeats continuously, creating a 1 Hz square wave with a 50% duty cycle
+/******************************************************************************
+ * Build Instructions:
+ *   1. Create a new MPLAB X project for PIC18F4550 with XC8
+ *   2. Add this file and Drivers/timer_wheel.c to Source Files
+ *   3. Optional PWM tone: add Drivers/tone.c and, in Project Properties
+ *      -> XC8 Compiler -> Define macros, USE_PWM_TONE=1 and
+ *      TIMER1_PERIOD_CCP=0 (CCP1 is busy with the tone); wire RC2 to the
+ *      buzzer as above
+ *   4. Optional: for ISR statistics add Drivers/isr_stats.c,
+ *      Drivers/uart_driver.c and Common/numfmt.c, and define ISR_STATS=1
+ *   5. Optional: define ISR_FAST=1 for the shadow-register tick (not
+ *      together with ISR_STATS)
+ *   6. Build and program
+ *
+ * Testing Instructions:
+ *   1. The buzzer sounds a 500 Hz tone for 2 s, then is silent for 2 s
+ *   2. RB0 blinks twice a second throughout
+ *   3. Optional: timer_wheel_bench.c measures the tick and wheel cost in
+ *      the MPLAB X Simulator
+ *   4. ISR_STATS=1: a terminal at 9600 8-N-1 shows every 5 s e.g.
+ *        TICK n=5000 missed 0 exec 52..60 avg 53 cyc
+ *          latency 38..95 cyc: 0-15:0 16-31:0 32-47:4990 ... 112+:0
+ *      (illustrative, not measured). The tail of the histogram is the
+ *      tick waiting behind a UART interrupt; with missed 0, exec x n /
+ *      10^7 cycles is the tick's share of the CPU over the 5 s.
+ *
+ * Troubleshooting:
+ *   - Tone pitch wrong: _XTAL_FREQ in Drivers/system_config.h must match
+ *     the oscillator (8 MHz internal by default)
+ *   - No tone, LED blinks: with USE_PWM_TONE 1 the tone is on RC2, check
+ *     the wire to the buzzer; otherwise check the buzzer jumper on RC3
+ *   - Nothing happens: the ISR must call timer_wheel_isr() and main must
+ *     keep calling timer_wheel_run()
+ ******************************************************************************/
@@ -0,0 +1,176 @@
+/******************************************************************************
+ * PIC18F4550 Interrupt Priority Benchmark - Worst-Case Latency per Source
+ * Experiment Q6 (variant): Checks Drivers/irq_priority.h
+ *
+ * Author: Microcontroller Lab
+ * Target Device: PIC18F4550
+ * IDE: MPLAB X IDE
+ * Compiler: XC8
+ *
+ * Description:
+ *   Two interrupt sources run together, as in adc_logger.c and
+ *   buzzer_timer.c:
+ *     sample  Timer2 every 500 cycles (4 kHz at 8 MHz), short handler;
+ *             high priority in the split
+ *     tick    Timer1/CCP1 every 1 ms (Drivers/timer1_period.h) with
+ *             BENCH_TICK_WORK cycles of bookkeeping, standing in for the
+ *             timer wheel, an LCD queue or ADC post-processing; low
+ *             priority in the split
+ *   Each handler first reads its own timer. Both timers restart from 0
+ *   at the event, so that count is the latency in cycles: Timer2 at 1:4
+ *   (4-cycle steps), Timer1 at 1:1. The minimum and maximum per source
+ *   are kept for BENCH_TICKS ticks.
+ *
+ *   Build twice:
+ *     IRQ_PRIORITY=1 (default)  sample high, tick low
+ *     IRQ_PRIORITY=0            one vector, both sources in one handler
+ *
+ * Reading Results:
+ *   MPLAB X Simulator: run until bench_done is 1, then add
+ *   sample_lat_min/max, tick_lat_min/max, samples and ticks to the Watch
+ *   window.
+ *
+ * Status:
+ *   Only partly done. Neither build has been run yet, so there are no
+ *   before/after sample_lat_max and tick_lat_max figures; record both
+ *   builds' Watch values here once they have been.
+ *
+ * Expected Direction (worked out from the handler lengths, not measured):
+ *   IRQ_PRIORITY 0: sample_lat_max is about BENCH_TICK_WORK plus both
+ *   context switches (350-400 cycles), because a sample that falls
+ *   due during the tick waits for all of it.
+ *   IRQ_PRIORITY 1: sample_lat_max drops to the high vector's entry
+ *   cost (a few tens of cycles) whatever BENCH_TICK_WORK is. tick_lat_max
+ *   grows by at most one sample handler, which the tick can afford: it
+ *   only has to be counted before the next tick, 2000 cycles later.
+ *   sample_lat_min is the same in both builds (no contention).
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "../Drivers/system_config.h"
+#include "../Drivers/timer1_period.h"
+#include "../Drivers/irq_priority.h"
+
+// Configuration Bits
+#pragma config FOSC = INTOSCIO_EC   // Internal oscillator
+#pragma config WDTE = OFF           // Watchdog Timer disabled
+#pragma config PWRTE = OFF          // Power-up Timer disabled
+#pragma config BOREN = OFF          // Brown-out Reset disabled
+#pragma config PBADEN = OFF         // PORTB pins as digital I/O
+#pragma config LVP = OFF            // Low-Voltage Programming disabled
+#pragma config MCLRE = OFF          // MCLR function disabled
+
+#define BENCH_TICKS         2000U
+
+// Bookkeeping in the tick handler, in passes of about 4 cycles
+#ifndef BENCH_TICK_WORK
+#define BENCH_TICK_WORK     300
+#endif
+
+// Timer2: 1:4 prescale, PR2 + 1 = 125 -> 500 cycles per sample
+#define SAMPLE_PRESCALE     4
+#define SAMPLE_PR2          124
+
+// Timer1 counts are read as cycles
+#if TIMER1_PERIOD_PRESCALE != 1
+#error "irq_priority_bench needs a Timer1 period below 65536 cycles (1:1 prescale)"
+#endif
+
+#if BENCH_TICK_WORK >= (SAMPLE_PR2 + 1) * SAMPLE_PRESCALE
+#error "BENCH_TICK_WORK must stay below one sample period, or single-vector samples are lost"
+#endif
+
+volatile unsigned int ticks = 0;
+volatile unsigned char bench_done = 0;
+unsigned long samples = 0;
+unsigned int sample_lat_min = 0xFFFF;
+unsigned int sample_lat_max = 0;
+unsigned int tick_lat_min = 0xFFFF;
+unsigned int tick_lat_max = 0;
+
+/******************************************************************************
+ * Function: isr_low
+ * Description: Tick: record the latency, then do the bookkeeping
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void IRQ_LOW_HANDLER isr_low(void) {
+    unsigned int latency;
+    unsigned char work;
+
+    if(TIMER1_PERIOD_PENDING()) {
+        latency = TMR1L;                // Latches TMR1H (RD16)
+        latency |= (unsigned int)TMR1H << 8;
+        TIMER1_PERIOD_ACK();
+
+        if(latency < tick_lat_min) tick_lat_min = latency;
+        if(latency > tick_lat_max) tick_lat_max = latency;
+
+        work = BENCH_TICK_WORK / 4;
+        while(work--);                  // ~4 cycles per pass
+
+        if(++ticks == BENCH_TICKS) {
+            T1CONbits.TMR1ON = 0;
+            T2CONbits.TMR2ON = 0;
+            bench_done = 1;
+        }
+    }
+}
+
+/******************************************************************************
+ * Function: __interrupt() high_priority ISR
+ * Description: Sample timer: record the latency (then the tick when
+ *              IRQ_PRIORITY is 0)
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void __interrupt(high_priority) ISR(void) {
+    unsigned int latency;
+
+    if(PIE1bits.TMR2IE && PIR1bits.TMR2IF) {
+        latency = (unsigned int)TMR2 * SAMPLE_PRESCALE;
+        PIR1bits.TMR2IF = 0;
+        samples++;
+        if(latency < sample_lat_min) sample_lat_min = latency;
+        if(latency > sample_lat_max) sample_lat_max = latency;
+    }
+    IRQ_CALL_LOW(isr_low);
+}
+
+/******************************************************************************
+ * Function: main
+ * Description: Start both sources and wait for the run to finish
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void main(void) {
+    IRQ_PRIORITY_INIT();
+    IRQ_SET(IPR1bits.TMR2IP, IRQ_HIGH);
+
+    // Sample timer
+    PR2 = SAMPLE_PR2;
+    TMR2 = 0;
+    T2CON = 0x01;                   // 1:1 postscale, 1:4 prescale, off
+    PIR1bits.TMR2IF = 0;
+    PIE1bits.TMR2IE = 1;
+
+    // Tick (enables PEIE/GIEL and GIE/GIEH)
+    TIMER1_PERIOD_START();
+    T2CONbits.TMR2ON = 1;
+
+    while(!bench_done);
+
+    while(1);   // Inspect results in the Watch window
+}
+
+/******************************************************************************
+ * Build Instructions:
+ *   1. Create a new MPLAB X project for PIC18F4550 with XC8 and add only
+ *      this file (the drivers it uses are header-only)
+ *   2. Debugger: Simulator
+ *   3. Build and run once as is, then again with IRQ_PRIORITY=0 in
+ *      Project Properties -> XC8 -> Define macros, and compare
+ *   4. Optional: vary BENCH_TICK_WORK; only the single-vector
+ *      sample_lat_max follows it
+ ******************************************************************************/
@@ -0,0 +1,183 @@
+/******************************************************************************
+ * PIC18F4550 Fast ISR Benchmark - Cycles per Tick Interrupt, Whole Cost
+ * Experiment Q6 (variant): Checks Drivers/isr_fast.h
+ *
+ * Author: Microcontroller Lab
+ * Target Device: PIC18F4550
+ * IDE: MPLAB X IDE
+ * Compiler: XC8
+ *
+ * Description:
+ *   timer_wheel_bench.c times the tick body but not the context save XC8
+ *   wraps around it. This bench measures what the main loop actually
+ *   loses per interrupt: hardware latency, prologue, body, epilogue and
+ *   return together, exactly as the compiler generated them.
+ *
+ *   main counts passes of a fixed loop for one Timer3 window (1:4,
+ *   262144 cycles), three times:
+ *     idle   tick interrupts masked: the loop's own speed
+ *     low    tick on the low vector calling timer_wheel_isr(), as
+ *            buzzer_timer.c builds it by default
+ *     fast   tick on the high vector with TIMER_WHEEL_TICK() inline,
+ *            as buzzer_timer.c builds it with ISR_FAST=1
+ *   The passes missing against idle, converted to cycles and divided by
+ *   the ticks in the window, give the cycles per interrupt. Both
+ *   handlers are in this one build and the tick's priority bit picks
+ *   which one runs, so the comparison uses the same code for both.
+ *
+ *   Build with ISR_FAST=1 (project define). The low run then uses the
+ *   access-bank counter too, which makes it about 1 cycle cheaper than
+ *   a real ISR_FAST 0 build (one MOVLB).
+ *
+ * Reading Results:
+ *   MPLAB X Simulator (or the board with a debugger): run until
+ *   bench_done is 1, then add low_cycles, fast_cycles, saved_cycles,
+ *   ticks_low and ticks_fast to the Watch window. Copy the figures into
+ *   the cost table in Drivers/isr_fast.h.
+ *
+ * Results:
+ *   Not run yet; no figures are recorded for either vector. fast_cycles
+ *   cannot be below the 8 cycles of entry plus exit (Drivers/isr_fast.h).
+ *   ticks_low and ticks_fast are 131 or 132 (262144 / 2000). The result
+ *   is good to about 1 cycle: a tick at the edge of the window may be
+ *   counted without its cycles falling inside it.
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "../Drivers/system_config.h"
+#include "../Drivers/timer_wheel.h"
+#include "../Drivers/irq_priority.h"
+#include "../Drivers/isr_fast.h"
+
+// Configuration Bits
+#pragma config FOSC = INTOSCIO_EC   // Internal oscillator
+#pragma config WDTE = OFF           // Watchdog Timer disabled
+#pragma config PWRTE = OFF          // Power-up Timer disabled
+#pragma config BOREN = OFF          // Brown-out Reset disabled
+#pragma config PBADEN = OFF         // PORTB pins as digital I/O
+#pragma config LVP = OFF            // Low-Voltage Programming disabled
+#pragma config MCLRE = OFF          // MCLR function disabled
+
+#if !ISR_FAST
+#error "Build isr_fast_bench.c with ISR_FAST=1 (XC8 -> Define macros)"
+#endif
+
+#if !IRQ_PRIORITY
+#error "isr_fast_bench.c compares the low and high vectors: IRQ_PRIORITY must be 1"
+#endif
+
+// Timer3 window: 1:4 prescale, 65536 counts
+#define WINDOW_CYCLES       262144UL
+
+unsigned long passes_idle, passes_low, passes_fast;
+unsigned char ticks_idle, ticks_low, ticks_fast;
+unsigned int low_cycles, fast_cycles, saved_cycles;
+volatile unsigned char bench_done = 0;
+
+/******************************************************************************
+ * Function: isr_low
+ * Description: Tick as the default build has it: low vector, call
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void IRQ_LOW_HANDLER isr_low(void) {
+    timer_wheel_isr();
+}
+
+/******************************************************************************
+ * Function: __interrupt() high_priority ISR
+ * Description: Tick as ISR_FAST builds it: inline, shadow registers only
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void __interrupt(high_priority) ISR(void) {
+    TIMER_WHEEL_TICK();
+}
+
+/******************************************************************************
+ * Function: window
+ * Description: Count loop passes until Timer3 overflows once
+ * Parameters: ticks - ticks counted by the interrupt meanwhile
+ * Returns: Loop passes
+ ******************************************************************************/
+static unsigned long window(unsigned char *ticks) {
+    unsigned long passes = 0;
+    unsigned char start;
+
+    TMR3H = 0;
+    TMR3L = 0;
+    PIR2bits.TMR3IF = 0;
+    start = timer_wheel_ticks;
+    T3CONbits.TMR3ON = 1;
+    while(!PIR2bits.TMR3IF) {
+        passes++;
+    }
+    T3CONbits.TMR3ON = 0;
+    *ticks = timer_wheel_ticks - start;
+
+    // Catch up outside the window; otherwise the pending ticks reach
+    // TIMER_WHEEL_MAX_PENDING by the third window and the ISR drops ticks
+    timer_wheel_run();
+    return passes;
+}
+
+/******************************************************************************
+ * Function: per_interrupt
+ * Description: Cycles taken from the loop per interrupt, rounded
+ * Parameters: passes - passes with interrupts, ticks - interrupts
+ * Returns: Cycles per interrupt (0 if no tick was counted)
+ ******************************************************************************/
+static unsigned int per_interrupt(unsigned long passes, unsigned char ticks) {
+    unsigned long stolen;
+
+    if(ticks == 0 || passes >= passes_idle) {
+        return 0;
+    }
+    stolen = (passes_idle - passes) * WINDOW_CYCLES / passes_idle;
+    return (unsigned int)((stolen + ticks / 2) / ticks);
+}
+
+/******************************************************************************
+ * Function: main
+ * Description: Measure the loop alone, then with each tick handler
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void main(void) {
+    IRQ_PRIORITY_INIT();
+    T3CON = 0xA0;                   // RD16, 1:4, Fosc/4, off; CCPs on Timer1
+
+    timer_wheel_init();             // 1 ms tick, low priority, interrupts on
+
+    INTCONbits.GIE = 0;
+    passes_idle = window(&ticks_idle);
+    INTCONbits.GIE = 1;
+
+    passes_low = window(&ticks_low);
+
+    INTCONbits.GIE = 0;
+    IRQ_SET(TIMER1_PERIOD_IP, IRQ_HIGH);
+    INTCONbits.GIE = 1;
+    passes_fast = window(&ticks_fast);
+
+    T1CONbits.TMR1ON = 0;
+    low_cycles = per_interrupt(passes_low, ticks_low);
+    fast_cycles = per_interrupt(passes_fast, ticks_fast);
+    saved_cycles = low_cycles - fast_cycles;
+    bench_done = 1;
+
+    while(1);   // Inspect results in the Watch window
+}
+
+/******************************************************************************
+ * Build Instructions:
+ *   1. Create a new MPLAB X project for PIC18F4550 with XC8 and add this
+ *      file and Drivers/timer_wheel.c
+ *   2. Project Properties -> XC8 Compiler -> Define macros: ISR_FAST=1
+ *   3. Debugger: Simulator
+ *   4. Build and run; optionally again with TIMER1_PERIOD_CCP=0 for the
+ *      reload tick buzzer_timer.c uses with the PWM tone
+ *   5. Check the listing: ISR should end in RETFIE 1 with no MOVFF to
+ *      ??_ISR before it (Drivers/isr_fast.h, "Checking a Build")
+ ******************************************************************************/
@@ -0,0 +1,167 @@
+/******************************************************************************
+ * PIC18F4550 Melody Player with CCP1 PWM
+ * Experiment Q6 (variant): Hardware Tone Generation
+ *
+ * Author: Microcontroller Lab
+ * Target Device: PIC18F4550
+ * IDE: MPLAB X IDE
+ * Compiler: XC8
+ * Kit: Microembedded PIC18F4550 Development Kit
+ *
+ * Description:
+ *   Plays a melody on the buzzer with Drivers/tone.c. Each note's pitch
+ *   is CCP1 PWM (no CPU time) and its length is one Timer0 period, so
+ *   the whole tune costs one short interrupt per note: 30 for the tune
+ *   below, against about 20000 toggles for the same tune driven from a
+ *   timer interrupt.
+ *   - Button S1: play the melody once
+ *   - Button S2: loop the melody; press again to stop
+ *   RB0 is lit while a melody plays.
+ *
+ *   Notes are written as MELODY_NOTE(note, ms); the Timer0 reload for
+ *   each length is computed at compile time. A short rest after each
+ *   note keeps repeated notes apart.
+ *
+ * Hardware Configuration:
+ *   Buzzer:            wire RC2 (CCP1) to the buzzer input and pull the
+ *                      relay jumper (RC2 drives the relay on the kit)
+ *   Button S1 (Input): RC0, active LOW
+ *   Button S2 (Input): RC1, active LOW
+ *   LED (Output):      RB0
+ *
+ * Crystal Frequency: 8 MHz (Internal Oscillator)
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "../Drivers/system_config.h"
+#include "../Drivers/tone.h"
+
+// Configuration Bits
+#pragma config FOSC = INTOSCIO_EC   // Internal oscillator
+#pragma config WDTE = OFF           // Watchdog Timer disabled
+#pragma config PWRTE = OFF          // Power-up Timer disabled
+#pragma config BOREN = OFF          // Brown-out Reset disabled
+#pragma config PBADEN = OFF         // PORTB pins as digital I/O
+#pragma config LVP = OFF            // Low-Voltage Programming disabled
+#pragma config MCLRE = OFF          // MCLR function disabled
+
+// Pin Definitions
+#define Button1         PORTCbits.RC0
+#define Button2         PORTCbits.RC1
+#define LED             LATBbits.LATB0
+
+// Tempo: 120 beats per minute, notes detached by a short rest
+#define BEAT_MS         500
+#define REST_MS         40
+#define QUARTER(n)      MELODY_NOTE(n, BEAT_MS - REST_MS), MELODY_NOTE(NOTE_REST, REST_MS)
+#define DOTTED(n)       MELODY_NOTE(n, BEAT_MS * 3 / 2 - REST_MS), MELODY_NOTE(NOTE_REST, REST_MS)
+#define EIGHTH(n)       MELODY_NOTE(n, BEAT_MS / 2 - REST_MS), MELODY_NOTE(NOTE_REST, REST_MS)
+#define HALF(n)         MELODY_NOTE(n, BEAT_MS * 2 - REST_MS), MELODY_NOTE(NOTE_REST, REST_MS)
+
+// Ode to Joy, first phrase, one octave up from the usual C4 key
+const melody_note_t ode_to_joy[] = {
+    QUARTER(NOTE_E6), QUARTER(NOTE_E6), QUARTER(NOTE_F6), QUARTER(NOTE_G6),
+    QUARTER(NOTE_G6), QUARTER(NOTE_F6), QUARTER(NOTE_E6), QUARTER(NOTE_D6),
+    QUARTER(NOTE_C6), QUARTER(NOTE_C6), QUARTER(NOTE_D6), QUARTER(NOTE_E6),
+    DOTTED(NOTE_E6), EIGHTH(NOTE_D6), HALF(NOTE_D6)
+};
+#define MELODY_LENGTH   (sizeof(ode_to_joy) / sizeof(ode_to_joy[0]))
+
+#if BEAT_MS * 2 > TONE_MAX_MS
+#error "BEAT_MS too long for one Timer0 period"
+#endif
+
+/******************************************************************************
+ * Function: delay_ms
+ * Description: Software delay in milliseconds
+ * Parameters: ms - delay duration in milliseconds
+ * Returns: None
+ * Note: Calibrated for 8 MHz internal oscillator
+ ******************************************************************************/
+void delay_ms(unsigned int ms) {
+    unsigned int i, j;
+    for(i = 0; i < ms; i++) {
+        for(j = 0; j < 200; j++);  // Calibrated for 8 MHz
+    }
+}
+
+/******************************************************************************
+ * Function: system_init
+ * Description: Initialize oscillator and I/O ports
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void system_init(void) {
+    // Configure internal oscillator to 8 MHz
+    OSCCONbits.IRCF2 = 1;
+    OSCCONbits.IRCF1 = 1;
+    OSCCONbits.IRCF0 = 1;
+    OSCCONbits.SCS1 = 1;
+    OSCCONbits.SCS0 = 0;
+
+    // Configure Port C
+    TRISCbits.TRISC0 = 1;   // RC0 (Button S1) as input
+    TRISCbits.TRISC1 = 1;   // RC1 (Button S2) as input
+
+    // Configure Port B
+    TRISBbits.TRISB0 = 0;   // RB0 (LED) as output
+    LED = 0;
+}
+
+/******************************************************************************
+ * Function: __interrupt() high_priority ISR
+ * Description: Timer0 end-of-note interrupt for the melody player
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void __interrupt(high_priority) ISR(void) {
+    tone_isr();
+}
+
+/******************************************************************************
+ * Function: main
+ * Description: Start the melody on a button press and show when it plays
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void main(void) {
+    system_init();
+    tone_init();
+
+    while(1) {
+        if(!Button1) {
+            tone_melody_start(ode_to_joy, MELODY_LENGTH, 0);
+        } else if(!Button2) {
+            if(tone_melody_busy()) {
+                tone_melody_stop();
+            } else {
+                tone_melody_start(ode_to_joy, MELODY_LENGTH, 1);
+            }
+        }
+        while(!Button1 || !Button2);    // Wait for release
+        delay_ms(20);                   // Debounce
+
+        LED = tone_melody_busy();
+    }
+}
+
+/******************************************************************************
+ * Build Instructions:
+ *   1. Create a new MPLAB X project for PIC18F4550 with XC8
+ *   2. Add this file and Drivers/tone.c to Source Files (not
+ *      buzzer_timer.c)
+ *   3. Build and program; wire RC2 to the buzzer as above
+ *
+ * Testing Instructions:
+ *   1. Press S1: the tune plays once and RB0 goes out at the end
+ *   2. Press S2: the tune loops; press S2 again to stop it
+ *   3. Change BEAT_MS or the ode_to_joy[] table and rebuild
+ *
+ * Troubleshooting:
+ *   - Silence: the tone is on RC2, not the buzzer's own RC3 line; check
+ *     the wire and that the relay jumper is out
+ *   - Build stops with "_XTAL_FREQ too high": the note table needs the
+ *     8 MHz clock (Timer2 cannot go below 2.9 kHz at 48 MHz)
+ *   - Tune too fast or slow: _XTAL_FREQ must match the oscillator
+ ******************************************************************************/
@@ -0,0 +1,155 @@
+/******************************************************************************
+ * PIC18F4550 Tick Drift Benchmark - Timer1 Period Accuracy under Latency
+ * Experiment Q6 (variant): Checks Drivers/timer1_period.h
+ *
+ * Author: Microcontroller Lab
+ * Target Device: PIC18F4550
+ * IDE: MPLAB X IDE
+ * Compiler: XC8
+ *
+ * Description:
+ *   Runs the Timer1 period interrupt for BENCH_TICKS ticks while main
+ *   keeps disabling interrupts for pseudo-random stretches of 0-250
+ *   cycles, so every tick sees a different latency. The ISR timestamps
+ *   each entry with free-running Timer3 (Fosc/4, 1:1). The sum of the
+ *   entry-to-entry intervals is compared with BENCH_TICKS periods:
+ *
+ *     drift_cycles  measured minus expected cycles over all ticks
+ *     drift_ppm     drift_cycles per million cycles
+ *     day_seconds   drift_ppm extrapolated to 24 h: seconds the tick
+ *                   clock loses (positive) or gains (negative) per day
+ *     interval_min/max  shortest and longest entry-to-entry interval;
+ *                   the spread is entry jitter, not period error
+ *
+ *   BENCH_METHOD selects the restart:
+ *     0  timer1_period.h as configured (TIMER1_PERIOD_CCP 1 or 0)
+ *     1  the old fixed write of TMR1H:TMR1L after the latency
+ *
+ * Reading Results:
+ *   MPLAB X Simulator: run until bench_done is 1, then add drift_cycles,
+ *   drift_ppm, day_seconds, interval_min and interval_max to the Watch
+ *   window. Expect drift_cycles = 0 for CCP and for the running-count
+ *   reload. With TIMER1_PERIOD_CCP 0, a non-zero drift_cycles divided by
+ *   BENCH_TICKS is the error in TIMER1_RELOAD_LAG: subtract it from the
+ *   LAG (project define) and run again. Method 1 shows the drift the Q6
+ *   program used to have.
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "../Drivers/system_config.h"
+#include "../Drivers/timer1_period.h"
+
+// Configuration Bits
+#pragma config FOSC = INTOSCIO_EC   // Internal oscillator
+#pragma config WDTE = OFF           // Watchdog Timer disabled
+#pragma config PWRTE = OFF          // Power-up Timer disabled
+#pragma config BOREN = OFF          // Brown-out Reset disabled
+#pragma config PBADEN = OFF         // PORTB pins as digital I/O
+#pragma config LVP = OFF            // Low-Voltage Programming disabled
+#pragma config MCLRE = OFF          // MCLR function disabled
+
+#ifndef BENCH_METHOD
+#define BENCH_METHOD    0
+#endif
+
+#define BENCH_TICKS     10000U
+
+// Timer3 measures the intervals at 1:1: periods must fit in 16 bits
+#if TIMER1_PERIOD_COUNTS * TIMER1_PERIOD_PRESCALE > 65535UL
+#error "tick_drift_bench needs TIMER1_PERIOD_US below 65536 cycles"
+#endif
+
+// Expected cycles per tick
+#define BENCH_PERIOD    (TIMER1_PERIOD_COUNTS * TIMER1_PERIOD_PRESCALE)
+
+// Old reload: TMR1 = 65536 - period, written after the latency
+#define OLD_RELOAD      (65536UL - BENCH_PERIOD)
+
+#if BENCH_METHOD == 1
+#define BENCH_PENDING() (PIE1bits.TMR1IE && PIR1bits.TMR1IF)
+#define BENCH_ACK()     { TMR1H = (unsigned char)(OLD_RELOAD >> 8); TMR1L = (unsigned char)OLD_RELOAD; PIR1bits.TMR1IF = 0; }
+#else
+#define BENCH_PENDING() TIMER1_PERIOD_PENDING()
+#define BENCH_ACK()     TIMER1_PERIOD_ACK()
+#endif
+
+volatile unsigned int ticks = 0;
+volatile unsigned char bench_done = 0;
+unsigned int last_stamp;
+unsigned long total_cycles = 0;
+unsigned int interval_min = 0xFFFF;
+unsigned int interval_max = 0;
+long drift_cycles;
+long drift_ppm;
+long day_seconds;
+
+/******************************************************************************
+ * Function: __interrupt() high_priority ISR
+ * Description: Timestamp the tick and restart the period
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void __interrupt(high_priority) ISR(void) {
+    unsigned int stamp, interval;
+
+    if(BENCH_PENDING()) {
+        stamp = TMR3L;
+        stamp |= (unsigned int)TMR3H << 8;
+        BENCH_ACK();
+        if(ticks != 0) {
+            interval = stamp - last_stamp;
+            total_cycles += interval;
+            if(interval < interval_min) interval_min = interval;
+            if(interval > interval_max) interval_max = interval;
+        }
+        last_stamp = stamp;
+        if(++ticks > BENCH_TICKS) {
+            T1CONbits.TMR1ON = 0;
+            bench_done = 1;
+        }
+    }
+}
+
+/******************************************************************************
+ * Function: main
+ * Description: Run the tick under varying interrupt latency, then work
+ *              out the drift
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void main(void) {
+    unsigned int lfsr = 0xACE1;
+    unsigned char spin;
+
+    T3CON = 0x81;                   // RD16, Timer1 -> CCPx, 1:1, on
+
+#if BENCH_METHOD == 1
+    T1CON = 0x80;                   // RD16, 1:1, Fosc/4, off
+    TMR1H = (unsigned char)(OLD_RELOAD >> 8);
+    TMR1L = (unsigned char)OLD_RELOAD;
+    PIR1bits.TMR1IF = 0;
+    PIE1bits.TMR1IE = 1;
+    INTCONbits.PEIE = 1;
+    INTCONbits.GIE = 1;
+    T1CONbits.TMR1ON = 1;
+#else
+    TIMER1_PERIOD_START();
+#endif
+
+    // Critical sections of random length delay the tick interrupt
+    while(!bench_done) {
+        lfsr = (lfsr >> 1) ^ (-(lfsr & 1) & 0xB400);    // 16-bit Galois LFSR
+        spin = (unsigned char)(lfsr & 0x3F);
+        INTCONbits.GIE = 0;
+        while(spin--);                                  // ~4 cycles per pass
+        INTCONbits.GIE = 1;
+    }
+
+    // BENCH_TICKS intervals were summed (the first tick only sets the stamp)
+    drift_cycles = (long)(total_cycles - (unsigned long)BENCH_TICKS * BENCH_PERIOD);
+    drift_ppm = drift_cycles * 100L / (long)(((unsigned long)BENCH_TICKS * BENCH_PERIOD) / 10000UL);
+    day_seconds = drift_ppm * 864L / 10000L;
+
+    while(1);   // Inspect results in the Watch window
+}
@@ -0,0 +1,122 @@
+/******************************************************************************
+ * PIC18F4550 Timer Wheel Benchmark - Cycles per Tick for 1, 8 and 32 Timers
+ * Experiment Q6 (variant): Cost of Drivers/timer_wheel.c
+ *
+ * Author: Microcontroller Lab
+ * Target Device: PIC18F4550
+ * IDE: MPLAB X IDE
+ * Compiler: XC8
+ *
+ * Description:
+ *   Arms 1, 8 and then 32 periodic timers (periods 61 to 154 ticks, so
+ *   expiries are part of the mix) and drives 4096 ticks through the wheel
+ *   by hand with interrupts off. Each tick is timed in two parts with
+ *   Timer3 (Fosc/4, 1:1 -> instruction cycles):
+ *     isr_cycles - timer_wheel_isr(): the interrupt body
+ *     run_cycles - timer_wheel_run(): slot walk, expiries and callbacks
+ *   For each timer count the shortest, longest and average tick are kept,
+ *   minus the measured start/stop overhead. Entry [0] is 1 timer, [1] is
+ *   8 and [2] is 32.
+ *
+ *   isr_cycles excludes the context save/restore XC8 wraps around the
+ *   ISR; read it from the listing (Window -> Debugging -> Output ->
+ *   Disassembly Listing File) and add it once: it does not depend on the
+ *   timers either.
+ *
+ * Reading Results:
+ *   MPLAB X Simulator: run until the final while(1), then add isr_min,
+ *   isr_max, run_min, run_max and run_avg to the Watch window. Copy the
+ *   figures into the "Cost" table in Drivers/timer_wheel.h.
+ *
+ * What to Expect (from the code; this bench has not been run yet):
+ *   isr_min = isr_max, the same for all three entries. run_avg grows by
+ *   about 20 cycles per timer per 16 ticks (one visit per wheel turn),
+ *   plus the expiries; run_max is a tick where several timers expire.
+ ******************************************************************************/
+
+#define BENCH_TIMER         3           // Timer1 is the tick under test
+#include "../../Common/bench.h"
+#include "../Drivers/system_config.h"
+#include "../Drivers/timer_wheel.h"
+
+#define NUM_CONFIGS     3
+#define NUM_TICKS       4096
+
+const unsigned char bench_timers[NUM_CONFIGS] = {1, 8, 32};
+
+unsigned int bench_ticks;
+unsigned int bench_overhead;
+unsigned int isr_min[NUM_CONFIGS];
+unsigned int isr_max[NUM_CONFIGS];
+unsigned int run_min[NUM_CONFIGS];
+unsigned int run_max[NUM_CONFIGS];
+unsigned int run_avg[NUM_CONFIGS];
+unsigned int expiries[NUM_CONFIGS];
+
+static unsigned char config;
+
+/******************************************************************************
+ * Function: bench_callback
+ * Description: Timer callback: count the expiry
+ * Parameters: id - timer id (unused)
+ * Returns: None
+ ******************************************************************************/
+void bench_callback(unsigned char id) {
+    expiries[config]++;
+}
+
+/******************************************************************************
+ * Function: main
+ * Description: Time the tick interrupt and the wheel for each timer count
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void main(void) {
+    unsigned char i;
+    unsigned int tick;
+    unsigned long run_total;
+
+    BENCH_TIMER_INIT();
+    BENCH_OVERHEAD();
+
+    for(config = 0; config < NUM_CONFIGS; config++) {
+        timer_wheel_init();
+        INTCONbits.GIE = 0;         // Ticks are injected by hand below
+        T1CONbits.TMR1ON = 0;
+
+        for(i = 0; i < bench_timers[config]; i++) {
+            timer_wheel_add(i, 1 + i, 61 + 3 * i, bench_callback);
+        }
+
+        isr_min[config] = 0xFFFF;
+        isr_max[config] = 0;
+        run_min[config] = 0xFFFF;
+        run_max[config] = 0;
+        run_total = 0;
+
+        for(tick = 0; tick < NUM_TICKS; tick++) {
+#if TIMER1_PERIOD_CCP
+            PIR1bits.CCP1IF = 1;    // As if Timer1 had reached CCPR1
+#else
+            PIR1bits.TMR1IF = 1;    // As if Timer1 had overflowed
+#endif
+            BENCH_START();
+            timer_wheel_isr();
+            BENCH_STOP();
+            bench_ticks -= bench_overhead;
+            if(bench_ticks < isr_min[config]) isr_min[config] = bench_ticks;
+            if(bench_ticks > isr_max[config]) isr_max[config] = bench_ticks;
+
+            BENCH_START();
+            timer_wheel_run();
+            BENCH_STOP();
+            bench_ticks -= bench_overhead;
+            if(bench_ticks < run_min[config]) run_min[config] = bench_ticks;
+            if(bench_ticks > run_max[config]) run_max[config] = bench_ticks;
+            run_total += bench_ticks;
+        }
+        run_avg[config] = (unsigned int)(run_total / NUM_TICKS);
+    }
+
+    while(1);   // Inspect results in the Watch window
+}
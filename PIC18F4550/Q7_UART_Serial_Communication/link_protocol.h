@@ -0,0 +1,90 @@
+/******************************************************************************
+ * Q7 Binary Link Protocol - Message Types and Payload Layouts
+ * Shared by: uart_binary_link.c, Q8 adc_logger.c and adc_scope.c (board)
+ *            and Host/link_tool (PC)
+ *
+ * Frames are built by Common/frame.c: [type][seq][payload][CRC-16],
+ * COBS encoded and terminated by 0x00. Multi-byte fields are little
+ * endian. Every response starts with a status byte.
+ ******************************************************************************/
+
+#ifndef LINK_PROTOCOL_H
+#define LINK_PROTOCOL_H
+
+// Type Bits
+#define LINK_RESPONSE       0x80    // Set in replies: type = request | 0x80
+
+// Requests (host -> board), answered with the same seq
+#define MSG_PING            0x01    // Payload echoed back after the status
+#define MSG_STATUS          0x02    // Reply: see STATUS layout below
+#define MSG_LED             0x03    // Payload: [0] 0 = off, 1 = on
+#define MSG_STREAM          0x04    // Payload: frame count (u16), 0 = stop
+#define MSG_SCOPE_ARM       0x05    // adc_scope.c: see SCOPE_ARM layout
+
+// Unsolicited (board -> host), seq counts up by one per message
+#define MSG_STREAM_DATA     0x40    // STREAM_WORDS test samples (u16)
+#define MSG_ADC_BLOCK       0x41    // adc_logger.c: packed sample block
+#define MSG_ADC_STATS       0x42    // adc_logger.c: rate/drop/CPU report
+#define MSG_SCOPE_HEADER    0x43    // adc_scope.c: capture description
+#define MSG_SCOPE_DATA      0x44    // adc_scope.c: part of the capture
+
+// Response Status Byte
+#define LINK_OK             0x00
+#define LINK_ERR_TYPE       0x01    // Unknown request type
+#define LINK_ERR_LENGTH     0x02    // Payload length wrong for the type
+
+// STATUS Reply Layout (15 bytes)
+//   [0]      status
+//   [1..4]   baud rate (u32)
+//   [5..6]   SPBRGH:SPBRG (u16)
+//   [7..8]   frames received (u16)
+//   [9..10]  CRC errors (u16)
+//   [11..12] format errors (u16)
+//   [13..14] UART receive bytes dropped (u16)
+#define STATUS_REPLY_LEN    15
+
+// STREAM_DATA Payload: consecutive values of a 16-bit sample counter,
+// so the host can verify every word as well as the sequence numbers
+#define STREAM_WORDS        30
+
+// ADC_BLOCK Payload (ADC_BLOCK_LEN bytes)
+//   [0..1]   block number (u16), +1 per block; a gap = blocks dropped
+//   [2..]    ADC_BLOCK_SAMPLES 10-bit samples packed 4 per 5 bytes:
+//            [s0 bits 7-0][s1 7-0][s2 7-0][s3 7-0]
+//            [s3 9-8 | s2 9-8 | s1 9-8 | s0 9-8]   (s0 in bits 1-0)
+#define ADC_BLOCK_SAMPLES   40
+#define ADC_BLOCK_LEN       (2 + ADC_BLOCK_SAMPLES / 4 * 5)
+
+// ADC_STATS Payload (11 bytes), sent once per measurement window
+//   [0..1]   samples per second achieved in the last window (u16)
+//   [2..3]   samples missed because a conversion was still busy (u16)
+//   [4..5]   blocks dropped because the UART fell behind (u16)
+//   [6..7]   blocks sent (u16)
+//   [8]      CPU headroom in the last window (percent)
+//   [9..10]  configured sample rate (u16)
+#define ADC_STATS_LEN       11
+
+// SCOPE_ARM Request Payload (7 bytes)
+//   [0]      trigger mode (SCOPE_RISING, SCOPE_FALLING, SCOPE_LEVEL)
+//   [1..2]   trigger level, 0-1023 (u16)
+//   [3..4]   samples kept before the trigger sample (u16)
+//   [5..6]   samples kept after the trigger sample (u16)
+//   pre + 1 + post must not exceed the board's ring (512 samples)
+#define SCOPE_ARM_LEN       7
+#define SCOPE_RISING        0       // Crosses level upwards (with hysteresis)
+#define SCOPE_FALLING       1       // Crosses level downwards
+#define SCOPE_LEVEL         2       // First sample at or above level
+
+// SCOPE_HEADER Payload (10 bytes), sent before the data frames
+//   [0..1]   capture number (u16)
+//   [2..3]   sample rate in Hz (u16)
+//   [4..5]   pre-trigger samples (u16), trigger sample follows them
+//   [6..7]   post-trigger samples (u16)
+//   [8..9]   trigger sample value (u16)
+#define SCOPE_HEADER_LEN    10
+
+// SCOPE_DATA Payload: [0..1] index of the first sample in the capture
+// (u16), then up to SCOPE_CHUNK samples packed as in ADC_BLOCK
+#define SCOPE_CHUNK         48
+
+#endif
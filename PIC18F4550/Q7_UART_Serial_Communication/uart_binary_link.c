@@ -0,0 +1,263 @@
+/******************************************************************************
+ * PIC18F4550 UART Binary Link
+ * Experiment Q7 (variant): COBS-Framed Binary Protocol with CRC-16
+ *
+ * Author: Microcontroller Lab
+ * Target Device: PIC18F4550
+ * IDE: MPLAB X IDE
+ * Compiler: XC8
+ * Kit: Microembedded PIC18F4550 Development Kit
+ *
+ * Description:
+ *   Same hardware as uart_communication.c, but instead of echoed ASCII
+ *   command lines the board exchanges binary frames (Common/frame.c):
+ *   [type][seq][payload][CRC-16], COBS encoded, 0x00 delimited. Frames
+ *   can carry any byte value, nothing is echoed, and a corrupted frame
+ *   is rejected by its CRC instead of being executed.
+ *
+ *   Request/response: PING, STATUS, LED and STREAM requests are answered
+ *   with the same sequence number (link_protocol.h).
+ *   Streaming: after STREAM n the board sends n unsolicited STREAM_DATA
+ *   frames back to back, each with 30 16-bit samples (60 bytes).
+ *
+ *   Everything is non-blocking: bytes move through the interrupt-driven
+ *   UART rings, and the main loop only encodes a new frame once the
+ *   previous one is fully queued (Drivers/frame_link.c). Receive has the
+ *   high-priority vector to itself, so a STREAM burst going out never
+ *   delays an incoming request (Drivers/irq_priority.h).
+ *
+ * Hardware Configuration:
+ *   UART TX:            RC6 (to USB-Serial adapter RX)
+ *   UART RX:            RC7 (to USB-Serial adapter TX)
+ *   Status LED:         RB0
+ *
+ * UART Configuration:
+ *   8-N-1 at UART_BAUD (Drivers/system_config.h, default 9600)
+ *
+ * Crystal Frequency: 8 MHz (Internal Oscillator)
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "../../Common/frame.h"
+#include "../Drivers/uart_driver.h"
+#include "../Drivers/uart_baud.h"
+#include "../Drivers/frame_link.h"
+#include "../Drivers/irq_priority.h"
+#include "link_protocol.h"
+
+// Configuration Bits
+#pragma config FOSC = INTOSCIO_EC   // Internal oscillator
+#pragma config WDTE = OFF           // Watchdog Timer disabled
+#pragma config PWRTE = OFF          // Power-up Timer disabled
+#pragma config BOREN = OFF          // Brown-out Reset disabled
+#pragma config PBADEN = OFF         // PORTB pins as digital I/O
+#pragma config LVP = OFF            // Low-Voltage Programming disabled
+#pragma config MCLRE = OFF          // MCLR function disabled
+
+unsigned char reply[FRAME_MAX_PAYLOAD];     // Response being built
+unsigned char stream_data[STREAM_WORDS * 2];
+unsigned int stream_left = 0;               // STREAM_DATA frames still to send
+unsigned int stream_sample = 0;             // Next test sample value
+unsigned char stream_seq = 0;               // Sequence of unsolicited frames
+
+/******************************************************************************
+ * Function: put_u16 / put_u32
+ * Description: Store a value little endian
+ * Parameters: buf - destination, value - value to store
+ * Returns: None
+ ******************************************************************************/
+void put_u16(unsigned char *buf, unsigned int value) {
+    buf[0] = (unsigned char)value;
+    buf[1] = (unsigned char)(value >> 8);
+}
+
+void put_u32(unsigned char *buf, unsigned long value) {
+    put_u16(buf, (unsigned int)value);
+    put_u16(buf + 2, (unsigned int)(value >> 16));
+}
+
+/******************************************************************************
+ * Function: handle_request
+ * Description: Execute the request in link_rx and queue the response.
+ *              Only called when the link is idle, so link_send() always
+ *              accepts the reply.
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void handle_request(void) {
+    unsigned char len = 1;
+    unsigned char i;
+    uart_rx_stats_t stats;
+
+    reply[0] = LINK_OK;
+
+    switch(link_rx.type) {
+        case MSG_PING:
+            if(link_rx.length > FRAME_MAX_PAYLOAD - 1) {
+                reply[0] = LINK_ERR_LENGTH;
+                break;
+            }
+            for(i = 0; i < link_rx.length; i++) {
+                reply[1 + i] = link_rx.payload[i];
+            }
+            len += link_rx.length;
+            break;
+
+        case MSG_STATUS:
+            uart_get_rx_stats(&stats);
+            put_u32(&reply[1], uart_get_baud());
+            put_u16(&reply[5], uart_get_brg());
+            put_u16(&reply[7], link_stats.frames_rx);
+            put_u16(&reply[9], link_stats.crc_errors);
+            put_u16(&reply[11], link_stats.format_errors);
+            put_u16(&reply[13], stats.dropped);
+            len = STATUS_REPLY_LEN;
+            break;
+
+        case MSG_LED:
+            if(link_rx.length != 1) {
+                reply[0] = LINK_ERR_LENGTH;
+                break;
+            }
+            LATBbits.LATB0 = (link_rx.payload[0] != 0);
+            break;
+
+        case MSG_STREAM:
+            if(link_rx.length != 2) {
+                reply[0] = LINK_ERR_LENGTH;
+                break;
+            }
+            stream_left = link_rx.payload[0] | ((unsigned int)link_rx.payload[1] << 8);
+            break;
+
+        default:
+            reply[0] = LINK_ERR_TYPE;
+            break;
+    }
+
+    link_send(link_rx.type | LINK_RESPONSE, link_rx.seq, reply, len);
+}
+
+/******************************************************************************
+ * Function: send_stream_frame
+ * Description: Queue the next STREAM_DATA frame
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void send_stream_frame(void) {
+    unsigned char i;
+
+    for(i = 0; i < STREAM_WORDS * 2; i += 2) {
+        put_u16(&stream_data[i], stream_sample++);
+    }
+    if(link_send(MSG_STREAM_DATA, stream_seq, stream_data, STREAM_WORDS * 2)) {
+        stream_seq++;
+        stream_left--;
+    }
+}
+
+/******************************************************************************
+ * Function: isr_low
+ * Description: Low-priority interrupt service routine for UART transmit
+ *              (Drivers/irq_priority.h)
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void IRQ_LOW_HANDLER isr_low(void) {
+    uart_tx_isr();
+}
+
+/******************************************************************************
+ * Function: __interrupt() high_priority ISR
+ * Description: High-priority interrupt service routine for UART receive
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void __interrupt(high_priority) ISR(void) {
+    uart_rx_isr();
+    IRQ_CALL_LOW(isr_low);
+}
+
+/******************************************************************************
+ * Function: system_init
+ * Description: Initialize oscillator and I/O ports
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void system_init(void) {
+    // Configure internal oscillator to 8 MHz
+    OSCCONbits.IRCF2 = 1;
+    OSCCONbits.IRCF1 = 1;
+    OSCCONbits.IRCF0 = 1;
+    OSCCONbits.SCS1 = 1;
+    OSCCONbits.SCS0 = 0;
+
+    // Configure Port B for LED
+    TRISBbits.TRISB0 = 0;   // RB0 as output
+    LATBbits.LATB0 = 0;     // Initialize LED OFF
+}
+
+/******************************************************************************
+ * Function: main
+ * Description: Serve requests; stream data frames while the link is idle
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void main(void) {
+    system_init();
+    IRQ_PRIORITY_INIT();
+    IRQ_SET(IPR1bits.RCIP, IRQ_HIGH);   // RX high, TX low
+    uart_init();
+    link_init();
+
+    while(1) {
+        // Requests first, so a STREAM 0 (stop) is seen between data frames
+        if(!link_tx_busy()) {
+            if(link_receive() == FRAME_OK) {
+                handle_request();
+            } else if(stream_left) {
+                send_stream_frame();
+            }
+        }
+    }
+}
+
+/******************************************************************************
+ * Build Instructions:
+ *   1. Create a new MPLAB X project for PIC18F4550 with XC8
+ *   2. Add this file, Drivers/uart_driver.c, Drivers/frame_link.c and
+ *      Common/frame.c to Source Files (not uart_communication.c - each
+ *      program has its own main)
+ *   3. Add link_protocol.h, Common/frame.h and the Drivers headers to
+ *      Header Files, then build and program as for Q7
+ *
+ * Testing Instructions (host side, see Host/link_tool/README.md):
+ *   1. Connect the USB-Serial adapter as for Q7
+ *   2. link_cli /dev/ttyUSB0 ping          -> "PING ok, rtt ..."
+ *   3. link_cli /dev/ttyUSB0 led 1         -> RB0 LED on
+ *   4. link_cli /dev/ttyUSB0 status        -> baud, SPBRG, error counters
+ *   5. link_cli /dev/ttyUSB0 stream 200    -> payload throughput report
+ *   Without hardware, run link_sim (a pty stand-in of this program) and
+ *   point link_cli at the device name it prints.
+ *
+ * Throughput (8-N-1, 10 bit times per byte; 960 bytes/s at 9600):
+ *   Binary STREAM_DATA frame: 60 payload + type + seq + 2 CRC + COBS
+ *   code + delimiter = 66 bytes on the wire -> 91% payload, about
+ *   870 payload bytes/s (435 samples/s) at 9600 baud.
+ *   The same samples in the ASCII protocol style ("12345\r\n") take 3 to
+ *   7 bytes each for 2 bytes of information: about 6.9 bytes per sample
+ *   for full-range 16-bit values against 2.2 in binary, i.e. 3x fewer
+ *   samples per second (2 to 3x for the small values of the test
+ *   counter). Commands also cost twice their length in ASCII because of
+ *   the echo.
+ *   link_cli stream measures the binary figure and prints the ASCII
+ *   equivalent of exactly the samples it received.
+ *
+ * Troubleshooting:
+ *   - link_cli times out: check wiring and that UART_BAUD matches --baud
+ *   - STATUS shows CRC errors: noise or wrong baud rate on the line
+ *   - Stream reports lost frames or bad samples: the PC or adapter lost
+ *     bytes (CRC/format errors are then counted too); lower the baud
+ *     rate to confirm
+ ******************************************************************************/
@@ -1,70 +1,151 @@
-#include <xc.h>  // Include device-specific header file for PIC microcontrollers
+/******************************************************************************
+ * PIC18F4550 UART Serial Communication
+ * Experiment Q7: Bidirectional Serial Link with Command Processing
+ *
+ * Author: Microcontroller Lab
+ * Date: November 6, 2025
+ * Target Device: PIC18F4550
+ * IDE: MPLAB X IDE
+ * Compiler: XC8
+ * Kit: Microembedded PIC18F4550 Development Kit
+ *
+ * Description:
+ *   This program communicates with a PC terminal over the on-chip EUSART.
+ *   Received characters are echoed back and fed one at a time to the
+ *   streaming command parser (Common/cmd_parser.c), which narrows the
+ *   sorted command table with every letter and collects numeric
+ *   arguments as they arrive. When Enter is pressed the command is
+ *   already known and its handler runs at once: LED n, LED_ON, LED_OFF,
+ *   STATUS, TXBENCH or RXSTATS. Commands are not case sensitive.
+ *
+ *   Both directions are interrupt driven (Drivers/uart_driver.c): the
+ *   receive ISR stores bytes in a ring that main drains with uart_read(),
+ *   and text to send is queued in a second ring that the TXIF interrupt
+ *   feeds to TXREG. A new line arriving while a command runs waits in
+ *   the receive ring instead of overwriting the previous one.
+ *   Receive is the only high-priority interrupt (Drivers/irq_priority.h):
+ *   TX and the profiler timebase run on the low vector and never delay
+ *   a received byte. IRQ_PRIORITY=0 goes back to a single vector.
+ *   The high vector returns with RETFIE FAST; with ISR_FAST=1 (project
+ *   define, Drivers/isr_fast.h) the driver's ring indices and receive
+ *   statistics move to the access bank, so the RX handler does not
+ *   select a bank for them. Its only software save left is FSR0 for
+ *   the ring store.
+ *
+ *   ISR statistics (ISR_STATS=1 as a project define, Drivers/isr_stats.c):
+ *   the RX and TX handlers are timed with Timer3 and the ISRSTATS
+ *   command prints their run counts and execution times in cycles;
+ *   ISRSTATS 0 starts the counts again. With ISR_STATS 0 (default) the
+ *   instrumentation and the command are not built.
+ *
+ *   Section profiling (PROFILE=1 as a project define, Common/profile.c):
+ *   each command (from the line ending to the end of its handler) and
+ *   every uart_send_string() call are timed with Timer3; PROFILE prints
+ *   count and average/min/max/self cycles per section, PROFILE 0 clears
+ *   them.
+ *
+ * Hardware Configuration:
+ *   UART TX:            RC6 (to USB-Serial adapter RX)
+ *   UART RX:            RC7 (to USB-Serial adapter TX)
+ *   Status LED:         RB0
+ *
+ * UART Configuration:
+ *   Mode: Asynchronous, 8 data bits, no parity, 1 stop bit
+ *   Baud Rate: UART_BAUD in Drivers/system_config.h (default 9600).
+ *   BRG16/BRGH/SPBRG are chosen at compile time by Drivers/uart_baud.h;
+ *   STATUS reports the exact rate and the baud generator value.
+ *   Auto-baud (USE_AUTOBAUD = 1): after reset the board waits up to
+ *   AUTOBAUD_TIMEOUT_MS for the host to send 'U' characters, measures
+ *   the rate with the EUSART auto-baud hardware and uses it from then
+ *   on. Without a sync it continues at UART_BAUD.
+ *
+ * Crystal Frequency: 8 MHz (Internal Oscillator)
+ ******************************************************************************/
 
-#define _XTAL_FREQ 48000000  // Define system clock frequency (for delay macros if needed)
+#include <xc.h>
+#include <pic18f4550.h>
+#include "../../Common/numfmt.h"
+#include "../../Common/cmd_parser.h"
+#include "../Drivers/uart_driver.h"
+#include "../Drivers/uart_baud.h"
+#include "../Drivers/isr_stats.h"
+#include "../Drivers/irq_priority.h"
+#include "../Drivers/isr_fast.h"
 
-/**
- * Function to transmit a single byte via UART
- */
-void Txbyte(char data) {
-    while(TXSTAbits.TRMT == 0);  // Wait until the transmit shift register is empty
-    TXREG = data;                // Load the data byte into the transmit register
-}
+// Profiled Sections (Common/profile.h)
+#define PROFILE_SECTIONS(X)                 \
+    X(PROF_COMMAND,   "command")            \
+    X(PROF_SEND,      "uart_send_string")
+#include "../../Common/profile.h"
 
-void main(void) {
-    unsigned char i = 0;
-    
-    // Strings to send via UART
-    const char string[] = "\n\r Press any key\n\r";
-    const char string1[] = "\n\r UART Tested \n\r";
-    
-    // -------------- UART Pin Configuration ---------------
-    TRISB = 0x00;  // Set PORTB as output (used for displaying received data)
-    TRISC = 0x80;  // Set RC7 (RX) as input, RC6 (TX) as output
-    
-    // -------------- UART Initialization ------------------
-    TXSTA = 0x20;  // 8-bit transmission, transmitter enabled, asynchronous mode
-    RCSTA = 0x90;  // Serial port enabled, continuous reception, 8-bit reception
-    SPBRG = 0x19;  // Baud rate = 9600 (for 48 MHz clock: SPBRG = (Fosc/(64*Baud))-1)
-    
-    // Send initial message via UART
-    for(i = 0; string[i] != '\0'; i++) {
-        Txbyte(string[i]);
-    }
-    
-    while(1) {
-        // Check if data is received
-        if(RCSTAbits.FERR == 1) {
-            // Framing error occurred, read and discard RCREG
-            i = RCREG;
-        }
-        else if(PIR1bits.RCIF == 1) {
-            // Data received successfully
-            i = RCREG;         // Read received data
-            PORTB = i;         // Display on PORTB
-            Txbyte(i);         // Echo back the received data
-            
-            // Send confirmation message
-            for(i = 0; string1[i] != '\0'; i++) {
-                Txbyte(string1[i]);
-            }
-        }
+// Configuration Bits
+#pragma config FOSC = INTOSCIO_EC   // Internal oscillator
+#pragma config WDTE = OFF           // Watchdog Timer disabled
+#pragma config PWRTE = OFF          // Power-up Timer disabled
+#pragma config BOREN = OFF          // Brown-out Reset disabled
+#pragma config PBADEN = OFF         // PORTB pins as digital I/O
+#pragma config LVP = OFF            // Low-Voltage Programming disabled
+#pragma config MCLRE = OFF          // MCLR function disabled
+
+// Auto-Baud Startup (1 = lock onto the host rate from 'U' sync characters)
+#define USE_AUTOBAUD            0
+#define AUTOBAUD_TIMEOUT_MS     10000
+
+// ISR Statistics Sources (Drivers/isr_stats.h)
+#define SRC_RX                  0
+#define SRC_TX                  1
+
+PROFILE_TABLE();
+
+// Command Line Buffer
+#define BUFFER_SIZE 32
+
+// TXBENCH: bytes queued before the timed window (multiple of 16, fits
+// the TX ring)
+#define TX_BENCH_BYTES          48
+#if TX_BENCH_BYTES > UART_TX_SIZE - 1
+#error "TX_BENCH_BYTES must fit the TX ring (UART_TX_SIZE - 1)"
+#endif
+
+char cmd_line[BUFFER_SIZE];                 // Copy of the line for messages
+unsigned char cmd_len = 0;                  // Characters in cmd_line
+
+/******************************************************************************
+ * Function: delay_ms
+ * Description: Software delay in milliseconds
+ * Parameters: ms - delay duration
+ * Returns: None
+ ******************************************************************************/
+void delay_ms(unsigned int ms) {
+    unsigned int i, j;
+    for(i = 0; i < ms; i++) {
+        for(j = 0; j < 200; j++);  // Calibrated for 8 MHz
     }
 }
 
-// REMOVED OLD VERBOSE FUNCTIONS
-    TXREG = data;           // Load data into transmit register
+/******************************************************************************
+ * Function: uart_send_byte
+ * Description: Queue a single byte, waiting only while the TX ring is full
+ * Parameters: data - byte to transmit
+ * Returns: None
+ ******************************************************************************/
+void uart_send_byte(char data) {
+    while(uart_write(&data, 1) == 0);
 }
 
 /******************************************************************************
  * Function: uart_send_string
- * Description: Transmit a null-terminated string via UART
+ * Description: Transmit a null-terminated string via UART; returns as
+ *              soon as the last byte is queued
  * Parameters: str - pointer to string
  * Returns: None
  ******************************************************************************/
 void uart_send_string(const char *str) {
+    PROFILE_BEGIN(PROF_SEND);
     while(*str) {
-        uart_send_byte(*str++);
+        str += uart_write_string(str);  // Queue as much as fits, retry rest
     }
+    PROFILE_END(PROF_SEND);
 }
 
 /******************************************************************************
@@ -72,93 +153,265 @@ void uart_send_string(const char *str) {
  * Description: Transmit an integer as ASCII string
  * Parameters: num - integer to transmit
  * Returns: None
+ * Note: Uses the shared double-dabble formatter (Common/numfmt.c), so no
+ *       software division runs per digit
  ******************************************************************************/
 void uart_send_number(unsigned int num) {
-    char buffer[10];
-    unsigned char i = 0;
-    
-    // Convert number to string
-    if(num == 0) {
-        uart_send_byte('0');
-        return;
-    }
-    
-    while(num > 0) {
-        buffer[i++] = (num % 10) + '0';
-        num /= 10;
+    char buffer[6];
+
+    fmt_u16(buffer, num, 0, ' ');
+    uart_send_string(buffer);
+}
+
+/******************************************************************************
+ * Function: tx_benchmark
+ * Description: Measure how much CPU time is left while the UART streams.
+ *              The same idle loop is counted for the same Timer1 window
+ *              twice: once with the line quiet, and once right after
+ *              TX_BENCH_BYTES were queued, while the TXIF interrupt
+ *              drains them. Queueing happens before the window opens
+ *              and the window closes before the ring runs dry, so the
+ *              only difference between the passes is the transmit
+ *              interrupt. The ratio of loop counts is the CPU share left.
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void tx_benchmark(void) {
+    static const char pattern[] = "0123456789ABCDEF";
+    unsigned long idle[2], window;
+    unsigned char pass, copies;
+    char number[11];
+
+    // Instruction cycles the ring lasts, less 2 bytes the hardware holds
+    // and 2 for margin; Timer1 counts at most 65535 of them
+    window = (TX_BENCH_BYTES - 4) * (10UL * _XTAL_FREQ / 4) / uart_get_baud();
+    if(window > 65535UL) {
+        window = 65535UL;
     }
-    
-    // Send digits in reverse order
-    while(i > 0) {
-        uart_send_byte(buffer[--i]);
+
+    uart_flush();
+    T1CON = 0x80;                       // 16-bit, 1:1 prescale, Fosc/4, off
+
+    for(pass = 0; pass < 2; pass++) {
+        if(pass == 1) {                 // The ring is empty after uart_flush
+            for(copies = 0; copies < TX_BENCH_BYTES / 16; copies++) {
+                uart_write(pattern, 16);
+            }
+        }
+        idle[pass] = 0;
+        TMR1H = (unsigned char)((65536UL - window) >> 8);
+        TMR1L = (unsigned char)(65536UL - window);  // Writes TMR1H too (RD16)
+        PIR1bits.TMR1IF = 0;
+        T1CONbits.TMR1ON = 1;
+        while(!PIR1bits.TMR1IF) {
+            idle[pass]++;
+        }
+        T1CONbits.TMR1ON = 0;
     }
+
+    uart_flush();
+    uart_send_string("\r\nTX bench: ");
+    fmt_u32(number, window, 0, ' ');
+    uart_send_string(number);
+    uart_send_string(" cycles, ");
+    fmt_u32(number, idle[1], 0, ' ');
+    uart_send_string(number);
+    uart_send_string("/");
+    fmt_u32(number, idle[0], 0, ' ');
+    uart_send_string(number);
+    uart_send_string(" loops, CPU free ");
+    fmt_u32(number, (idle[1] * 100) / idle[0], 0, ' ');
+    uart_send_string(number);
+    uart_send_string("%\r\n");
 }
 
 /******************************************************************************
- * Function: process_command
- * Description: Process received serial commands
- * Parameters: cmd - command string
+ * Function: report_rx_stats
+ * Description: Print the receive ring statistics
+ * Parameters: None
  * Returns: None
  ******************************************************************************/
-void process_command(char *cmd) {
-    // Example commands
-    if(strcmp(cmd, "LED_ON") == 0) {
-        LATBbits.LATB0 = 1;
-        uart_send_string("LED turned ON\r\n");
-    }
-    else if(strcmp(cmd, "LED_OFF") == 0) {
-        LATBbits.LATB0 = 0;
-        uart_send_string("LED turned OFF\r\n");
+void report_rx_stats(void) {
+    uart_rx_stats_t stats;
+    char number[11];
+
+    uart_get_rx_stats(&stats);
+
+    uart_send_string("RX bytes:    ");
+    fmt_u32(number, stats.bytes, 0, ' ');
+    uart_send_string(number);
+    uart_send_string("\r\nOverruns:    ");
+    uart_send_number(stats.overruns);
+    uart_send_string("\r\nFraming err: ");
+    uart_send_number(stats.framing);
+    uart_send_string("\r\nDropped:     ");
+    uart_send_number(stats.dropped);
+    uart_send_string("\r\nHigh water:  ");
+    uart_send_number(stats.high_water);
+    uart_send_string("/");
+    uart_send_number(UART_RX_SIZE - 1);
+    uart_send_string("\r\n");
+}
+
+/******************************************************************************
+ * Command Handlers
+ * Called by the parser as soon as the line ending arrives. argv holds
+ * the numeric arguments that followed the command name.
+ ******************************************************************************/
+#if ISR_STATS
+void cmd_isrstats(unsigned char argc, const int *argv) {
+    if(argc == 1 && argv[0] == 0) {
+        ISR_STATS_RESET(SRC_RX, PIE1bits.RCIE);
+        ISR_STATS_RESET(SRC_TX, PIE1bits.TXIE);
+        uart_send_string("ISR statistics cleared\r\n");
+        return;
     }
-    else if(strcmp(cmd, "STATUS") == 0) {
-        uart_send_string("System: OK\r\n");
-        uart_send_string("Device: PIC18F4550\r\n");
+    isr_stats_report(SRC_RX, "RX");
+    isr_stats_report(SRC_TX, "TX");
+}
+#endif
+
+void cmd_led(unsigned char argc, const int *argv) {
+    if(argc != 1) {
+        uart_send_string("Usage: LED 0|1\r\n");
+        return;
     }
-    else {
-        uart_send_string("Unknown command: ");
-        uart_send_string(cmd);
-        uart_send_string("\r\n");
+    LATBbits.LATB0 = (argv[0] != 0);
+    uart_send_string(argv[0] ? "LED turned ON\r\n" : "LED turned OFF\r\n");
+}
+
+void cmd_led_off(unsigned char argc, const int *argv) {
+    LATBbits.LATB0 = 0;
+    uart_send_string("LED turned OFF\r\n");
+}
+
+void cmd_led_on(unsigned char argc, const int *argv) {
+    LATBbits.LATB0 = 1;
+    uart_send_string("LED turned ON\r\n");
+}
+
+#if PROFILE
+void cmd_profile(unsigned char argc, const int *argv) {
+    if(argc == 1 && argv[0] == 0) {
+        profile_reset();
+        uart_send_string("Profile cleared\r\n");
+        return;
     }
+    profile_report(uart_send_string);
+}
+#endif
+
+void cmd_rxstats(unsigned char argc, const int *argv) {
+    report_rx_stats();
+}
+
+void cmd_status(unsigned char argc, const int *argv) {
+    char number[11];
+
+    uart_send_string("System: OK\r\n");
+    uart_send_string("Device: PIC18F4550\r\n");
+    uart_send_string("Baud: ");
+    fmt_u32(number, uart_get_baud(), 0, ' ');
+    uart_send_string(number);
+    uart_send_string(" (SPBRG 0x");
+    fmt_hex16(number, uart_get_brg());
+    uart_send_string(number);
+    uart_send_string(")\r\n");
+}
+
+void cmd_txbench(unsigned char argc, const int *argv) {
+    tx_benchmark();
+}
+
+// Command Table (program memory) - must stay sorted by name
+const cmd_entry_t commands[] = {
+#if ISR_STATS
+    {"ISRSTATS", cmd_isrstats},
+#endif
+    {"LED",     cmd_led},
+    {"LED_OFF", cmd_led_off},
+    {"LED_ON",  cmd_led_on},
+#if PROFILE
+    {"PROFILE", cmd_profile},
+#endif
+    {"RXSTATS", cmd_rxstats},
+    {"STATUS",  cmd_status},
+    {"TXBENCH", cmd_txbench}
+};
+#define NUM_COMMANDS    (sizeof(commands) / sizeof(commands[0]))
+
+cmd_parser_t parser;
+
+/******************************************************************************
+ * Function: isr_low
+ * Description: Low-priority interrupt service routine: transmit ring and
+ *              profiler timebase (Drivers/irq_priority.h; a plain
+ *              function called from ISR when IRQ_PRIORITY is 0)
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void IRQ_LOW_HANDLER isr_low(void) {
+    // Feed the next queued byte to TXREG
+    ISR_STATS_ENTER(SRC_TX, PIE1bits.TXIE && PIR1bits.TXIF, ISR_LATENCY_NONE);
+    uart_tx_isr();
+    ISR_STATS_EXIT(SRC_TX);
+
+#if PROFILE
+    // Timer3 overflows extend the profiler timestamps
+    profile_isr();
+#endif
 }
 
 /******************************************************************************
  * Function: __interrupt() high_priority ISR
- * Description: High-priority interrupt service routine for UART receive
+ * Description: High-priority interrupt service routine for UART receive,
+ *              so a byte is never held up by the transmit side
  * Parameters: None
  * Returns: None
  ******************************************************************************/
 void __interrupt(high_priority) ISR(void) {
-    // Check if UART receive interrupt occurred
-    if(PIR1bits.RCIF) {
-        char received_byte = RCREG;     // Read received data
-        
-        // Echo back received character
-        uart_send_byte(received_byte);
-        
-        // Store in buffer if not full
-        if(rx_index < (BUFFER_SIZE - 1)) {
-            // Check for command terminator (Enter key)
-            if(received_byte == '\r' || received_byte == '\n') {
-                rx_buffer[rx_index] = '\0';  // Null-terminate string
-                data_received = 1;           // Set flag
-                rx_index = 0;                // Reset index
-            } else {
-                rx_buffer[rx_index++] = received_byte;
-            }
-        } else {
-            // Buffer overflow, reset
-            rx_index = 0;
-        }
-        
-        // Clear interrupt flag
-        PIR1bits.RCIF = 0;
-        
-        // Check for overrun error
-        if(RCSTAbits.OERR) {
-            RCSTAbits.CREN = 0;     // Clear overrun by disabling receiver
-            RCSTAbits.CREN = 1;     // Re-enable receiver
+    // Store received bytes in the receive ring
+    ISR_STATS_ENTER(SRC_RX, PIE1bits.RCIE && PIR1bits.RCIF, ISR_LATENCY_NONE);
+    uart_rx_isr();
+    ISR_STATS_EXIT(SRC_RX);
+
+    IRQ_CALL_LOW(isr_low);
+}
+
+/******************************************************************************
+ * Function: receive_char
+ * Description: Echo one received character and pass it to the command
+ *              parser. A copy of the line is kept only so an unknown
+ *              command can be repeated back; the parser does not need it.
+ * Parameters: c - received character
+ * Returns: CMD_PENDING while the line is incomplete (and for the empty
+ *          lines of CR/LF pairs), otherwise the parser result
+ ******************************************************************************/
+unsigned char receive_char(char c) {
+    unsigned char result;
+
+    // Check for command terminator (Enter key)
+    if(c == '\r' || c == '\n') {
+        if(cmd_len == 0) {
+            cmd_parser_feed(&parser, c);
+            return CMD_PENDING;         // Ignore empty lines and CR/LF pairs
         }
+        cmd_line[cmd_len] = '\0';       // Null-terminate string
+        cmd_len = 0;
+        PROFILE_BEGIN(PROF_COMMAND);
+        uart_send_string("\r\n");      // Handler output starts on a new line
+        result = cmd_parser_feed(&parser, c);
+        PROFILE_END(PROF_COMMAND);
+        return result;
     }
+
+    uart_send_byte(c);                  // Echo back received character
+
+    // Keep a copy for error messages (truncated if the line is long)
+    if(cmd_len < (BUFFER_SIZE - 1)) {
+        cmd_line[cmd_len++] = c;
+    }
+    return cmd_parser_feed(&parser, c);
 }
 
 /******************************************************************************
@@ -174,7 +427,7 @@ void system_init(void) {
     OSCCONbits.IRCF0 = 1;
     OSCCONbits.SCS1 = 1;
     OSCCONbits.SCS0 = 0;
-    
+
     // Configure Port B for LED (optional)
     TRISBbits.TRISB0 = 0;   // RB0 as output
     LATBbits.LATB0 = 0;     // Initialize LED OFF
@@ -189,10 +442,36 @@ void system_init(void) {
 void main(void) {
     // Initialize system
     system_init();
-    
+
+    // RX on the high vector, everything else on the low one
+    IRQ_PRIORITY_INIT();
+    IRQ_SET(IPR1bits.RCIP, IRQ_HIGH);
+
+#if ISR_STATS
+    // Timer3 timestamps for the RX/TX handlers
+    isr_stats_init();
+#endif
+#if PROFILE
+    // Timer3 timestamps for the profiled sections (enabled by uart_init)
+    profile_init();
+#endif
+
     // Initialize UART
     uart_init();
-    
+
+    // Initialize command parser
+    cmd_parser_init(&parser, commands, NUM_COMMANDS);
+
+#if USE_AUTOBAUD
+    // Wait for the host to send "UUU..." and adopt its baud rate
+    if(uart_autobaud(AUTOBAUD_TIMEOUT_MS)) {
+        uart_send_string("\r\nAuto-baud locked, SPBRG = ");
+    } else {
+        uart_send_string("\r\nAuto-baud timeout, default SPBRG = ");
+    }
+    uart_send_number(uart_get_brg());
+#endif
+
     // Send startup message
     delay_ms(100);
     uart_send_string("\r\n=============================\r\n");
@@ -200,36 +479,119 @@ void main(void) {
     uart_send_string("Microcontroller Lab Experiment\r\n");
     uart_send_string("=============================\r\n");
     uart_send_string("Commands:\r\n");
+    uart_send_string("  LED n   - LED off (0) or on (1)\r\n");
     uart_send_string("  LED_ON  - Turn on LED\r\n");
     uart_send_string("  LED_OFF - Turn off LED\r\n");
     uart_send_string("  STATUS  - Check system status\r\n");
+    uart_send_string("  TXBENCH - Measure CPU free during TX\r\n");
+    uart_send_string("  RXSTATS - Show receive statistics\r\n");
+#if ISR_STATS
+    uart_send_string("  ISRSTATS [0] - ISR times (0 clears)\r\n");
+#endif
+#if PROFILE
+    uart_send_string("  PROFILE [0]  - Section cycles (0 clears)\r\n");
+#endif
     uart_send_string("=============================\r\n\r\n");
     uart_send_string("Enter command: ");
-    
+
     // Main loop
     while(1) {
-        // Check if command received
-        if(data_received) {
-            data_received = 0;
-            
-            // Send newline for formatting
-            uart_send_string("\r\n");
-            
-            // Process command
-            process_command((char *)rx_buffer);
-            
+        unsigned char c, result;
+
+#if ISR_STATS
+        isr_stats_poll();       // Fold in the handlers' last runs
+#endif
+        // Parse each character as it arrives; handlers run at the line end
+        if(!uart_read(&c)) {
+            continue;
+        }
+        result = receive_char(c);
+        if(result != CMD_PENDING) {
+            if(result == CMD_UNKNOWN) {
+                uart_send_string("Unknown command: ");
+                uart_send_string(cmd_line);
+                uart_send_string("\r\n");
+            } else if(result == CMD_BAD_ARGS) {
+                uart_send_string("Bad arguments: ");
+                uart_send_string(cmd_line);
+                uart_send_string("\r\n");
+            }
+
             // Prompt for next command
             uart_send_string("\r\nEnter command: ");
         }
     }
 }
 
+/******************************************************************************
+ * Alternative Version: Minimal Polled UART (no interrupts)
+ ******************************************************************************/
+#if 0  // Set to 1 (and the main program above to 0) to use this version
+
+/**
+ * Function to transmit a single byte via UART
+ */
+void Txbyte(char data) {
+    while(TXSTAbits.TRMT == 0);  // Wait until the transmit shift register is empty
+    TXREG = data;                // Load the data byte into the transmit register
+}
+
+void main(void) {
+    unsigned char i = 0;
+
+    // Strings to send via UART
+    const char string[] = "\n\r Press any key\n\r";
+    const char string1[] = "\n\r UART Tested \n\r";
+
+    // -------------- UART Pin Configuration ---------------
+    TRISB = 0x00;  // Set PORTB as output (used for displaying received data)
+    TRISC = 0x80;  // Set RC7 (RX) as input, RC6 (TX) as output
+
+    // -------------- UART Initialization ------------------
+    TXSTA = 0x20;  // 8-bit transmission, transmitter enabled, asynchronous mode
+    RCSTA = 0x90;  // Serial port enabled, continuous reception, 8-bit reception
+    SPBRG = 0x19;  // Baud rate = 9600 (for 48 MHz clock: SPBRG = (Fosc/(64*Baud))-1)
+
+    // Send initial message via UART
+    for(i = 0; string[i] != '\0'; i++) {
+        Txbyte(string[i]);
+    }
+
+    while(1) {
+        // Check if data is received
+        if(RCSTAbits.FERR == 1) {
+            // Framing error occurred, read and discard RCREG
+            i = RCREG;
+        }
+        else if(PIR1bits.RCIF == 1) {
+            // Data received successfully
+            i = RCREG;         // Read received data
+            PORTB = i;         // Display on PORTB
+            Txbyte(i);         // Echo back the received data
+
+            // Send confirmation message
+            for(i = 0; string1[i] != '\0'; i++) {
+                Txbyte(string1[i]);
+            }
+        }
+    }
+}
+
+#endif
+
 /******************************************************************************
  * Build Instructions:
  *   1. Open MPLAB X IDE
  *   2. Create new project for PIC18F4550
  *   3. Select XC8 compiler
- *   4. Add this C file to Source Files
+ *   4. Add this C file, Drivers/uart_driver.c, Common/numfmt.c and
+ *      Common/cmd_parser.c to Source Files, and the Drivers headers,
+ *      numfmt.h and cmd_parser.h to Header Files
+ *      For ISR statistics also add Drivers/isr_stats.c and define
+ *      ISR_STATS=1 (Project Properties -> XC8 -> Define macros); for
+ *      section profiling add Common/profile.c and define PROFILE=1;
+ *      ISR_FAST=1 puts the RX handler's state in the access bank (not
+ *      together with ISR_STATS)
  *   5. Build project: Production → Build Main Project
  *   6. Program using PICkit programmer
  *
@@ -239,19 +601,83 @@ void main(void) {
  *      - Adapter RX --> PIC RC6 (TX)
  *      - Adapter GND --> PIC GND
  *   2. Open terminal software (PuTTY/Tera Term)
- *   3. Configure: 9600 baud, 8-N-1
+ *   3. Configure: 9600 baud (or UART_BAUD), 8-N-1
  *   4. Power on PIC - should see startup message
  *   5. Type commands and press Enter
  *
  * Expected Output:
  *   - Startup message displays on terminal
  *   - Characters typed are echoed back
- *   - Commands execute (LED_ON, LED_OFF, STATUS)
+ *   - Commands execute (LED_ON, LED_OFF, LED 1, STATUS), in any case
+ *   - "LED x" prints "Bad arguments: LED x"
  *   - Responses sent back to PC
+ *   - TXBENCH prints e.g. "TX bench: <n> bytes queued, CPU free <p>%"
+ *
+ * RX Burst Test (zero loss at full line rate):
+ *   Hardware: in Tera Term use File -> Send file with a text file of a
+ *   few KB (no CR/LF inside, or lines shorter than 31 characters), then
+ *   type RXSTATS. "RX bytes" must equal the file size (plus the command
+ *   itself) with Overruns, Framing err and Dropped all 0.
+ *   MPLAB X simulator: Window -> Simulator -> Stimulus -> Register
+ *   Injection, target RCREG, trigger on demand, from a text file; run
+ *   and then check the same counters (watch rx_stats) after the burst.
+ *   High water shows how close the ring came to filling up.
+ *
+ * Auto-Baud Test (USE_AUTOBAUD = 1):
+ *   1. Set Tera Term to any rate the clock supports (e.g. 19200, 57600,
+ *      250000 at 8 MHz), reset the board and type U a few times.
+ *   2. The board answers "Auto-baud locked, SPBRG = n" and the banner.
+ *      Expected n is about Fosc / (4 x baud) - 1, e.g. 207 at 9600 and
+ *      34 at 57600 with the 8 MHz clock.
+ *   3. STATUS shows the rate implied by the measured SPBRG.
+ *   At very high rates the measurement has only a few counts, so check
+ *   STATUS; if the reported rate is off by one count, lower the rate.
+ *
+ * ISR Statistics Test (ISR_STATS=1):
+ *   Type a few commands, then ISRSTATS. Expect lines like
+ *     RX n=42 missed 0 exec 30..38 avg 33 cyc
+ *     TX n=1510 missed 0 exec 35..44 avg 37 cyc
+ *   (illustrative, not measured). With missed 0, exec x n against the
+ *   elapsed time is the share of the CPU the UART takes. missed counts
+ *   runs while main was busy elsewhere (e.g. waiting on a full transmit
+ *   ring), so the figures are a sample of the runs. RX and TX report no latency: the EUSART does
+ *   not record when a byte arrived. In the simulator, read stats[] in
+ *   the Watch window instead.
+ *
+ * Command Parser Notes:
+ *   The old process_command() waited for Enter and then ran strcmp()
+ *   against each name in turn, so the last command in the chain cost
+ *   the most and every new command made all misses slower. The parser
+ *   now does a little work per received character (well inside one
+ *   character time at any supported baud rate) and the line ending
+ *   costs the same for every command. Common/cmd_parser_bench.c times
+ *   both methods with a 52-command table.
+ *   To add a command: write a handler, then insert it into commands[]
+ *   in sorted (ASCII) order - "LED" < "LED_OFF" < "LED_ON" because a
+ *   shorter prefix sorts first and '_' < letters. An unsorted entry
+ *   is simply never found; cmd_table_check() points at it.
+ *
+ * TX Benchmark Notes:
+ *   With blocking transmit the CPU would be 0% free for the whole
+ *   transfer. With the ring, the only cost per byte is one TXIF
+ *   interrupt (context save + a few instructions) plus the copy into the
+ *   ring. TXBENCH counts the interrupt only: the copy is done before its
+ *   window, which lasts TX_BENCH_BYTES - 4 character times (at most
+ *   65535 cycles) so the ring never runs dry inside it. It prints the
+ *   window, the loop counts with and without traffic and their ratio.
+ *   No figures from the kit are recorded here yet. Free CPU therefore rises with clock speed relative to baud rate:
+ *   one character at 115200 baud lasts 174 instruction cycles at 8 MHz
+ *   and 1042 at 48 MHz, so expect a clearly higher figure at 48 MHz.
  *
  * Troubleshooting:
  *   - No output: Check TX/RX connections (swap if needed)
- *   - Garbage characters: Verify baud rate (9600)
+ *   - Garbage characters: Verify baud rate (9600) and that _XTAL_FREQ in
+ *     system_config.h matches the oscillator set up in system_init()
+ *   - Build error "UART_BAUD cannot be generated": pick a rate from the
+ *     table in Drivers/uart_baud.h that suits _XTAL_FREQ
  *   - No echo: Check receive interrupt configuration
- *   - Commands not working: Check strcmp() and string termination
+ *   - Commands not working: Check that commands[] is still sorted
+ *     (cmd_table_check returns NUM_COMMANDS when it is)
+ *   - RXSTATS shows Dropped > 0: main was busy longer than the ring
+ *     lasts (UART_RX_SIZE character times); enlarge UART_RX_SIZE
  ******************************************************************************/
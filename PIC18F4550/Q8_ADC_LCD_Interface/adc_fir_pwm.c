@@ -0,0 +1,324 @@
+/******************************************************************************
+ * PIC18F4550 Signal Conditioner - ADC -> FIR Filter -> PWM Output
+ * Experiment Q8 (variant): Real-Time Sample-In, Process, Sample-Out Loop
+ *
+ * Author: Microcontroller Lab
+ * Target Device: PIC18F4550
+ * IDE: MPLAB X IDE
+ * Compiler: XC8
+ * Kit: Microembedded PIC18F4550 Development Kit
+ *
+ * Description:
+ *   Turns the board into a low-pass signal conditioner. Every sample
+ *   goes through the same fixed path with no main-loop involvement:
+ *
+ *   1. CCP2 special event trigger (Timer3 reset + GO) starts a
+ *      conversion of AN0 every FIR_PERIOD instruction cycles.
+ *   2. The ADC interrupt stores the result in the filter history and
+ *      computes an FIR_TAPS tap FIR filter. Coefficients are const, so
+ *      XC8 keeps them in program memory; each multiply-accumulate uses
+ *      four 8x8 MULWF hardware multiplies.
+ *   3. The filtered value is written to the CCP1 10-bit PWM duty. The
+ *      PWM module latches the new duty at the start of its next period,
+ *      so the output steps at a fixed time after each sample.
+ *
+ *   The ISR also checks its own timing: it keeps the longest trigger-to-
+ *   duty-update time (latency_max) and counts samples whose processing
+ *   ran into the next trigger (overruns, RB0 lights on the first).
+ *   main() is left free for other work.
+ *
+ * Filter:
+ *   Windowed-sinc low pass (Hamming window), cutoff 0.1 * sample rate
+ *   (100 Hz at the default 1 kHz), gain 1 at DC. Coefficients are Q15
+ *   and sum to 32768; replace fir_coefs[] for other responses (any
+ *   values from -32767 to 32767 keep the sums within 32 bits).
+ *
+ * Hardware Configuration:
+ *   ADC Input:          AN0 (RA0) - signal, 0-5 V
+ *   PWM Output:         RC2 (CCP1) - 7.8 kHz, 10-bit duty. Follow it
+ *                       with an RC low pass (e.g. 10 k + 100 nF, or a
+ *                       2nd order stage) to get the analog signal back.
+ *                       The kit's relay driver is also on RC2: pull its
+ *                       jumper, or expect it to buzz.
+ *   Overrun LED:        RB0
+ *
+ * Maximum Sample Rate (estimates until measured, see below):
+ *   Per sample: conversion (ADC_CONVERSION_CYCLES, 30 at 8 MHz) +
+ *   interrupt entry/exit ~70 cycles +
+ *   ~50 cycles per tap (4 MULWF, 32-bit add, sign test, loop) + output
+ *   ~30 cycles. All of it must end before the next trigger.
+ *
+ *   Taps   Cycles   Max rate @ 8 MHz    Max rate @ 48 MHz
+ *     8     ~530       3.7 kHz             16 kHz
+ *    16     ~930       2.1 kHz             10 kHz
+ *    32    ~1730       1.1 kHz             6.2 kHz
+ *   (48 MHz: 12 MIPS, ADC at Fosc/64 with 2 TAD acquisition, 208 cycles)
+ *
+ *   The build stops with an #error if FIR_SAMPLE_RATE exceeds the
+ *   estimate for FIR_TAPS. latency_max gives the real figure: the
+ *   largest usable rate is about Fcyc / (latency_max + 20).
+ *
+ * Crystal Frequency: 8 MHz (Internal Oscillator)
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "../Drivers/system_config.h"
+#include "../Drivers/adc_config.h"
+
+// Configuration Bits
+#pragma config FOSC = INTOSCIO_EC   // Internal oscillator
+#pragma config WDTE = OFF           // Watchdog Timer disabled
+#pragma config PWRTE = OFF          // Power-up Timer disabled
+#pragma config BOREN = OFF          // Brown-out Reset disabled
+#pragma config PBADEN = OFF         // PORTB pins as digital I/O
+#pragma config LVP = OFF            // Low-Voltage Programming disabled
+#pragma config MCLRE = OFF          // MCLR function disabled
+
+// Pipeline Settings
+#define FIR_TAPS            16      // 8, 16 or 32 (coefficient sets below)
+#define FIR_SAMPLE_RATE     1000UL  // Samples per second
+#define FIR_PERIOD          ((unsigned int)((_XTAL_FREQ / 4) / FIR_SAMPLE_RATE))
+
+// Cycle estimates per sample (see Maximum Sample Rate above)
+#define FIR_CYCLES_FIXED    (ADC_CONVERSION_CYCLES + 100)   // + interrupt, output
+#define FIR_CYCLES_TAP      50
+
+#if (_XTAL_FREQ / 4) / FIR_SAMPLE_RATE < FIR_CYCLES_FIXED + FIR_TAPS * FIR_CYCLES_TAP
+#error "FIR_SAMPLE_RATE too high for FIR_TAPS at this clock"
+#endif
+#if (_XTAL_FREQ / 4) / FIR_SAMPLE_RATE > 65536
+#error "FIR_SAMPLE_RATE too low for Timer3 without prescaler"
+#endif
+
+// PWM: Timer2, PR2 = 255 -> 10-bit duty at Fosc / 1024
+#define PWM_PR2             255
+
+// Overrun LED
+#define LED_OVERRUN         LATBbits.LATB0
+
+// 8x8 -> 16 bit multiply; XC8 compiles this to a single MULWF
+#define MUL8X8(a, b)        ((unsigned int)(unsigned char)(a) * (unsigned char)(b))
+
+// Q15 coefficients, low pass at 0.1 * sample rate, sum = 32768
+#if FIR_TAPS == 8
+const int fir_coefs[FIR_TAPS] = {
+    287, 1571, 5375, 9151, 9151, 5375, 1571, 287
+};
+#elif FIR_TAPS == 16
+const int fir_coefs[FIR_TAPS] = {
+    -114, -159, -139, 291, 1450, 3284, 5246, 6525,
+    6525, 5246, 3284, 1450, 291, -139, -159, -114
+};
+#elif FIR_TAPS == 32
+const int fir_coefs[FIR_TAPS] = {
+    -17, 20, 73, 135, 164, 91, -129, -466,
+    -783, -850, -435, 588, 2141, 3927, 5501, 6424,
+    6424, 5501, 3927, 2141, 588, -435, -850, -783,
+    -466, -129, 91, 164, 135, 73, 20, -17
+};
+#else
+#error "FIR_TAPS must be 8, 16 or 32 (or add a coefficient set)"
+#endif
+
+// Sample History: every sample is stored twice, FIR_TAPS apart, so the
+// newest FIR_TAPS samples are always contiguous from history[fir_pos]
+unsigned int history[2 * FIR_TAPS];
+unsigned char fir_pos = 0;
+
+// Timing (written by the ISR)
+volatile unsigned int latency_max = 0;      // Trigger to duty update, cycles
+volatile unsigned int overruns = 0;
+volatile unsigned long samples = 0;
+volatile unsigned int last_output = 0;
+
+/******************************************************************************
+ * Function: fir_sample
+ * Description: Store the new sample and compute one FIR output. Positive
+ *              and negative products go to separate unsigned sums, so
+ *              each product is a plain 15 x 10 bit unsigned multiply.
+ * Parameters: x - new 10-bit sample
+ * Returns: Filtered 10-bit value, clamped to 0-1023
+ ******************************************************************************/
+unsigned int fir_sample(unsigned int x) {
+    const int *c = fir_coefs;
+    unsigned int *h;
+    unsigned long sum_pos = 0, sum_neg = 0, product;
+    unsigned int coef, s;
+    unsigned char k, negative;
+    long y;
+
+    fir_pos = (fir_pos == 0) ? FIR_TAPS - 1 : fir_pos - 1;
+    history[fir_pos] = x;
+    history[fir_pos + FIR_TAPS] = x;
+    h = &history[fir_pos];                  // h[k] = x[n - k]
+
+    for(k = 0; k < FIR_TAPS; k++) {
+        coef = (unsigned int)*c++;
+        s = *h++;
+        negative = (unsigned char)(coef >> 15);
+        if(negative) {
+            coef = -coef;                   // Magnitude of a negative tap
+        }
+        // coef (15 bit) * s (10 bit): the s high byte is 0-3
+        product  = MUL8X8(coef, s);
+        product += (unsigned long)(MUL8X8(coef >> 8, s) + MUL8X8(coef, s >> 8)) << 8;
+        product += (unsigned long)MUL8X8(coef >> 8, s >> 8) << 16;
+        if(negative) {
+            sum_neg += product;
+        } else {
+            sum_pos += product;
+        }
+    }
+
+    y = (long)(sum_pos - sum_neg) + 0x4000;     // Round, then Q15 -> integer
+    if(y < 0) {
+        return 0;
+    }
+    y >>= 15;
+    return (y > 1023) ? 1023 : (unsigned int)y;
+}
+
+/******************************************************************************
+ * Function: __interrupt() high_priority ISR
+ * Description: ADC done: filter, update the PWM duty and record how long
+ *              after the trigger the output was ready (Timer3 was reset
+ *              by the trigger, so TMR3 is that time directly)
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void __interrupt(high_priority) ISR(void) {
+    unsigned int y, t;
+
+    if(PIE1bits.ADIE && PIR1bits.ADIF) {
+        PIR1bits.ADIF = 0;
+
+        y = fir_sample(((unsigned int)ADRESH << 8) | ADRESL);
+        CCPR1L = (unsigned char)(y >> 2);
+        CCP1CON = 0x0C | (unsigned char)((y & 0x03) << 4);
+
+        t = TMR3L;
+        t |= (unsigned int)TMR3H << 8;
+        // A normal pass ends after the conversion time; a smaller TMR3
+        // means it has already been reset by the next trigger
+        if(PIR1bits.ADIF || t < ADC_CONVERSION_CYCLES) {
+            overruns++;                     // Next sample already taken
+            LED_OVERRUN = 1;
+        } else if(t > latency_max) {
+            latency_max = t;
+        }
+        last_output = y;
+        samples++;
+    }
+}
+
+/******************************************************************************
+ * Function: pwm_init
+ * Description: CCP1 PWM on RC2, 10-bit resolution, mid-scale duty
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void pwm_init(void) {
+    TRISCbits.TRISC2 = 0;       // RC2 (CCP1) as output
+    PR2 = PWM_PR2;
+    CCPR1L = 0x80;              // 512 / 1024
+    CCP1CON = 0x0C;             // PWM mode, DC1B = 0
+    TMR2 = 0;
+    T2CON = 0x04;               // Prescale 1:1, postscale 1:1, on
+}
+
+/******************************************************************************
+ * Function: pipeline_start
+ * Description: ADC on AN0 triggered by CCP2 on Timer3, ADC interrupt on
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void pipeline_start(void) {
+    TRISAbits.TRISA0 = 1;       // RA0 as input
+    ADCON1 = 0x0E;              // AN0 analog, VREF = VDD/VSS
+    ADCON2 = ADC_ADCON2_RIGHT;  // Right justified, timing from adc_config.h
+    ADCON0 = 0x01;              // Channel AN0, ADC on
+
+    T3CON = 0x88;               // RD16, Timer3 -> CCP2, 1:1, off
+    TMR3H = 0;
+    TMR3L = 0;
+    CCPR2H = (unsigned char)((FIR_PERIOD - 1) >> 8);
+    CCPR2L = (unsigned char)(FIR_PERIOD - 1);
+    CCP2CON = 0x0B;             // Compare, special event trigger
+
+    PIR1bits.ADIF = 0;
+    PIE1bits.ADIE = 1;
+    INTCONbits.PEIE = 1;
+    INTCONbits.GIE = 1;
+    T3CONbits.TMR3ON = 1;
+}
+
+/******************************************************************************
+ * Function: system_init
+ * Description: Initialize oscillator and the overrun LED
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void system_init(void) {
+    // Configure internal oscillator to 8 MHz
+    OSCCONbits.IRCF2 = 1;
+    OSCCONbits.IRCF1 = 1;
+    OSCCONbits.IRCF0 = 1;
+    OSCCONbits.SCS1 = 1;
+    OSCCONbits.SCS0 = 0;
+
+    TRISBbits.TRISB0 = 0;       // RB0 as output
+    LED_OVERRUN = 0;
+}
+
+/******************************************************************************
+ * Function: main
+ * Description: Start the pipeline; everything else happens in the ISR
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void main(void) {
+    system_init();
+    pwm_init();
+    pipeline_start();
+
+    while(1) {
+        // Free for other work: the pipeline never waits for main
+    }
+}
+
+/******************************************************************************
+ * Build Instructions:
+ *   1. Create a new MPLAB X project for PIC18F4550 with XC8
+ *   2. Add this file to Source Files (not adc_lcd.c)
+ *   3. Set FIR_TAPS and FIR_SAMPLE_RATE above, build and program
+ *
+ * Verifying the Timing in the MPLAB X Simulator:
+ *   1. Debug -> Debug Main Project with the Simulator as tool
+ *   2. Window -> Simulator -> Stimulus: on the "Register Injection" tab
+ *      inject ADRESL from a file of test values (a sine, or a step)
+ *   3. Run for about 0.5 s of simulated time, pause, and add
+ *      latency_max, overruns, samples and last_output to the Watches
+ *   4. overruns must be 0. The shortest usable period is about
+ *      latency_max + 20 cycles (the trigger must not come before the
+ *      ISR has returned); compare with the table above and adjust
+ *      FIR_CYCLES_TAP if the estimate is off
+ *   5. Stopwatch with breakpoints on fir_sample() entry and return
+ *      gives the filter alone; the difference per extra tap is the
+ *      cost per tap
+ *
+ * Testing on the Kit:
+ *   1. Wire an RC low pass from RC2 to the scope (see above)
+ *   2. Turn the potentiometer on AN0: the RC output follows smoothly
+ *      with the filter delay of (FIR_TAPS - 1) / 2 samples
+ *   3. With a signal generator (0-5 V, offset 2.5 V): 50 Hz passes
+ *      almost unchanged at 1 kHz sampling, 250 Hz and above is strongly
+ *      attenuated (above 500 Hz it aliases: add an analog anti-alias
+ *      filter in front of AN0 for real use)
+ *
+ * Troubleshooting:
+ *   - RB0 lights: processing did not finish within one period; lower
+ *     FIR_SAMPLE_RATE or FIR_TAPS, or run at 48 MHz
+ *   - Output stuck at one level: check that RC2 is not driven by the
+ *     relay circuit and that AN0 moves
+ ******************************************************************************/
@@ -0,0 +1,398 @@
+/******************************************************************************
+ * PIC18F4550 ADC Sample Timing Benchmark
+ * Experiment Q8 (variant): Busy-Wait Sampling vs CCP2 Triggered Sampling
+ *
+ * Author: Microcontroller Lab
+ * Target Device: PIC18F4550
+ * IDE: MPLAB X IDE
+ * Compiler: XC8
+ * Kit: Microembedded PIC18F4550 Development Kit
+ *
+ * Description:
+ *   adc_lcd.c reads the ADC with adc_read(): set GO, spin until it
+ *   clears. The moment a sample is taken then depends on when the main
+ *   loop gets round to it. This program measures how much that moment
+ *   wanders, and compares it with Drivers/adc_sampler.c, where the CCP2
+ *   special event trigger starts each conversion in hardware.
+ *
+ *   Both runs take JITTER_SAMPLES samples of AN0 at JITTER_RATE under
+ *   the same load: the UART transmitter is kept busy (one TX interrupt
+ *   per byte) and every ADC_SAMPLER_BLOCK samples a block is processed
+ *   (sum, minimum, maximum), which takes longer than one sample period.
+ *
+ *   1. Busy-wait: main polls free-running Timer1 for the next deadline
+ *      (a fixed schedule, so there is no drift), then sets GO and spins.
+ *      This is the best a polled loop can do; a __delay_us() paced loop
+ *      would also drift with the processing time.
+ *   2. CCP2 trigger: adc_sampler.c takes the samples, main consumes
+ *      whole blocks when they are ready.
+ *
+ *   Each sample is timestamped with Timer1 (1 count = 1 instruction
+ *   cycle) and the spread of the intervals between consecutive samples
+ *   is reported:
+ *     - Busy-wait: Timer1 is read right after GO is set.
+ *     - CCP2: the trigger resets Timer3, so in the ADIF interrupt
+ *       TMR1 - TMR3 is the Timer1 time of the trigger itself (the two
+ *       reads are a fixed number of cycles apart, which cancels out in
+ *       the interval). TMR3 on its own is the time from the trigger to
+ *       the read: the conversion (ADC_CONVERSION_CYCLES, acquisition
+ *       included) plus the interrupt latency and context save. It is
+ *       reported as well: it varies, the sample instants do not.
+ *
+ * Hardware Configuration:
+ *   ADC Input:          AN0 (RA0) - potentiometer wiper
+ *   UART TX:            RC6 (to USB-Serial adapter RX)
+ *   UART RX:            RC7 (to USB-Serial adapter TX)
+ *
+ * Example Output (9600 baud terminal; estimates, not measured on the kit):
+ *   ADC sample period, 1024 samples of 500 cycles
+ *   Busy-wait: min 496 max 812 jitter 316
+ *   CCP2:      min 500 max 500 jitter 0
+ *   Trigger to ADIF 70-135 cycles, blocks 32, overruns 0
+ *   (the dots printed before each report are the background load)
+ *
+ * Crystal Frequency: 8 MHz (Internal Oscillator)
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "../../Common/numfmt.h"
+#include "../Drivers/system_config.h"
+#include "../Drivers/uart_driver.h"
+#include "../Drivers/adc_sampler.h"
+
+// Configuration Bits
+#pragma config FOSC = INTOSCIO_EC   // Internal oscillator
+#pragma config WDTE = OFF           // Watchdog Timer disabled
+#pragma config PWRTE = OFF          // Power-up Timer disabled
+#pragma config BOREN = OFF          // Brown-out Reset disabled
+#pragma config PBADEN = OFF         // PORTB pins as digital I/O
+#pragma config LVP = OFF            // Low-Voltage Programming disabled
+#pragma config MCLRE = OFF          // MCLR function disabled
+
+// Benchmark Settings
+#define JITTER_RATE         4000UL  // Samples per second
+#define JITTER_SAMPLES      1024    // Per run, a multiple of ADC_SAMPLER_BLOCK
+#define JITTER_PERIOD       ((unsigned int)((_XTAL_FREQ / 4) / JITTER_RATE))
+
+#if (_XTAL_FREQ / 4) / JITTER_RATE < ADC_SAMPLER_MIN_PERIOD
+#error "JITTER_RATE too high for this clock"
+#endif
+
+typedef struct {
+    unsigned int last;              // Timestamp of the previous sample
+    unsigned int min, max;          // Interval range in instruction cycles
+    unsigned int count;             // Samples seen
+} jitter_t;
+
+// Busy-wait run (main only)
+jitter_t busy_jitter;
+unsigned int busy_block[ADC_SAMPLER_BLOCK];
+
+// CCP2 run (written by the ISR)
+volatile jitter_t ccp_jitter;
+volatile unsigned int latency_min, latency_max;
+
+// Block processing result, kept so the work is not optimised away
+volatile unsigned long block_result;
+
+/******************************************************************************
+ * Function: jitter_reset
+ * Description: Clear an interval record
+ * Parameters: j - record to clear
+ * Returns: None
+ ******************************************************************************/
+void jitter_reset(volatile jitter_t *j) {
+    j->last = 0;
+    j->min = 0xFFFF;
+    j->max = 0;
+    j->count = 0;
+}
+
+/******************************************************************************
+ * Function: busy_stamp
+ * Description: Record one busy-wait sample time (main loop only)
+ * Parameters: now - Timer1 time of the sample
+ * Returns: None
+ ******************************************************************************/
+void busy_stamp(unsigned int now) {
+    unsigned int interval = now - busy_jitter.last;
+
+    if(busy_jitter.count) {
+        if(interval < busy_jitter.min) busy_jitter.min = interval;
+        if(interval > busy_jitter.max) busy_jitter.max = interval;
+    }
+    busy_jitter.last = now;
+    busy_jitter.count++;
+}
+
+/******************************************************************************
+ * Function: trigger_stamp
+ * Description: Record the time of the CCP2 trigger behind the conversion
+ *              that just finished (interrupt only). Low bytes are read
+ *              first; RD16 latches the matching high byte.
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void trigger_stamp(void) {
+    unsigned int t1, t3, interval;
+
+    t1 = TMR1L;
+    t1 |= (unsigned int)TMR1H << 8;
+    t3 = TMR3L;
+    t3 |= (unsigned int)TMR3H << 8;
+
+    if(t3 < latency_min) latency_min = t3;
+    if(t3 > latency_max) latency_max = t3;
+
+    t1 -= t3;                           // Timer1 time of the trigger
+    interval = t1 - ccp_jitter.last;
+    if(ccp_jitter.count) {
+        if(interval < ccp_jitter.min) ccp_jitter.min = interval;
+        if(interval > ccp_jitter.max) ccp_jitter.max = interval;
+    }
+    ccp_jitter.last = t1;
+    ccp_jitter.count++;
+}
+
+/******************************************************************************
+ * Function: __interrupt() high_priority ISR
+ * Description: ADC result and UART service
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void __interrupt(high_priority) ISR(void) {
+    if(PIE1bits.ADIE && PIR1bits.ADIF) {
+        trigger_stamp();
+        adc_sampler_isr();
+    }
+    uart_rx_isr();
+    uart_tx_isr();
+}
+
+/******************************************************************************
+ * Function: timer1_read
+ * Description: Read free-running Timer1 (main loop only)
+ * Parameters: None
+ * Returns: Timer1 count
+ ******************************************************************************/
+unsigned int timer1_read(void) {
+    unsigned char low = TMR1L;          // Latches TMR1H (RD16)
+
+    return ((unsigned int)TMR1H << 8) | low;
+}
+
+/******************************************************************************
+ * Function: background_load
+ * Description: Keep the UART transmitter busy so TX interrupts land at
+ *              arbitrary points of the sample schedule
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void background_load(void) {
+    static const char pattern[] = "................";
+
+    if(uart_tx_free() >= sizeof(pattern) - 1) {
+        uart_write(pattern, sizeof(pattern) - 1);
+    }
+}
+
+/******************************************************************************
+ * Function: process_block
+ * Description: Stand-in for the application's per-block work
+ * Parameters: samples - ADC_SAMPLER_BLOCK results
+ * Returns: None
+ ******************************************************************************/
+void process_block(const unsigned int *samples) {
+    unsigned long sum = 0;
+    unsigned int lo = 0xFFFF, hi = 0, s;
+    unsigned char i;
+
+    for(i = 0; i < ADC_SAMPLER_BLOCK; i++) {
+        s = samples[i];
+        sum += s;
+        if(s < lo) lo = s;
+        if(s > hi) hi = s;
+    }
+    block_result = sum + ((unsigned long)(hi - lo) << 16);
+}
+
+/******************************************************************************
+ * Function: run_busy_wait
+ * Description: Sample with GO/spin on a Timer1 deadline schedule
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void run_busy_wait(void) {
+    unsigned int deadline, n;
+    unsigned char pos = 0;
+
+    jitter_reset(&busy_jitter);
+    deadline = timer1_read() + JITTER_PERIOD;
+
+    for(n = 0; n < JITTER_SAMPLES; n++) {
+        while((int)(timer1_read() - deadline) < 0) {
+            background_load();
+        }
+        ADCON0bits.GO = 1;
+        busy_stamp(timer1_read());
+        while(ADCON0bits.GO);
+        deadline += JITTER_PERIOD;
+
+        busy_block[pos] = ((unsigned int)ADRESH << 8) | ADRESL;
+        if(++pos == ADC_SAMPLER_BLOCK) {
+            pos = 0;
+            process_block(busy_block);
+        }
+    }
+}
+
+/******************************************************************************
+ * Function: run_triggered
+ * Description: Sample with the CCP2 trigger; main only handles blocks
+ * Parameters: None
+ * Returns: Blocks processed
+ ******************************************************************************/
+unsigned int run_triggered(void) {
+    const unsigned int *block;
+    unsigned int blocks = 0;
+
+    jitter_reset(&ccp_jitter);
+    latency_min = 0xFFFF;
+    latency_max = 0;
+
+    adc_sampler_start(JITTER_PERIOD);
+    while(blocks < JITTER_SAMPLES / ADC_SAMPLER_BLOCK) {
+        background_load();
+        block = adc_sampler_get_block();
+        if(block) {
+            process_block(block);
+            adc_sampler_release_block();
+            blocks++;
+        }
+    }
+    adc_sampler_stop();
+    return blocks;
+}
+
+/******************************************************************************
+ * Function: print_number
+ * Description: Queue a label followed by an unsigned number
+ * Parameters: label - text before the number, value - number to print
+ * Returns: None
+ ******************************************************************************/
+void print_number(const char *label, unsigned int value) {
+    char number[6];
+
+    while(*label) {
+        label += uart_write_string(label);
+    }
+    fmt_u16(number, value, 0, ' ');
+    uart_write_string(number);          // Ring is flushed before each line
+}
+
+/******************************************************************************
+ * Function: print_jitter
+ * Description: Print one result line
+ * Parameters: name - run name, min/max - interval range in cycles
+ * Returns: None
+ ******************************************************************************/
+void print_jitter(const char *name, unsigned int min, unsigned int max) {
+    uart_flush();
+    uart_write_string(name);
+    print_number(" min ", min);
+    print_number(" max ", max);
+    print_number(" jitter ", max - min);
+    uart_write_string("\r\n");
+}
+
+/******************************************************************************
+ * Function: system_init
+ * Description: Initialize oscillator and pins
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void system_init(void) {
+    // Configure internal oscillator to 8 MHz
+    OSCCONbits.IRCF2 = 1;
+    OSCCONbits.IRCF1 = 1;
+    OSCCONbits.IRCF0 = 1;
+    OSCCONbits.SCS1 = 1;
+    OSCCONbits.SCS0 = 0;
+
+    TRISAbits.TRISA0 = 1;       // RA0 (AN0) as input
+}
+
+/******************************************************************************
+ * Function: main
+ * Description: Run both measurements and print them, once a second
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void main(void) {
+    unsigned int blocks;
+
+    system_init();
+    uart_init();
+    if(!adc_sampler_init(0)) {
+        uart_write_string("ADC channel not available\r\n");
+        while(1);
+    }
+    T1CON = 0x81;               // RD16, 1:1, Fosc/4, on: timestamp clock
+
+    while(1) {
+        run_busy_wait();
+        blocks = run_triggered();
+
+        uart_flush();
+        print_number("\r\nADC sample period, ", JITTER_SAMPLES);
+        print_number(" samples of ", JITTER_PERIOD);
+        uart_write_string(" cycles\r\n");
+        print_jitter("Busy-wait:", busy_jitter.min, busy_jitter.max);
+        print_jitter("CCP2:     ", ccp_jitter.min, ccp_jitter.max);
+        uart_flush();
+        print_number("Trigger to ADIF ", latency_min);
+        print_number("-", latency_max);
+        print_number(" cycles, blocks ", blocks);
+        print_number(", overruns ", adc_sampler_overruns());
+        uart_write_string("\r\n");
+
+        uart_flush();
+        __delay_ms(1000);
+    }
+}
+
+/******************************************************************************
+ * Build Instructions:
+ *   1. Create a new MPLAB X project for PIC18F4550 with XC8
+ *   2. Add this file, Drivers/adc_sampler.c, Drivers/uart_driver.c and
+ *      Common/numfmt.c to Source Files (not adc_lcd.c)
+ *   3. Build and program; open Tera Term at UART_BAUD (9600 default)
+ *
+ * Using the Sampler in Other Programs:
+ *   if(adc_sampler_init(channel)) adc_sampler_start(period_cycles);
+ *   call adc_sampler_isr() from the ISR, then in the main loop:
+ *     if((block = adc_sampler_get_block()) != 0) {
+ *         ... use block[0 .. ADC_SAMPLER_BLOCK-1] ...
+ *         adc_sampler_release_block();
+ *     }
+ *
+ * What to Expect (estimates, 8 MHz, not yet measured on the kit):
+ *   - CCP2: min = max = JITTER_PERIOD, jitter 0, whatever the load. A
+ *     jitter of 0 with min = JITTER_PERIOD + 1 or - 1 would show that
+ *     the special event period differs from CCPR2 + 1 on this silicon;
+ *     adjust adc_sampler_start() if so.
+ *   - Busy-wait: a few cycles from the polling loop, up to about 80
+ *     when a TX interrupt lands on the deadline, and several hundred
+ *     once per block, when process_block() overruns the sample period
+ *     and the next sample is late (the one after it comes early).
+ *   - Trigger to ADIF: about 30 cycles of conversion at 8 MHz plus
+ *     40-100 of latency, which varies by the length of the UART ISR;
+ *     with adc_sampler it only has to stay below one period.
+ *   - Overruns stay 0; they count blocks main did not release in time.
+ *
+ * Troubleshooting:
+ *   - No output: check UART_BAUD in Drivers/system_config.h
+ *   - CCP2 line shows wildly varying numbers: another module is using
+ *     Timer3 or CCP2, or T3CON was changed after adc_sampler_start()
+ ******************************************************************************/
@@ -13,6 +13,12 @@
  *   This program reads analog voltage (0-5V) from AN0 (RA0) using internal
  *   10-bit ADC and displays both analog voltage and digital value on 16x2 LCD.
  *   Updates every 500ms. Uses potentiometer to vary input voltage.
+ *   With USE_BARGRAPH = 1, line 2 shows an 80-segment bar graph with
+ *   peak hold instead of the digital value (see lcd_bargraph.h).
+ *   For continuous kHz sampling to a PC use adc_logger.c instead.
+ *   With USE_FILTER = 1 the ADC is read every 50 ms between display
+ *   updates and the readings pass through an 8-sample boxcar filter
+ *   (Common/filter.h), so the last digit no longer flickers.
  *
  * Hardware Configuration:
  *   ADC Input:          AN0 (RA0) - Connect 10kΩ potentiometer
@@ -24,20 +30,58 @@
  * ADC Configuration:
  *   Resolution: 10-bit (0-1023)
  *   Reference: VSS to VDD (0V to 5V)
- *   Clock: Fosc/64
+ *   Clock: from Drivers/adc_config.h, fastest legal for _XTAL_FREQ
+ *          (Fosc/8, 4 TAD acquisition, 15 us per conversion at 8 MHz)
  *   Channel: AN0 (RA0)
  *
+ * Voltage Conversion (USE_FIXED_POINT = 1):
+ *   mV = ((ADC * gain + 4096) >> 13) + offset
+ *   Uncalibrated: gain = 40039 (5000/1023 * 2^13), offset = 0, never more
+ *   than 0.51 mV from 5000 * ADC / 1023. Integer only: one multiply
+ *   (four MULWF), one shift, one add. No float library and no printf
+ *   are linked in this mode.
+ *
+ * Two-Point Calibration (USE_CALIBRATION = 1):
+ *   Corrects the reference error (VDD is rarely exactly 5.000 V) and the
+ *   ADC offset. Hold S1 (RC0) while resetting the board, then follow the
+ *   LCD: apply CAL_LOW_MV to AN0 and press S1, apply CAL_HIGH_MV and
+ *   press S1 (S2 aborts). Each point averages 64 conversions. gain and
+ *   offset are computed once, checked for plausibility (gain within
+ *   +-20%, offset within +-250 mV) and stored in data EEPROM with a
+ *   check byte. Every later start only reads the 6 bytes back, so boot
+ *   is not slowed down; without a valid record the nominal values are
+ *   used. Hold S2 (RC1) during reset to erase the calibration.
+ *
+ * Section Profiling (PROFILE=1 as a project define, Common/profile.c):
+ *   lcd_init, display_adc, adc_read and the bar graph redraw are timed
+ *   in instruction cycles with Timer3 (adc_read and bargraph_update run
+ *   nested inside display_adc, so its self time is the text output).
+ *   Hold S1 while the display runs to page through the sections: line 1
+ *   is the name, line 2 the average and maximum cycles.
+ *
  * Display Format:
  *   Line 1: "Analog: X.XXV"
- *   Line 2: "Digital: XXXX"
+ *   Line 2: "Digital: XXXX"         (USE_BARGRAPH = 0)
+ *   Line 2: 16-cell bar graph      (USE_BARGRAPH = 1)
  *
  * Crystal Frequency: 8 MHz (Internal Oscillator)
  ******************************************************************************/
 
 #include <xc.h>
 #include <pic18f4550.h>
-#include <stdio.h>
-#include <stdlib.h>
+#include "lcd_bargraph.h"
+#include "../../Common/numfmt.h"
+#include "../../Common/filter.h"
+#include "../Drivers/adc_config.h"
+#include "../Drivers/eeprom.h"
+
+// Profiled Sections (Common/profile.h)
+#define PROFILE_SECTIONS(X)                 \
+    X(PROF_LCD_INIT,  "lcd_init")           \
+    X(PROF_DISPLAY,   "display_adc")        \
+    X(PROF_ADC_READ,  "adc_read")           \
+    X(PROF_BARGRAPH,  "bargraph_update")
+#include "../../Common/profile.h"
 
 // Configuration Bits
 #pragma config FOSC = INTOSCIO_EC   // Internal oscillator
@@ -48,6 +92,8 @@
 #pragma config LVP = OFF            // Low-Voltage Programming disabled
 #pragma config MCLRE = OFF          // MCLR function disabled
 
+PROFILE_TABLE();
+
 // LCD Pin Definitions
 #define LCD_RS      LATAbits.LATA1  // Register Select
 #define LCD_EN      LATAbits.LATA3  // Enable
@@ -59,6 +105,56 @@
 #define LCD_LINE1       0x80
 #define LCD_LINE2       0xC0
 
+// Display Mode (1 = bar graph on line 2, 0 = "Digital: XXXX")
+#define USE_BARGRAPH    1
+
+// Conversion Mode (1 = integer millivolts, 0 = original float + sprintf)
+#define USE_FIXED_POINT 1
+
+// Smoothing (1 = filtered readings, 0 = one raw conversion per update)
+#define USE_FILTER      1
+#define FILTER_TYPE     FILTER_BOXCAR   // See Common/filter.h
+#define FILTER_COEF     3               // 2^3 = 8 samples
+#define FILTER_READS    10              // Readings per 500 ms update
+
+#if USE_FILTER
+filter_t adc_filter;
+#endif
+
+// Calibration (1 = two-point gain/offset from EEPROM, needs USE_FIXED_POINT)
+#define USE_CALIBRATION 1
+#define CAL_LOW_MV      500         // Reference voltages applied during
+#define CAL_HIGH_MV     4500        // calibration (measure them with a DMM)
+#define CAL_EEPROM_ADDR 0x00        // 6-byte record in data EEPROM
+#define CAL_MAGIC       0xCA
+
+#if USE_CALIBRATION && !USE_FIXED_POINT
+#error "USE_CALIBRATION needs USE_FIXED_POINT = 1"
+#endif
+
+#if !USE_FIXED_POINT
+#include <stdio.h>
+#endif
+
+// Fixed-point scale: mV = ((ADC * gain + 2^(SHIFT-1)) >> ADC_MV_SHIFT) + offset
+#define ADC_VREF_MV     5000
+#define ADC_MV_SHIFT    13
+#define ADC_MV_GAIN     40039U      // 5000/1023 * 2^13, nominal gain
+
+// Smallest s2 - s1 (sums of 64) cal_run() accepts: half the nominal span
+#define CAL_MIN_SPAN    ((unsigned int)((unsigned long)(CAL_HIGH_MV - CAL_LOW_MV) * 1023UL * 64UL / ADC_VREF_MV / 2))
+
+// Buttons (active low, on-board pull-ups)
+#define BUTTON_S1       PORTCbits.RC0
+#define BUTTON_S2       PORTCbits.RC1
+
+// Active conversion constants (replaced by cal_load() if calibrated)
+unsigned int cal_gain = ADC_MV_GAIN;
+int cal_offset = 0;
+
+// 8x8 -> 16 bit multiply; XC8 compiles this to a single MULWF
+#define MUL8X8(a, b)    ((unsigned int)(unsigned char)(a) * (unsigned char)(b))
+
 /******************************************************************************
  * Function: delay_ms
  * Description: Software delay in milliseconds
@@ -96,6 +192,8 @@ void lcd_send_data(unsigned char data) {
 }
 
 void lcd_init(void) {
+    PROFILE_BEGIN(PROF_LCD_INIT);
+
     // Configure Port A for RS and EN
     TRISA = 0x01;           // RA0 as input (ADC), RA1 & RA3 as output (LCD)
     LATA = 0x00;
@@ -123,6 +221,8 @@ void lcd_init(void) {
     delay_ms(2);
     lcd_send_cmd(0x06);     // Entry mode
     lcd_send_cmd(0x0C);     // Display ON, cursor OFF
+
+    PROFILE_END(PROF_LCD_INIT);
 }
 
 void lcd_print(const char *str) {
@@ -158,14 +258,8 @@ void adc_init(void) {
     ADCON1 = 0x0E;
     
     // ADCON2: Configure ADC timing and result format
-    // ADFM = 1 (right justified), ACQT = 110 (16 TAD), ADCS = 110 (Fosc/64)
-    ADCON2bits.ADFM = 1;        // Right justified result
-    ADCON2bits.ACQT2 = 1;       // Acquisition time = 16 TAD
-    ADCON2bits.ACQT1 = 1;
-    ADCON2bits.ACQT0 = 0;
-    ADCON2bits.ADCS2 = 1;       // Conversion clock = Fosc/64
-    ADCON2bits.ADCS1 = 1;
-    ADCON2bits.ADCS0 = 0;
+    // ADFM = 1 (right justified); ACQT and ADCS chosen for _XTAL_FREQ
+    ADCON2 = ADC_ADCON2_RIGHT;
 }
 
 /******************************************************************************
@@ -174,11 +268,61 @@ void adc_init(void) {
  * Returns: 10-bit ADC result (0-1023)
  ******************************************************************************/
 unsigned int adc_read(void) {
+    unsigned int result;
+
+    PROFILE_BEGIN(PROF_ADC_READ);
     ADCON0bits.GO = 1;          // Start conversion
     while(ADCON0bits.GO);       // Wait for completion
-    return ((ADRESH << 8) | ADRESL);  // Return 10-bit result
+    result = (ADRESH << 8) | ADRESL;    // 10-bit result
+    PROFILE_END(PROF_ADC_READ);
+    return result;
 }
 
+#if USE_FIXED_POINT
+/******************************************************************************
+ * Function: adc_to_mv
+ * Description: Convert a 10-bit ADC result to millivolts without floats.
+ *              The 10 x 16 bit product with cal_gain is built from four
+ *              8x8 hardware multiplies, then rounded, shifted down and
+ *              corrected by cal_offset.
+ * Parameters: adc_value - 10-bit ADC result (0-1023)
+ * Returns: Input voltage in millivolts (0-5000 uncalibrated)
+ ******************************************************************************/
+unsigned int adc_to_mv(unsigned int adc_value) {
+    unsigned char al = (unsigned char)adc_value;
+    unsigned char ah = (unsigned char)(adc_value >> 8);
+    unsigned char gl = (unsigned char)cal_gain;
+    unsigned char gh = (unsigned char)(cal_gain >> 8);
+    unsigned long product;
+    int mv;
+
+    product  = MUL8X8(al, gl);
+    product += (unsigned long)MUL8X8(al, gh) << 8;
+    product += (unsigned long)MUL8X8(ah, gl) << 8;
+    product += (unsigned long)MUL8X8(ah, gh) << 16;
+
+    mv = (int)((product + (1UL << (ADC_MV_SHIFT - 1))) >> ADC_MV_SHIFT) + cal_offset;
+    return (mv < 0) ? 0 : (unsigned int)mv;
+}
+
+/******************************************************************************
+ * Function: mv_to_string
+ * Description: Format millivolts as "X.XX" volts, rounded to 10 mV
+ * Parameters: mv - voltage in millivolts (0-9994)
+ *             buffer - output, at least 5 bytes
+ * Returns: None
+ ******************************************************************************/
+void mv_to_string(unsigned int mv, char *buffer) {
+    char digits[5];
+
+    fmt_u16(digits, mv + 5, 4, '0');        // "VVVV" in mV, +5 rounds
+    buffer[0] = digits[0];
+    buffer[1] = '.';
+    buffer[2] = digits[1];
+    buffer[3] = digits[2];
+    buffer[4] = '\0';
+}
+#else
 /******************************************************************************
  * Function: float_to_string
  * Description: Convert float to string with 2 decimal places
@@ -192,6 +336,140 @@ void float_to_string(float value, char *buffer) {
     
     sprintf(buffer, "%d.%02d", integer_part, decimal_part);
 }
+#endif
+
+#if USE_CALIBRATION
+/******************************************************************************
+ * Function: cal_check_byte
+ * Description: Check byte of a calibration record
+ * Parameters: record - 6-byte record (magic, gain L/H, offset L/H, check)
+ * Returns: Expected value of record[5]
+ ******************************************************************************/
+unsigned char cal_check_byte(const unsigned char *record) {
+    return (unsigned char)(0xA5 ^ record[0] ^ record[1] ^ record[2] ^ record[3] ^ record[4]);
+}
+
+/******************************************************************************
+ * Function: cal_load
+ * Description: Load gain and offset from EEPROM if a valid record exists.
+ *              Six EEPROM reads: this is all calibration costs at boot.
+ * Parameters: None
+ * Returns: 1 if calibrated values were loaded, 0 if nominal values stay
+ ******************************************************************************/
+unsigned char cal_load(void) {
+    unsigned char record[6];
+
+    eeprom_read_block(CAL_EEPROM_ADDR, record, sizeof(record));
+    if(record[0] != CAL_MAGIC || record[5] != cal_check_byte(record)) {
+        return 0;
+    }
+    cal_gain = record[1] | ((unsigned int)record[2] << 8);
+    cal_offset = (int)(record[3] | ((unsigned int)record[4] << 8));
+    return 1;
+}
+
+/******************************************************************************
+ * Function: cal_save
+ * Description: Store gain and offset in EEPROM (about 25 ms)
+ * Parameters: gain - Q13 gain, offset - offset in mV
+ * Returns: None
+ ******************************************************************************/
+void cal_save(unsigned int gain, int offset) {
+    unsigned char record[6];
+
+    record[0] = CAL_MAGIC;
+    record[1] = (unsigned char)gain;
+    record[2] = (unsigned char)(gain >> 8);
+    record[3] = (unsigned char)offset;
+    record[4] = (unsigned char)((unsigned int)offset >> 8);
+    record[5] = cal_check_byte(record);
+    eeprom_write_block(CAL_EEPROM_ADDR, record, sizeof(record));
+}
+
+/******************************************************************************
+ * Function: cal_capture
+ * Description: Ask for a reference voltage and average 64 conversions
+ *              when S1 is pressed
+ * Parameters: mv - reference voltage to ask for
+ * Returns: Sum of 64 conversions, or 0xFFFF if S2 aborted
+ ******************************************************************************/
+unsigned int cal_capture(unsigned int mv) {
+    char buffer[6];
+    unsigned int sum = 0;
+    unsigned char i;
+
+    lcd_send_cmd(LCD_CLEAR);
+    lcd_goto(1, 0);
+    lcd_print("Apply ");
+    mv_to_string(mv, buffer);
+    lcd_print(buffer);
+    lcd_print("V AN0");
+    lcd_goto(2, 0);
+    lcd_print("S1=take S2=quit");
+
+    while(!BUTTON_S1 || !BUTTON_S2);    // Wait for both released
+    delay_ms(20);
+    while(BUTTON_S1) {
+        if(!BUTTON_S2) {
+            return 0xFFFF;
+        }
+    }
+    delay_ms(20);                       // Debounce
+
+    for(i = 0; i < 64; i++) {
+        sum += adc_read();              // 64 x 1023 fits 16 bits
+    }
+    return sum;
+}
+
+/******************************************************************************
+ * Function: cal_run
+ * Description: Two-point calibration. With s = sum of 64 conversions:
+ *                gain   = (V2 - V1) * 2^(13+6) / (s2 - s1)
+ *                offset = V1 - ((s1 * gain) >> (13+6))
+ *              so that ((ADC * gain) >> 13) + offset hits both points.
+ *              Division is fine here; it runs once, not per sample.
+ *              The gain stays 32-bit until it is within 20% of nominal,
+ *              so a tiny span cannot wrap into a plausible 16-bit value.
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void cal_run(void) {
+    unsigned int s1, s2;
+    unsigned long span, gain;
+    long offset;
+
+    s1 = cal_capture(CAL_LOW_MV);
+    if(s1 == 0xFFFF) return;
+    s2 = cal_capture(CAL_HIGH_MV);
+    if(s2 == 0xFFFF) return;
+
+    lcd_send_cmd(LCD_CLEAR);
+    lcd_goto(1, 0);
+    if(s2 > s1 && s2 - s1 >= CAL_MIN_SPAN) {
+        span = s2 - s1;
+        gain = (((unsigned long)(CAL_HIGH_MV - CAL_LOW_MV) << (ADC_MV_SHIFT + 6))
+                + span / 2) / span;
+
+        // s1 * gain fits 32 bits only once gain is in range
+        if(gain >= ADC_MV_GAIN / 5 * 4 && gain <= ADC_MV_GAIN / 5 * 6) {
+            offset = (long)CAL_LOW_MV
+                   - (long)(((unsigned long)s1 * gain + (1UL << (ADC_MV_SHIFT + 5))) >> (ADC_MV_SHIFT + 6));
+
+            if(offset >= -250 && offset <= 250) {
+                cal_save((unsigned int)gain, (int)offset);
+                cal_gain = (unsigned int)gain;
+                cal_offset = (int)offset;
+                lcd_print("CAL saved");
+                delay_ms(2000);
+                return;
+            }
+        }
+    }
+    lcd_print("CAL rejected");          // Swapped, too close or wrong references
+    delay_ms(2000);
+}
+#endif
 
 /******************************************************************************
  * Function: display_adc
@@ -199,30 +477,90 @@ void float_to_string(float value, char *buffer) {
  ******************************************************************************/
 void display_adc(void) {
     unsigned int adc_value;
-    float voltage;
     char buffer[16];
     
+    PROFILE_BEGIN(PROF_DISPLAY);
+
     // Read ADC value
+#if USE_FILTER
+    adc_value = filter_run(&adc_filter, adc_read());
+#else
     adc_value = adc_read();
-    
-    // Calculate voltage (10-bit ADC, 0-1023 maps to 0-5V)
-    voltage = (float)adc_value * (5.0 / 1023.0);
+#endif
     
     // Display on LCD Line 1: "Analog: X.XXV"
     lcd_goto(1, 0);
     lcd_print("Analog: ");
-    float_to_string(voltage, buffer);
+#if USE_FIXED_POINT
+    mv_to_string(adc_to_mv(adc_value), buffer);
+#else
+    // Calculate voltage (10-bit ADC, 0-1023 maps to 0-5V)
+    float_to_string((float)adc_value * (5.0 / 1023.0), buffer);
+#endif
     lcd_print(buffer);
     lcd_print("V  ");  // Extra spaces to clear previous longer values
     
+#if USE_BARGRAPH
+    // Display on LCD Line 2: bar graph (only changed cells are rewritten)
+    PROFILE_BEGIN(PROF_BARGRAPH);
+    bargraph_update(adc_value);
+    PROFILE_END(PROF_BARGRAPH);
+#else
     // Display on LCD Line 2: "Digital: XXXX"
     lcd_goto(2, 0);
     lcd_print("Digital: ");
+#if USE_FIXED_POINT
+    fmt_u16(buffer, adc_value, 4, ' ');
+#else
     sprintf(buffer, "%4d", adc_value);
+#endif
     lcd_print(buffer);
     lcd_print("    ");
+#endif
+
+    PROFILE_END(PROF_DISPLAY);
 }
 
+#if PROFILE
+
+/******************************************************************************
+ * Function: profile_show
+ * Description: Page through the profiled sections while S1 is held, one
+ *              second each, then restore the normal display
+ ******************************************************************************/
+void profile_show(void) {
+    char line[PROFILE_SUMMARY_LEN];
+    unsigned char i = 0;
+
+    while(!BUTTON_S1) {
+        lcd_send_cmd(LCD_CLEAR);
+        lcd_goto(1, 0);
+        lcd_print(profile_names[i]);
+        lcd_goto(2, 0);
+        profile_summary(i, line);
+        lcd_print(line);
+        delay_ms(1000);
+        if(++i == PROFILE_COUNT) {
+            i = 0;
+        }
+    }
+
+    lcd_send_cmd(LCD_CLEAR);
+#if USE_BARGRAPH
+    bargraph_init(2);
+#endif
+}
+
+/******************************************************************************
+ * Function: __interrupt() high_priority ISR
+ * Description: Timer3 overflow count for the profiler timestamps
+ ******************************************************************************/
+void __interrupt(high_priority) ISR(void) {
+    profile_isr();
+}
+
+#endif
+
 /******************************************************************************
  * Function: system_init
  * Description: Initialize oscillator
@@ -234,6 +572,11 @@ void system_init(void) {
     OSCCONbits.IRCF0 = 1;
     OSCCONbits.SCS1 = 1;
     OSCCONbits.SCS0 = 0;
+
+#if USE_CALIBRATION || PROFILE
+    TRISCbits.TRISC0 = 1;   // S1 (calibrate, profile pages) as input
+    TRISCbits.TRISC1 = 1;   // S2 (erase calibration) as input
+#endif
 }
 
 /******************************************************************************
@@ -241,14 +584,39 @@ void system_init(void) {
  * Description: Main program
  ******************************************************************************/
 void main(void) {
+#if USE_FILTER
+    unsigned char i;
+#endif
+
     // Initialize system
     system_init();
+
+#if PROFILE
+    // Start the profiler timebase (Timer3 and its overflow interrupt)
+    profile_init();
+    INTCONbits.PEIE = 1;
+    INTCONbits.GIE = 1;
+#endif
     
     // Initialize LCD
     lcd_init();
     
     // Initialize ADC
     adc_init();
+#if USE_FILTER
+    filter_init(&adc_filter, FILTER_TYPE, FILTER_COEF);
+#endif
+
+#if USE_CALIBRATION
+    // S2 at reset: forget calibration; S1 at reset: calibrate
+    if(!BUTTON_S2) {
+        eeprom_write_byte(CAL_EEPROM_ADDR, 0xFF);
+    }
+    cal_load();
+    if(!BUTTON_S1) {
+        cal_run();
+    }
+#endif
     
     // Display title briefly
     lcd_goto(1, 0);
@@ -260,10 +628,29 @@ void main(void) {
     // Clear display
     lcd_send_cmd(LCD_CLEAR);
     
+#if USE_BARGRAPH
+    // Load bar glyphs into CGRAM once and reserve line 2 for the bar
+    bargraph_init(2);
+#endif
+    
     // Main loop - continuous ADC reading and display
     while(1) {
         display_adc();      // Read ADC and update display
+#if PROFILE
+        if(!BUTTON_S1) {
+            profile_show();     // S1 held: section timings
+        }
+#endif
+#if USE_FILTER
+        // Keep feeding the filter between updates (500 ms in total)
+        for(i = 1; i < FILTER_READS; i++) {
+            delay_ms(500 / FILTER_READS);
+            filter_run(&adc_filter, adc_read());
+        }
+        delay_ms(500 / FILTER_READS);
+#else
         delay_ms(500);      // Update every 500ms
+#endif
     }
 }
 
@@ -285,7 +672,11 @@ void main(void) {
  *   1. Open MPLAB X IDE
  *   2. Create new project for PIC18F4550
  *   3. Select XC8 compiler
- *   4. Add this C file to Source Files
+ *   4. Add this C file, lcd_bargraph.c, Common/numfmt.c,
+ *      Common/filter.c and Drivers/eeprom.c to Source Files, and the
+ *      matching headers to Header Files
+ *      For section profiling also add Common/profile.c and define
+ *      PROFILE=1 (Project Properties -> XC8 -> Define macros)
  *   5. Build project: Production → Build Main Project
  *   6. Program using PICkit programmer
  *
@@ -306,11 +697,33 @@ void main(void) {
  * Expected Output:
  *   LCD Line 1: "Analog: 2.50V" (updates with pot rotation)
  *   LCD Line 2: "Digital: 512"  (updates with pot rotation)
+ *   Bar graph mode: line 2 fills left to right (8 full cells at 2.50V);
+ *   a thin peak marker stays at the highest level for ~3 s.
+ *
+ * Fixed-Point vs Float Comparison:
+ *   Build once with USE_FIXED_POINT = 1 and once with 0, then compare:
+ *   - ROM/RAM: MPLAB X Dashboard "Memory" after Clean and Build
+ *   - Cycles:  MPLAB X Simulator Stopwatch, breakpoints on the
+ *              lcd_print("Analog: ") line and the following lcd_print(buffer)
+ *   Expected (XC8 v2.x, -O1): the float path links the float multiply,
+ *   float-to-int and sprintf runtimes (several KB of ROM) and needs
+ *   thousands of cycles per sample; the integer path is a few hundred
+ *   bytes of ROM, about a dozen bytes of stack, and a few hundred cycles
+ *   (four MULWF plus a 13-bit double-dabble conversion in fmt_u16).
+ *
+ * Bar Graph Redraw Cost:
+ *   Watch bargraph_bytes / bargraph_samples, or call
+ *   bargraph_avg_bytes_x10(). A full line rewrite costs 17 bytes
+ *   (1 address + 16 data); with the pot held still the average drops
+ *   towards 0, and a slow sweep costs 2 bytes (address + glyph) only on
+ *   samples where one cell changes - under 1 byte per sample on average.
  *
  * Troubleshooting:
  *   - Constant 0V reading: Check RA0 connection and ADCON1 configuration
  *   - Constant 5V reading: Check potentiometer connections
  *   - Erratic readings: Add capacitor (100nF) from RA0 to GND
  *   - No LCD display: Check LCD connections (refer to Q5)
- *   - Wrong voltage calculation: Verify VREF+ = VDD = 5V
+ *   - Wrong voltage calculation: Verify VREF+ = VDD = 5V, or calibrate
+ *     (hold S1 at reset); "CAL rejected" means the two references were
+ *     swapped or more than 20% / 250 mV away from the expected reading
  ******************************************************************************/
@@ -0,0 +1,404 @@
+/******************************************************************************
+ * PIC18F4550 High-Rate ADC Data Logger
+ * Experiment Q8 (variant): Continuous AN0 Sampling Streamed over UART
+ *
+ * Author: Microcontroller Lab
+ * Target Device: PIC18F4550
+ * IDE: MPLAB X IDE
+ * Compiler: XC8
+ * Kit: Microembedded PIC18F4550 Development Kit
+ *
+ * Description:
+ *   adc_lcd.c samples only as fast as the LCD can be redrawn. This
+ *   program samples AN0 at a fixed LOG_SAMPLE_RATE (up to several kHz)
+ *   and streams every sample to the PC instead of showing it:
+ *
+ *   - Timer2 interrupts at LOG_SAMPLE_RATE. The ISR stores the result of
+ *     the previous conversion and starts the next one, so no time is
+ *     spent waiting for the ADC.
+ *   - Results are packed four 10-bit samples into five bytes (ADRESL
+ *     goes in as is; the two ADRESH bits are shifted into a shared
+ *     fifth byte), 40 samples per block, in a ring of LOG_BLOCKS blocks.
+ *   - Main sends each full block as a binary frame (Drivers/frame_link.c,
+ *     message ADC_BLOCK in link_protocol.h) through the interrupt-driven
+ *     UART. Every block carries a 16-bit number so the host can see
+ *     which blocks were lost.
+ *   - If the UART falls behind and the ring is full, the newest block
+ *     is discarded (counted as dropped) and its number is skipped.
+ *
+ *   About four times a second an ADC_STATS frame reports the achieved
+ *   sample rate, missed samples, dropped blocks and CPU headroom.
+ *
+ * Hardware Configuration:
+ *   ADC Input:          AN0 (RA0) - potentiometer wiper or signal source
+ *   UART TX:            RC6 (to USB-Serial adapter RX)
+ *   UART RX:            RC7 (to USB-Serial adapter TX)
+ *
+ * ADC Configuration:
+ *   Right justified, ACQT/ADCS from Drivers/adc_config.h (4 TAD, Fosc/8
+ *   at 8 MHz) -> 15 us per conversion, well inside one sample period
+ *
+ * UART Bandwidth:
+ *   Each block is ADC_BLOCK_LEN + 6 = 58 bytes on the wire for 40
+ *   samples (1.45 bytes per sample, 14.5 bit times). 4 kHz therefore
+ *   needs 58000 baud or more; the build stops with an #error if UART_BAUD
+ *   is too slow. At 8 MHz use UART_BAUD = 500000 (exact: SPBRG = 3).
+ *
+ * Crystal Frequency: 8 MHz (Internal Oscillator)
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "../../Common/frame.h"
+#include "../../Common/atomic.h"
+#include "../Drivers/system_config.h"
+#include "../Drivers/adc_config.h"
+#include "../Drivers/uart_driver.h"
+#include "../Drivers/frame_link.h"
+#include "../Drivers/irq_priority.h"
+#include "../Q7_UART_Serial_Communication/link_protocol.h"
+
+// Configuration Bits
+#pragma config FOSC = INTOSCIO_EC   // Internal oscillator
+#pragma config WDTE = OFF           // Watchdog Timer disabled
+#pragma config PWRTE = OFF          // Power-up Timer disabled
+#pragma config BOREN = OFF          // Brown-out Reset disabled
+#pragma config PBADEN = OFF         // PORTB pins as digital I/O
+#pragma config LVP = OFF            // Low-Voltage Programming disabled
+#pragma config MCLRE = OFF          // MCLR function disabled
+
+// Sample Rate (Hz)
+#define LOG_SAMPLE_RATE     4000UL
+
+// Block Ring (power of two)
+#define LOG_BLOCKS          4
+#define LOG_BLOCK_MASK      (LOG_BLOCKS - 1)
+#define LOG_DATA_BYTES      (ADC_BLOCK_LEN - 2)
+
+// Timer2 Setup: period = LOG_T2_DIV instruction cycles, prescaler 1/4/16
+#define LOG_T2_DIV          ((_XTAL_FREQ / 4) / LOG_SAMPLE_RATE)
+#if LOG_T2_DIV <= 256
+#define LOG_T2_PRE          1
+#define LOG_T2_CKPS         0x00
+#elif LOG_T2_DIV <= 1024
+#define LOG_T2_PRE          4
+#define LOG_T2_CKPS         0x01
+#elif LOG_T2_DIV <= 4096
+#define LOG_T2_PRE          16
+#define LOG_T2_CKPS         0x02
+#else
+#error "LOG_SAMPLE_RATE too low for Timer2 without postscaler"
+#endif
+#define LOG_PR2             (LOG_T2_DIV / LOG_T2_PRE - 1)
+
+// The sample ISR needs roughly 60 instruction cycles
+#if LOG_T2_DIV < 100
+#error "LOG_SAMPLE_RATE too high for this clock"
+#endif
+
+// Each conversion must finish before the next tick reads it
+#if LOG_T2_DIV <= ADC_CONVERSION_CYCLES
+#error "LOG_SAMPLE_RATE faster than the ADC conversion time"
+#endif
+
+// UART must carry 58 bytes (580 bit times) per 40 samples
+#if LOG_SAMPLE_RATE * (ADC_BLOCK_LEN + FRAME_OVERHEAD + 2) * 10 / ADC_BLOCK_SAMPLES > UART_BAUD
+#error "UART_BAUD too slow for LOG_SAMPLE_RATE: raise UART_BAUD in system_config.h (500000 at 8 MHz)"
+#endif
+
+// Measurement Window: one Timer1 overflow, 1:8 prescale = 524288 cycles
+#define WINDOW_SHIFT        19
+
+typedef struct {
+    unsigned int number;                    // Little endian, as sent
+    unsigned char data[LOG_DATA_BYTES];     // Packed samples
+} log_block_t;
+
+// Block Ring: wr advanced by the ISR, rd advanced by main
+volatile log_block_t blocks[LOG_BLOCKS];
+volatile unsigned char block_wr = 0;
+volatile unsigned char block_rd = 0;
+
+// Sampler State (ISR only)
+unsigned char pack_pos = 0;                 // Byte offset in the block
+unsigned char pack_phase = 0;               // Sample within the group of 4
+unsigned char pack_high = 0;                // Collected ADRESH bits
+unsigned int block_number = 0;
+
+// Counters (written by the ISR)
+volatile unsigned int window_samples = 0;
+volatile unsigned int missed_samples = 0;
+volatile unsigned int dropped_blocks = 0;
+
+// Main-loop State
+unsigned int blocks_sent = 0;
+unsigned char frame_seq = 0;
+unsigned char stats[ADC_STATS_LEN];
+unsigned char stats_pending = 0;
+
+/******************************************************************************
+ * Function: sample_tick
+ * Description: Timer2 interrupt work: store the finished conversion,
+ *              start the next one and close the block when it is full.
+ *              Every sample is taken one Timer2 period after the last.
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void sample_tick(void) {
+    volatile log_block_t *block;
+    unsigned char next;
+
+    if(ADCON0bits.GO) {
+        missed_samples++;               // Conversion still running
+        return;
+    }
+
+    block = &blocks[block_wr];
+    block->data[pack_pos++] = ADRESL;
+    pack_high = (pack_high >> 2) | (unsigned char)(ADRESH << 6);
+    ADCON0bits.GO = 1;                  // Start the next conversion
+    window_samples++;
+
+    if(++pack_phase == 4) {
+        block->data[pack_pos++] = pack_high;
+        pack_phase = 0;
+
+        if(pack_pos == LOG_DATA_BYTES) {
+            pack_pos = 0;
+            block->number = block_number++;
+            next = (block_wr + 1) & LOG_BLOCK_MASK;
+            if(next != block_rd) {
+                block_wr = next;        // Publish the full block
+            } else {
+                dropped_blocks++;       // Ring full: reuse this block
+            }
+        }
+    }
+}
+
+/******************************************************************************
+ * Function: isr_low
+ * Description: Low-priority interrupt: UART transmit (Drivers/irq_priority.h)
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void IRQ_LOW_HANDLER isr_low(void) {
+    uart_tx_isr();
+}
+
+/******************************************************************************
+ * Function: __interrupt() high_priority ISR
+ * Description: Sample timer first (fixed latency), then UART receive;
+ *              never delayed by the transmit side
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void __interrupt(high_priority) ISR(void) {
+    if(PIE1bits.TMR2IE && PIR1bits.TMR2IF) {
+        PIR1bits.TMR2IF = 0;
+        sample_tick();
+    }
+    uart_rx_isr();
+    IRQ_CALL_LOW(isr_low);
+}
+
+/******************************************************************************
+ * Function: adc_logger_init
+ * Description: Configure AN0 for back-to-back conversions started by the
+ *              sample ISR
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void adc_logger_init(void) {
+    TRISAbits.TRISA0 = 1;       // RA0 as input
+    ADCON1 = 0x0E;              // AN0 analog, VREF = VDD/VSS
+    ADCON0 = 0x01;              // Channel AN0, ADC on
+    ADCON2 = ADC_ADCON2_RIGHT;  // Right justified, timing from adc_config.h
+}
+
+/******************************************************************************
+ * Function: sampler_start
+ * Description: Start the first conversion and the Timer2 sample clock
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void sampler_start(void) {
+    ADCON0bits.GO = 1;          // First tick stores this result
+    PR2 = LOG_PR2;
+    TMR2 = 0;
+    T2CON = LOG_T2_CKPS;        // Postscale 1:1
+    PIR1bits.TMR2IF = 0;
+    PIE1bits.TMR2IE = 1;
+    T2CONbits.TMR2ON = 1;
+}
+
+/******************************************************************************
+ * Function: put_u16
+ * Description: Store a value little endian
+ * Parameters: buf - destination, value - value to store
+ * Returns: None
+ ******************************************************************************/
+void put_u16(unsigned char *buf, unsigned int value) {
+    buf[0] = (unsigned char)value;
+    buf[1] = (unsigned char)(value >> 8);
+}
+
+/******************************************************************************
+ * Function: logger_poll
+ * Description: One pass of the main loop: queue the stats frame or the
+ *              oldest full block if the link can take it
+ * Parameters: None
+ * Returns: 1 if a frame was queued, 0 if there was nothing to do
+ ******************************************************************************/
+unsigned char logger_poll(void) {
+    if(link_tx_busy()) {
+        return 0;
+    }
+    if(stats_pending) {
+        link_send(MSG_ADC_STATS, frame_seq++, stats, ADC_STATS_LEN);
+        stats_pending = 0;
+        return 1;
+    }
+    if(block_rd != block_wr) {
+        link_send(MSG_ADC_BLOCK, frame_seq++,
+                  (const unsigned char *)&blocks[block_rd], ADC_BLOCK_LEN);
+        block_rd = (block_rd + 1) & LOG_BLOCK_MASK;     // Frame copied: free it
+        blocks_sent++;
+        return 1;
+    }
+    return 0;
+}
+
+/******************************************************************************
+ * Function: run_window
+ * Description: Run the main loop for one Timer1 overflow period
+ *              (2^WINDOW_SHIFT instruction cycles) and count the passes
+ *              that found nothing to do
+ * Parameters: None
+ * Returns: Idle pass count
+ ******************************************************************************/
+unsigned long run_window(void) {
+    unsigned long idle = 0;
+
+    TMR1H = 0;
+    TMR1L = 0;
+    PIR1bits.TMR1IF = 0;
+    T1CONbits.TMR1ON = 1;
+    while(!PIR1bits.TMR1IF) {
+        if(!logger_poll()) {
+            idle++;
+        }
+    }
+    T1CONbits.TMR1ON = 0;
+    return idle;
+}
+
+/******************************************************************************
+ * Function: build_stats
+ * Description: Fill the ADC_STATS payload for the window just finished.
+ *              The sample ISR is masked while its counters are copied.
+ * Parameters: idle     - idle passes in this window
+ *             baseline - idle passes in a window with sampling stopped
+ * Returns: None
+ ******************************************************************************/
+void build_stats(unsigned long idle, unsigned long baseline) {
+    unsigned int samples, missed, dropped;
+    unsigned long rate;
+
+    ATOMIC_MASK_BEGIN(PIE1bits.TMR2IE)
+        samples = window_samples;
+        window_samples = 0;
+        missed = missed_samples;
+        dropped = dropped_blocks;
+    ATOMIC_MASK_END(PIE1bits.TMR2IE)
+
+    // samples * Fcyc / 2^19, split so the product stays within 32 bits
+    rate = ((unsigned long)samples * ((_XTAL_FREQ / 4) >> 7)) >> (WINDOW_SHIFT - 7);
+
+    put_u16(&stats[0], (unsigned int)rate);
+    put_u16(&stats[2], missed);
+    put_u16(&stats[4], dropped);
+    put_u16(&stats[6], blocks_sent);
+    stats[8] = (unsigned char)((idle * 100) / baseline);
+    put_u16(&stats[9], (unsigned int)LOG_SAMPLE_RATE);
+    stats_pending = 1;
+}
+
+/******************************************************************************
+ * Function: system_init
+ * Description: Initialize oscillator
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void system_init(void) {
+    // Configure internal oscillator to 8 MHz
+    OSCCONbits.IRCF2 = 1;
+    OSCCONbits.IRCF1 = 1;
+    OSCCONbits.IRCF0 = 1;
+    OSCCONbits.SCS1 = 1;
+    OSCCONbits.SCS0 = 0;
+}
+
+/******************************************************************************
+ * Function: main
+ * Description: Measure the idle baseline, then sample and stream forever
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void main(void) {
+    unsigned long baseline, idle;
+
+    system_init();
+    IRQ_PRIORITY_INIT();
+    IRQ_SET(IPR1bits.TMR2IP, IRQ_HIGH);     // Sample timer
+    IRQ_SET(IPR1bits.RCIP, IRQ_HIGH);       // UART RX; TX stays low
+    uart_init();
+    link_init();
+    adc_logger_init();
+    T1CON = 0xB0;               // 16-bit, 1:8 prescale, Fosc/4, off
+
+    // Idle passes per window with nothing to send = 100% headroom
+    baseline = run_window();
+
+    sampler_start();
+    while(1) {
+        idle = run_window();
+        build_stats(idle, baseline);
+    }
+}
+
+/******************************************************************************
+ * Build Instructions:
+ *   1. Create a new MPLAB X project for PIC18F4550 with XC8
+ *   2. Add this file, Drivers/uart_driver.c, Drivers/frame_link.c and
+ *      Common/frame.c to Source Files (not adc_lcd.c)
+ *   3. Project Properties -> XC8 Compiler -> Define macros:
+ *      UART_BAUD=500000 (or edit Drivers/system_config.h)
+ *   4. Set LOG_SAMPLE_RATE above, then build and program
+ *
+ * Testing Instructions:
+ *   1. Connect the USB-Serial adapter (RC6 -> adapter RX, GND) and the
+ *      potentiometer (or a signal generator, 0-5 V) to AN0
+ *   2. On the PC (Host/link_tool):
+ *        ./link_cli /dev/ttyUSB0 --baud 500000 log 10 samples.csv
+ *      Every stats line shows the achieved rate, missed samples,
+ *      dropped blocks (board and host view) and CPU headroom.
+ *   3. samples.csv holds one 10-bit value per line; plot it to check
+ *      the waveform. Without the kit: ./link_sim --baud 500000 --logger
+ *
+ * What to Expect (estimates, 8 MHz, not yet measured on the kit):
+ *   - Achieved rate equals LOG_SAMPLE_RATE; missed samples stay 0 while
+ *     the ADC (15 us) is faster than the sample period
+ *   - Dropped blocks stay 0 as long as the UART keeps up (see UART
+ *     Bandwidth above) and the PC reads the port in time
+ *   - Headroom drops with rate: each sample costs an interrupt of about
+ *     60-80 cycles and each of the 1.45 bytes per sample a TX interrupt
+ *     of similar size, so 4 kHz uses roughly a third of the 2 MIPS CPU
+ *
+ * Troubleshooting:
+ *   - Build error "UART_BAUD too slow": raise UART_BAUD for the whole
+ *     project or lower LOG_SAMPLE_RATE
+ *   - Host sees no frames: the baud rate on both sides must match
+ *   - Blocks dropped on the host side only: the PC or adapter lost
+ *     bytes (CRC/format errors are counted as well)
+ ******************************************************************************/
@@ -0,0 +1,276 @@
+/******************************************************************************
+ * PIC18F4550 Multi-Channel ADC Monitor
+ * Experiment Q8 (variant): Oversampled Round-Robin Scan Reported over UART
+ *
+ * Author: Microcontroller Lab
+ * Target Device: PIC18F4550
+ * IDE: MPLAB X IDE
+ * Compiler: XC8
+ * Kit: Microembedded PIC18F4550 Development Kit
+ *
+ * Description:
+ *   adc_lcd.c reads AN0 only. This program scans the channels listed in
+ *   scan_channels[] with Drivers/adc_scanner.c (SCAN_RATE conversions per
+ *   second shared round robin, 4^ADC_SCAN_OS_BITS conversions per result)
+ *   and about four times a second prints the latest snapshot together
+ *   with the measured snapshot rate and the CPU time left for main:
+ *
+ *     seq 17  AN0 2047  AN1 12  AN2 4095  AN3 1990  62 Hz/ch  CPU free 81%
+ *
+ *   At reset it first prints the ADC timing selected by adc_config.h:
+ *
+ *     ADC clock Fosc/8, TAD 1000 ns, acquisition 4 TAD, conversion
+ *     15000 ns, max 58823 Hz; scanning at 4000 Hz
+ *
+ *   Values are ADC_SCAN_RESULT_BITS wide (0-4095 with the default n = 2).
+ *   Each channel gets the filter listed in scan_filters[]; by default
+ *   AN0 (the potentiometer) is smoothed by a 4-sample boxcar and AN1 has
+ *   a 5-tap median against spikes.
+ *
+ *   CPU free is measured the same way as in adc_logger.c: main counts
+ *   idle passes for one Timer1 window (524288 cycles) before the scan
+ *   starts and again while it runs; the ratio is the share left over.
+ *
+ * Per-Channel Rate and CPU Load (estimates, 8 MHz, n = 2, 4 channels):
+ *   Every conversion costs one interrupt of about 100 cycles (context
+ *   save/restore, channel switch, 16-bit add, UART hooks); publishing a
+ *   snapshot adds about 25 cycles per channel once per 4^n rounds, and
+ *   each channel's filter (Common/filter.h) runs once per snapshot.
+ *
+ *   SCAN_RATE   Period    Per channel (12 bit)   CPU load
+ *     2000      1000 cyc       31 Hz                10%
+ *     4000       500 cyc       62 Hz                20%
+ *     8000       250 cyc      125 Hz                40%   (highest)
+ *
+ *   Per-channel rate = SCAN_RATE / (channels * 4^n): halve it for twice
+ *   the channels, divide by 4 for each extra bit. CPU load depends only
+ *   on SCAN_RATE. The load line printed by the program replaces these
+ *   estimates with the real figure for the kit.
+ *
+ * Hardware Configuration:
+ *   ADC Inputs:         AN0-AN3 (RA0-RA3) by default; the kit wires the
+ *                       potentiometer to AN0, others float unless wired
+ *   UART TX:            RC6 (to USB-Serial adapter RX)
+ *   UART RX:            RC7 (to USB-Serial adapter TX)
+ *
+ * Crystal Frequency: 8 MHz (Internal Oscillator)
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "../../Common/numfmt.h"
+#include "../../Common/filter.h"
+#include "../Drivers/system_config.h"
+#include "../Drivers/uart_driver.h"
+#include "../Drivers/adc_scanner.h"
+#include "../Drivers/irq_priority.h"
+
+// Configuration Bits
+#pragma config FOSC = INTOSCIO_EC   // Internal oscillator
+#pragma config WDTE = OFF           // Watchdog Timer disabled
+#pragma config PWRTE = OFF          // Power-up Timer disabled
+#pragma config BOREN = OFF          // Brown-out Reset disabled
+#pragma config PBADEN = OFF         // PORTB pins as digital I/O
+#pragma config LVP = OFF            // Low-Voltage Programming disabled
+#pragma config MCLRE = OFF          // MCLR function disabled
+
+// Conversions per second, shared by all channels
+#define SCAN_RATE           4000UL
+#define SCAN_PERIOD         ((unsigned int)((_XTAL_FREQ / 4) / SCAN_RATE))
+
+#if (_XTAL_FREQ / 4) / SCAN_RATE < ADC_SCAN_MIN_PERIOD
+#error "SCAN_RATE too high for this clock"
+#endif
+
+// Measurement Window: one Timer1 overflow, 1:8 prescale = 524288 cycles
+#define WINDOW_SHIFT        19
+
+// Channels to scan, in order
+const unsigned char scan_channels[] = {0, 1, 2, 3};
+#define SCAN_COUNT          (sizeof(scan_channels) / sizeof(scan_channels[0]))
+
+// Filter per channel list entry: type and coefficient (Common/filter.h)
+const unsigned char scan_filters[SCAN_COUNT] = {
+    FILTER_BOXCAR, FILTER_MEDIAN5, FILTER_NONE, FILTER_NONE
+};
+const unsigned int scan_filter_coefs[SCAN_COUNT] = {2, 0, 0, 0};
+
+/******************************************************************************
+ * Function: isr_low
+ * Description: Low-priority interrupts: ADC scanner (the sample instant
+ *              is set by CCP2 in hardware, the ISR only has to finish
+ *              within one period) and UART transmit
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void IRQ_LOW_HANDLER isr_low(void) {
+    adc_scanner_isr();
+    uart_tx_isr();
+}
+
+/******************************************************************************
+ * Function: __interrupt() high_priority ISR
+ * Description: UART receive (Drivers/irq_priority.h)
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void __interrupt(high_priority) ISR(void) {
+    uart_rx_isr();
+    IRQ_CALL_LOW(isr_low);
+}
+
+/******************************************************************************
+ * Function: run_window
+ * Description: Spin for one Timer1 overflow period (2^WINDOW_SHIFT
+ *              instruction cycles), counting loop passes
+ * Parameters: None
+ * Returns: Idle pass count
+ ******************************************************************************/
+unsigned long run_window(void) {
+    unsigned long idle = 0;
+
+    TMR1H = 0;
+    TMR1L = 0;
+    PIR1bits.TMR1IF = 0;
+    T1CONbits.TMR1ON = 1;
+    while(!PIR1bits.TMR1IF) {
+        idle++;
+    }
+    T1CONbits.TMR1ON = 0;
+    return idle;
+}
+
+/******************************************************************************
+ * Function: print_number
+ * Description: Queue a label followed by an unsigned number
+ * Parameters: label - text before the number, value - number to print
+ * Returns: None
+ ******************************************************************************/
+void print_number(const char *label, unsigned long value) {
+    char number[11];
+
+    while(*label) {
+        label += uart_write_string(label);
+    }
+    fmt_u32(number, value, 0, ' ');
+    while(!uart_write_string(number));
+}
+
+/******************************************************************************
+ * Function: report_adc_timing
+ * Description: Print the ADC timing chosen by Drivers/adc_config.h
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void report_adc_timing(void) {
+    print_number("\r\nADC clock Fosc/", ADC_CLOCK_DIV);
+    print_number(", TAD ", ADC_TAD_NS);
+    print_number(" ns, acquisition ", ADC_ACQT_TAD);
+    print_number(" TAD, conversion ", ADC_CONVERSION_NS);
+    print_number(" ns, max ", ADC_MAX_SAMPLE_RATE);
+    print_number(" Hz; scanning at ", SCAN_RATE);
+    while(!uart_write_string(" Hz\r\n"));
+    uart_flush();
+}
+
+/******************************************************************************
+ * Function: report
+ * Description: Print the latest snapshot, the snapshot rate and the CPU
+ *              share left over in the last window
+ * Parameters: snapshots - snapshots published during the window
+ *             idle      - idle passes in the window
+ *             baseline  - idle passes in a window with scanning stopped
+ * Returns: None
+ ******************************************************************************/
+void report(unsigned char snapshots, unsigned long idle, unsigned long baseline) {
+    adc_snapshot_t snap;
+    unsigned char i;
+
+    adc_scanner_read(&snap);
+
+    print_number("seq ", snap.seq);
+    for(i = 0; i < snap.count; i++) {
+        print_number("  AN", scan_channels[i]);
+        print_number(" ", snap.value[i]);
+    }
+    // snapshots * Fcyc / 2^19, split so the product stays within 32 bits
+    print_number("  ", ((unsigned long)snapshots * ((_XTAL_FREQ / 4) >> 7)) >> (WINDOW_SHIFT - 7));
+    print_number(" Hz/ch  CPU free ", (idle * 100) / baseline);
+    while(!uart_write_string("%\r\n"));
+    uart_flush();
+}
+
+/******************************************************************************
+ * Function: system_init
+ * Description: Initialize oscillator and analog pins
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void system_init(void) {
+    // Configure internal oscillator to 8 MHz
+    OSCCONbits.IRCF2 = 1;
+    OSCCONbits.IRCF1 = 1;
+    OSCCONbits.IRCF0 = 1;
+    OSCCONbits.SCS1 = 1;
+    OSCCONbits.SCS0 = 0;
+
+    TRISA |= 0x0F;              // RA0-RA3 (AN0-AN3) as inputs
+}
+
+/******************************************************************************
+ * Function: main
+ * Description: Measure the idle baseline, then scan and report forever
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void main(void) {
+    unsigned long baseline, idle;
+    unsigned char seq, i;
+
+    system_init();
+    IRQ_PRIORITY_INIT();
+    IRQ_SET(IPR1bits.RCIP, IRQ_HIGH);       // UART RX; scanner and TX low
+    uart_init();
+    T1CON = 0xB0;               // 16-bit, 1:8 prescale, Fosc/4, off
+
+    report_adc_timing();
+
+    // Idle passes per window with no ADC interrupts = 100% free
+    baseline = run_window();
+
+    adc_scanner_start(scan_channels, SCAN_COUNT, SCAN_PERIOD);
+    for(i = 0; i < SCAN_COUNT; i++) {
+        adc_scanner_set_filter(i, scan_filters[i], scan_filter_coefs[i]);
+    }
+    while(1) {
+        seq = adc_scanner_seq();
+        idle = run_window();
+        report((unsigned char)(adc_scanner_seq() - seq), idle, baseline);
+    }
+}
+
+/******************************************************************************
+ * Build Instructions:
+ *   1. Create a new MPLAB X project for PIC18F4550 with XC8
+ *   2. Add this file, Drivers/adc_scanner.c, Drivers/uart_driver.c,
+ *      Common/filter.c and Common/numfmt.c to Source Files (not adc_lcd.c)
+ *   3. Edit scan_channels[], scan_filters[] and SCAN_RATE; for 11-bit
+ *      results define ADC_SCAN_OS_BITS=1 in Project Properties -> XC8 ->
+ *      Define macros
+ *   4. Build and program; open Tera Term at UART_BAUD (9600 default)
+ *
+ * Testing Instructions:
+ *   1. Turn the potentiometer: the AN0 column sweeps 0 to 4095
+ *   2. Tie AN1 to GND and AN2 to VDD: they read 0 and 4095 (a few
+ *      counts off with real references)
+ *   3. Double SCAN_RATE: Hz/ch doubles and CPU free falls by roughly
+ *      the load step in the table above
+ *
+ * Troubleshooting:
+ *   - Floating inputs wander: they are unconnected, not broken
+ *   - Readings of one channel leak into the next: the source impedance
+ *     is too high for the acquisition time; add 100 nF at the pin or
+ *     lower SCAN_RATE
+ *   - Hz/ch is 0: the ADC interrupt is not running; check that the ISR
+ *     calls adc_scanner_isr() and nothing else uses Timer3/CCP2
+ ******************************************************************************/
@@ -0,0 +1,427 @@
+/******************************************************************************
+ * PIC18F4550 Triggered ADC Capture ("Oscilloscope" Mode)
+ * Experiment Q8 (variant): Pre-Trigger Ring Buffer on AN0
+ *
+ * Author: Microcontroller Lab
+ * Target Device: PIC18F4550
+ * IDE: MPLAB X IDE
+ * Compiler: XC8
+ * Kit: Microembedded PIC18F4550 Development Kit
+ *
+ * Description:
+ *   Catches fast transients on AN0 that the 500 ms LCD loop of adc_lcd.c
+ *   never sees. Works like the single-shot mode of an oscilloscope:
+ *
+ *   1. The host arms a capture (SCOPE_ARM: mode, level, pre, post).
+ *   2. The sample ISR writes every sample into a 512-entry RAM ring.
+ *      Once `pre` samples are in, the trigger is evaluated on each new
+ *      sample: rising edge, falling edge or level.
+ *   3. After the trigger sample, `post` more samples are stored and
+ *      sampling stops, freezing pre + 1 + post samples in the ring.
+ *   4. Main dumps the frozen capture in one burst: a SCOPE_HEADER frame
+ *      followed by SCOPE_DATA frames of 48 packed samples, over the
+ *      binary link (Drivers/frame_link.c, link_protocol.h).
+ *
+ * Deterministic Sampling:
+ *   Timer2 starts each conversion by interrupt at SCOPE_SAMPLE_RATE. The
+ *   ISR stores the previous result and starts the next conversion first,
+ *   so the sample instant does not depend on the trigger work that
+ *   follows. The trigger test itself has the same cost for every mode:
+ *   falling edges are handled by inverting the sample and the levels
+ *   (x = s ^ 0x3FF) and testing for a rising edge, and level mode is a
+ *   rising test that starts primed. Each state does a fixed amount of
+ *   work, so the ISR always finishes within its cycle budget (about 90
+ *   instruction cycles, see SCOPE_ISR_BUDGET) and never stretches the
+ *   sample period.
+ *
+ * Trigger Hysteresis:
+ *   An edge only counts after the signal has been at least
+ *   SCOPE_HYSTERESIS counts on the other side of the level, so noise
+ *   around the level does not trigger on every sample. Closer than that
+ *   to the end of the range (0 rising, 1023 falling), the signal has to
+ *   reach the end instead.
+ *
+ * Hardware Configuration:
+ *   ADC Input:          AN0 (RA0)
+ *   UART TX/RX:         RC6/RC7 (USB-Serial adapter)
+ *   Status LED:         RB0 (on while armed)
+ *
+ * Crystal Frequency: 8 MHz (Internal Oscillator)
+ ******************************************************************************/
+
+#include <xc.h>
+#include <pic18f4550.h>
+#include "../../Common/frame.h"
+#include "../Drivers/system_config.h"
+#include "../Drivers/adc_config.h"
+#include "../Drivers/uart_driver.h"
+#include "../Drivers/frame_link.h"
+#include "../Drivers/irq_priority.h"
+#include "../Q7_UART_Serial_Communication/link_protocol.h"
+
+// Configuration Bits
+#pragma config FOSC = INTOSCIO_EC   // Internal oscillator
+#pragma config WDTE = OFF           // Watchdog Timer disabled
+#pragma config PWRTE = OFF          // Power-up Timer disabled
+#pragma config BOREN = OFF          // Brown-out Reset disabled
+#pragma config PBADEN = OFF         // PORTB pins as digital I/O
+#pragma config LVP = OFF            // Low-Voltage Programming disabled
+#pragma config MCLRE = OFF          // MCLR function disabled
+
+// Sampling
+#define SCOPE_SAMPLE_RATE   10000UL         // Hz
+#define SCOPE_ISR_BUDGET    90              // Worst-case ISR cycles (estimate)
+#define SCOPE_HYSTERESIS    8               // ADC counts
+
+// Capture Ring (power of two; 2 bytes per sample)
+#define SCOPE_RING          512
+#define SCOPE_MASK          (SCOPE_RING - 1)
+
+// Timer2 Setup: period in instruction cycles, prescaler 1/4/16
+#define SCOPE_T2_DIV        ((_XTAL_FREQ / 4) / SCOPE_SAMPLE_RATE)
+#if SCOPE_T2_DIV <= 256
+#define SCOPE_T2_PRE        1
+#define SCOPE_T2_CKPS       0x00
+#elif SCOPE_T2_DIV <= 1024
+#define SCOPE_T2_PRE        4
+#define SCOPE_T2_CKPS       0x01
+#elif SCOPE_T2_DIV <= 4096
+#define SCOPE_T2_PRE        16
+#define SCOPE_T2_CKPS       0x02
+#else
+#error "SCOPE_SAMPLE_RATE too low for Timer2 without postscaler"
+#endif
+#define SCOPE_PR2           (SCOPE_T2_DIV / SCOPE_T2_PRE - 1)
+
+#if SCOPE_T2_DIV < SCOPE_ISR_BUDGET + 40
+#error "SCOPE_SAMPLE_RATE leaves no time outside the sample ISR"
+#endif
+
+// Each conversion must finish before the next tick reads it
+#if SCOPE_T2_DIV <= ADC_CONVERSION_CYCLES
+#error "SCOPE_SAMPLE_RATE faster than the ADC conversion time"
+#endif
+
+// Capture States
+#define SCOPE_IDLE          0               // Not sampling
+#define SCOPE_PRE           1               // Filling the pre-trigger samples
+#define SCOPE_ARMED         2               // Waiting for the trigger
+#define SCOPE_POST          3               // Storing post-trigger samples
+#define SCOPE_DONE          4               // Frozen, waiting to be dumped
+
+// Ring and Trigger State (shared with the ISR)
+unsigned int ring[SCOPE_RING];
+volatile unsigned int ring_pos = 0;         // Next slot to write
+volatile unsigned char scope_state = SCOPE_IDLE;
+volatile unsigned int trigger_pos;          // Slot of the trigger sample
+unsigned int pre_left, post_left;
+unsigned int trig_invert;                   // 0x3FF for falling edges
+unsigned int trig_fire;                     // Fire when x >= trig_fire
+unsigned int trig_prime;                    // Prime when x < trig_prime
+unsigned char trig_primed;
+
+// Capture Settings (main)
+unsigned int cap_pre, cap_post;
+unsigned int cap_number = 0;
+unsigned char dump_header;                  // Header not sent yet
+unsigned int dump_next;                     // Next sample to send
+unsigned char frame_seq = 0;
+unsigned char reply[SCOPE_HEADER_LEN];
+unsigned char chunk[2 + SCOPE_CHUNK / 4 * 5];
+
+/******************************************************************************
+ * Function: scope_sample
+ * Description: Timer2 interrupt work. Starts the next conversion first so
+ *              the sample instant is fixed, then stores the result and
+ *              advances the capture state machine. Every branch is short
+ *              and bounded; none loops.
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void scope_sample(void) {
+    unsigned int s, x;
+
+    s = ((unsigned int)ADRESH << 8) | ADRESL;
+    ADCON0bits.GO = 1;                      // Next sample, exactly one period on
+
+    ring[ring_pos] = s;
+    x = s ^ trig_invert;
+
+    switch(scope_state) {
+        case SCOPE_PRE:
+            if(--pre_left == 0) {
+                scope_state = SCOPE_ARMED;
+            }
+            break;
+
+        case SCOPE_ARMED:
+            if(trig_primed && x >= trig_fire) {
+                trigger_pos = ring_pos;
+                scope_state = SCOPE_POST;
+            } else if(x < trig_prime) {
+                trig_primed = 1;
+            }
+            break;
+
+        case SCOPE_POST:
+            if(--post_left == 0) {
+                scope_state = SCOPE_DONE;
+                T2CONbits.TMR2ON = 0;       // Freeze the ring
+            }
+            break;
+
+        default:
+            break;
+    }
+    ring_pos = (ring_pos + 1) & SCOPE_MASK;
+}
+
+/******************************************************************************
+ * Function: isr_low
+ * Description: Low-priority interrupt: UART transmit (Drivers/irq_priority.h)
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void IRQ_LOW_HANDLER isr_low(void) {
+    uart_tx_isr();
+}
+
+/******************************************************************************
+ * Function: __interrupt() high_priority ISR
+ * Description: Sample timer first (fixed latency), then UART receive;
+ *              never delayed by the transmit side
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void __interrupt(high_priority) ISR(void) {
+    if(PIE1bits.TMR2IE && PIR1bits.TMR2IF) {
+        PIR1bits.TMR2IF = 0;
+        scope_sample();
+    }
+    uart_rx_isr();
+    IRQ_CALL_LOW(isr_low);
+}
+
+/******************************************************************************
+ * Function: adc_scope_init
+ * Description: Configure AN0 and Timer2 (sample clock stays off until armed)
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void adc_scope_init(void) {
+    TRISAbits.TRISA0 = 1;       // RA0 as input
+    ADCON1 = 0x0E;              // AN0 analog, VREF = VDD/VSS
+    ADCON0 = 0x01;              // Channel AN0, ADC on
+    ADCON2 = ADC_ADCON2_RIGHT;  // Right justified, timing from adc_config.h
+
+    PR2 = SCOPE_PR2;
+    T2CON = SCOPE_T2_CKPS;      // Postscale 1:1, off
+    PIR1bits.TMR2IF = 0;
+    PIE1bits.TMR2IE = 1;
+}
+
+/******************************************************************************
+ * Function: scope_arm
+ * Description: Set up the trigger and start sampling. Falling edges are
+ *              turned into rising edges of the inverted signal so the
+ *              ISR test is the same for every mode.
+ * Parameters: mode  - SCOPE_RISING, SCOPE_FALLING or SCOPE_LEVEL
+ *             level - trigger level (0-1023)
+ *             pre   - samples kept before the trigger
+ *             post  - samples kept after the trigger
+ * Returns: LINK_OK, or LINK_ERR_LENGTH if the capture does not fit
+ ******************************************************************************/
+unsigned char scope_arm(unsigned char mode, unsigned int level,
+                        unsigned int pre, unsigned int post) {
+    if(mode > SCOPE_LEVEL || level > 1023 || post == 0 ||
+       pre >= SCOPE_RING || post >= SCOPE_RING - pre) {
+        return LINK_ERR_LENGTH;
+    }
+
+    T2CONbits.TMR2ON = 0;
+    cap_pre = pre;
+    cap_post = post;
+
+    trig_invert = (mode == SCOPE_FALLING) ? 0x3FF : 0;
+    trig_fire = level ^ trig_invert;
+    // Prime threshold clamped to the end of the range: a level within
+    // SCOPE_HYSTERESIS of 0 (1023 falling) primes when the signal is there
+    trig_prime = (trig_fire > SCOPE_HYSTERESIS) ? trig_fire - SCOPE_HYSTERESIS : 1;
+    trig_primed = (mode == SCOPE_LEVEL);
+
+    pre_left = pre;
+    post_left = post;
+    dump_header = 1;
+    dump_next = 0;
+    scope_state = pre ? SCOPE_PRE : SCOPE_ARMED;
+
+    ADCON0bits.GO = 1;          // First tick stores this result
+    TMR2 = 0;
+    T2CONbits.TMR2ON = 1;
+    LATBbits.LATB0 = 1;
+    return LINK_OK;
+}
+
+/******************************************************************************
+ * Function: put_u16
+ * Description: Store a value little endian
+ * Parameters: buf - destination, value - value to store
+ * Returns: None
+ ******************************************************************************/
+void put_u16(unsigned char *buf, unsigned int value) {
+    buf[0] = (unsigned char)value;
+    buf[1] = (unsigned char)(value >> 8);
+}
+
+/******************************************************************************
+ * Function: handle_request
+ * Description: Answer a request in link_rx (SCOPE_ARM or PING)
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void handle_request(void) {
+    unsigned char *p = link_rx.payload;
+
+    if(link_rx.type == MSG_SCOPE_ARM && link_rx.length == SCOPE_ARM_LEN) {
+        reply[0] = scope_arm(p[0], p[1] | ((unsigned int)p[2] << 8),
+                             p[3] | ((unsigned int)p[4] << 8),
+                             p[5] | ((unsigned int)p[6] << 8));
+    } else if(link_rx.type == MSG_SCOPE_ARM) {
+        reply[0] = LINK_ERR_LENGTH;
+    } else if(link_rx.type == MSG_PING) {
+        reply[0] = LINK_OK;
+    } else {
+        reply[0] = LINK_ERR_TYPE;
+    }
+    link_send(link_rx.type | LINK_RESPONSE, link_rx.seq, reply, 1);
+}
+
+/******************************************************************************
+ * Function: dump_step
+ * Description: Queue the next frame of a frozen capture: the header, then
+ *              SCOPE_CHUNK samples per frame starting pre samples before
+ *              the trigger. Sampling is stopped, so the ring is stable.
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void dump_step(void) {
+    unsigned int total = cap_pre + 1 + cap_post;
+    unsigned int start = (trigger_pos - cap_pre) & SCOPE_MASK;
+    unsigned int s;
+    unsigned char i, n, pos, high;
+
+    if(link_tx_busy()) {
+        return;
+    }
+
+    if(dump_header) {
+        put_u16(&reply[0], cap_number);
+        put_u16(&reply[2], (unsigned int)SCOPE_SAMPLE_RATE);
+        put_u16(&reply[4], cap_pre);
+        put_u16(&reply[6], cap_post);
+        put_u16(&reply[8], ring[trigger_pos]);
+        link_send(MSG_SCOPE_HEADER, frame_seq++, reply, SCOPE_HEADER_LEN);
+        dump_header = 0;
+        LATBbits.LATB0 = 0;                 // Triggered
+        return;
+    }
+
+    // Pack up to SCOPE_CHUNK samples, 4 per 5 bytes (zero padded)
+    put_u16(chunk, dump_next);
+    n = (total - dump_next > SCOPE_CHUNK) ? SCOPE_CHUNK : (unsigned char)(total - dump_next);
+    pos = 2;
+    high = 0;
+    for(i = 0; i < ((n + 3) & ~3); i++) {
+        s = (i < n) ? ring[(start + dump_next + i) & SCOPE_MASK] : 0;
+        chunk[pos++] = (unsigned char)s;
+        high = (high >> 2) | (unsigned char)((s >> 8) << 6);
+        if((i & 3) == 3) {
+            chunk[pos++] = high;
+        }
+    }
+    link_send(MSG_SCOPE_DATA, frame_seq++, chunk, pos);
+
+    dump_next += n;
+    if(dump_next >= total) {
+        cap_number++;
+        scope_state = SCOPE_IDLE;           // Ready to be armed again
+    }
+}
+
+/******************************************************************************
+ * Function: system_init
+ * Description: Initialize oscillator and I/O ports
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void system_init(void) {
+    // Configure internal oscillator to 8 MHz
+    OSCCONbits.IRCF2 = 1;
+    OSCCONbits.IRCF1 = 1;
+    OSCCONbits.IRCF0 = 1;
+    OSCCONbits.SCS1 = 1;
+    OSCCONbits.SCS0 = 0;
+
+    // Configure Port B for LED
+    TRISBbits.TRISB0 = 0;   // RB0 as output
+    LATBbits.LATB0 = 0;
+}
+
+/******************************************************************************
+ * Function: main
+ * Description: Serve arm requests and dump each finished capture
+ * Parameters: None
+ * Returns: None
+ ******************************************************************************/
+void main(void) {
+    system_init();
+    IRQ_PRIORITY_INIT();
+    IRQ_SET(IPR1bits.TMR2IP, IRQ_HIGH);     // Sample timer
+    IRQ_SET(IPR1bits.RCIP, IRQ_HIGH);       // UART RX; TX stays low
+    uart_init();
+    link_init();
+    adc_scope_init();
+
+    while(1) {
+        if(scope_state == SCOPE_DONE) {
+            dump_step();
+        } else if(!link_tx_busy() && link_receive() == FRAME_OK) {
+            handle_request();
+        }
+    }
+}
+
+/******************************************************************************
+ * Build Instructions:
+ *   1. Create a new MPLAB X project for PIC18F4550 with XC8
+ *   2. Add this file, Drivers/uart_driver.c, Drivers/frame_link.c and
+ *      Common/frame.c to Source Files
+ *   3. Optional: raise UART_BAUD (e.g. 500000 in Project Properties ->
+ *      XC8 Compiler -> Define macros) to shorten the dump; a full
+ *      512-sample capture is 11 frames, about 730 bytes
+ *
+ * Testing Instructions:
+ *   1. Feed a pulse or step to AN0 (e.g. tap a push button between a
+ *      resistor divider and RA0, or a function generator, 0-5 V)
+ *   2. ./link_cli /dev/ttyUSB0 scope rising 512 100 300 capture.csv
+ *      The LED lights while armed and goes off on the trigger; the tool
+ *      prints a text plot with the trigger at column pre and writes
+ *      "index,value" lines (index 0 = trigger sample) to capture.csv
+ *   3. Without the kit: ./link_sim (it generates a pulse every 0.5 s)
+ *
+ * Timing Notes (8 MHz, 10 kHz: 200 cycles per sample, estimates):
+ *   - Sample path (ADRES read, GO, ring store, trigger, index): about
+ *     70-90 cycles including interrupt entry/exit. Conversion time is
+ *     15 us (ADC_CONVERSION_NS), so the previous result is always ready at the next tick.
+ *   - The UART interrupts share the vector but are checked after the
+ *     sample, so they can delay a sample tick by at most one UART pass
+ *     (about 40 cycles). During a capture nothing is transmitted.
+ *   - Raise SCOPE_SAMPLE_RATE to about 15 kHz at 8 MHz; the #error
+ *     guards keep at least 40 cycles per sample for main.
+ *
+ * Troubleshooting:
+ *   - Never triggers: level outside the signal range, or an edge mode
+ *     on a signal that never goes SCOPE_HYSTERESIS counts past level
+ *   - Triggers at once in level mode: the input is already above level
+ *   - SCOPE_ARM answers "bad length": pre + 1 + post exceeds 512
+ ******************************************************************************/
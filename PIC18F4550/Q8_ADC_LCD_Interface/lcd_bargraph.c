@@ -0,0 +1,153 @@
+/******************************************************************************
+ * LCD Bar Graph Widget - Implementation
+ * See lcd_bargraph.h for glyph layout and usage.
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ ******************************************************************************/
+
+#include "lcd_bargraph.h"
+
+// LCD Commands used by the widget
+#define LCD_SET_CGRAM   0x40    // CGRAM address 0 (glyph 0, row 0)
+#define LCD_LINE1       0x80
+#define LCD_LINE2       0xC0
+
+// Character codes
+#define GLYPH_FULL      0xFF    // Built-in solid block (HD44780 ROM A00)
+#define GLYPH_EMPTY     ' '
+#define GLYPH_PEAK_BASE 3       // Peak in column c (1-4) uses glyph 3 + c
+#define NO_CURSOR       0xFF    // Cursor position unknown
+
+// Column mask for each CGRAM glyph (bit 4 = leftmost pixel column)
+static const unsigned char glyph_mask[8] = {
+    0x10, 0x18, 0x1C, 0x1E,     // Fill: 1, 2, 3, 4 columns
+    0x08, 0x04, 0x02, 0x01      // Peak marker: column 1, 2, 3, 4
+};
+
+static unsigned char bar_line;              // DDRAM base address of bar row
+static unsigned char bar_shadow[BAR_CELLS]; // Glyph currently shown per cell
+static unsigned char peak_seg;              // Peak-hold position (segments)
+static unsigned char peak_timer;            // Samples left before peak decays
+
+unsigned long bargraph_bytes = 0;
+unsigned int  bargraph_samples = 0;
+
+/******************************************************************************
+ * Function: bargraph_init
+ * Description: Load bar glyphs into CGRAM and blank the bar row
+ * Parameters: row - LCD line for the bar (1 or 2)
+ * Returns: None
+ ******************************************************************************/
+void bargraph_init(unsigned char row) {
+    unsigned char g, r;
+
+    // Write 8 glyphs x 8 pixel rows; each glyph is a vertical stripe pattern
+    lcd_send_cmd(LCD_SET_CGRAM);
+    for(g = 0; g < 8; g++) {
+        for(r = 0; r < 7; r++) {
+            lcd_send_data(glyph_mask[g]);
+        }
+        lcd_send_data(0x00);            // Row 8 left blank (cursor line)
+    }
+
+    // Blank the bar row and sync the shadow copy
+    bar_line = (row == 1) ? LCD_LINE1 : LCD_LINE2;
+    lcd_send_cmd(bar_line);
+    for(g = 0; g < BAR_CELLS; g++) {
+        lcd_send_data(GLYPH_EMPTY);
+        bar_shadow[g] = GLYPH_EMPTY;
+    }
+
+    peak_seg = 0;
+    peak_timer = 0;
+    bargraph_bytes = 0;
+    bargraph_samples = 0;
+}
+
+/******************************************************************************
+ * Function: bargraph_update
+ * Description: Redraw the bar for a new ADC sample, touching only the cells
+ *              whose glyph changed since the last call
+ * Parameters: adc_value - 10-bit ADC result (0-1023)
+ * Returns: None
+ ******************************************************************************/
+void bargraph_update(unsigned int adc_value) {
+    unsigned char fill, cell, start, lit, glyph, cursor;
+
+    // Scale 0-1023 to 0-80 segments: (adc * 5 + 32) / 64, no division
+    fill = (unsigned char)((adc_value * 5 + 32) >> 6);
+
+    // Peak hold: latch new maxima, decay to current fill after hold time
+#if BAR_PEAK_HOLD_SAMPLES > 0
+    if(fill >= peak_seg) {
+        peak_seg = fill;
+        peak_timer = BAR_PEAK_HOLD_SAMPLES;
+    } else if(peak_timer == 0) {
+        peak_seg = fill;
+    } else {
+        peak_timer--;
+    }
+#endif
+
+    cursor = NO_CURSOR;
+    start = 0;
+    for(cell = 0; cell < BAR_CELLS; cell++) {
+        // Number of lit columns in this cell
+        if(fill >= start + BAR_COLS_PER_CELL) {
+            lit = BAR_COLS_PER_CELL;
+        } else if(fill > start) {
+            lit = fill - start;
+        } else {
+            lit = 0;
+        }
+
+        if(lit == BAR_COLS_PER_CELL) {
+            glyph = GLYPH_FULL;
+        } else if(peak_seg > fill && peak_seg > start &&
+                  peak_seg <= start + BAR_COLS_PER_CELL) {
+            // Peak marker sits in its last lit column; column 0 = glyph 0.
+            // It wins over a partial fill in the same cell.
+            lit = peak_seg - start - 1;
+            glyph = (lit == 0) ? 0 : (GLYPH_PEAK_BASE + lit);
+        } else if(lit > 0) {
+            glyph = lit - 1;
+        } else {
+            glyph = GLYPH_EMPTY;
+        }
+
+        // Write only changed cells; consecutive writes reuse auto-increment
+        if(glyph != bar_shadow[cell]) {
+            if(cursor != cell) {
+                lcd_send_cmd(bar_line + cell);
+                bargraph_bytes++;
+            }
+            lcd_send_data(glyph);
+            bargraph_bytes++;
+            bar_shadow[cell] = glyph;
+            cursor = cell + 1;
+        }
+
+        start += BAR_COLS_PER_CELL;
+    }
+
+    // Halve both counts before the sample count wraps; the average stays
+    if(++bargraph_samples == 0xFFFF) {
+        bargraph_samples >>= 1;
+        bargraph_bytes >>= 1;
+    }
+}
+
+/******************************************************************************
+ * Function: bargraph_avg_bytes_x10
+ * Description: Average LCD bytes written per sample, scaled by 10
+ *              (e.g. 23 means 2.3 bytes per sample)
+ * Parameters: None
+ * Returns: Average bytes per sample x 10 (0 if no samples yet)
+ ******************************************************************************/
+unsigned int bargraph_avg_bytes_x10(void) {
+    if(bargraph_samples == 0) {
+        return 0;
+    }
+    return (unsigned int)((bargraph_bytes * 10) / bargraph_samples);
+}
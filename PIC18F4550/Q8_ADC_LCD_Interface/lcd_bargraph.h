@@ -0,0 +1,53 @@
+/******************************************************************************
+ * LCD Bar Graph Widget - 80 Segment Gauge on a 16x2 Character LCD
+ * Used by: Experiment Q8 (adc_lcd.c)
+ *
+ * Target Device: PIC18F4550
+ * Compiler: XC8
+ *
+ * Description:
+ *   Draws a horizontal bar across one LCD line using partial-block glyphs
+ *   stored in CGRAM. Each of the 16 cells holds 0-5 lit columns, giving
+ *   16 x 5 = 80 segments of resolution for a 10-bit ADC value.
+ *
+ *   Glyphs are loaded into CGRAM once by bargraph_init(). After that,
+ *   bargraph_update() keeps a shadow copy of the 16 cells and only writes
+ *   the cells whose glyph changed, so a slowly moving input costs a few
+ *   LCD bytes per sample instead of a full line rewrite.
+ *
+ * CGRAM Usage (character codes 0-7):
+ *   0-3:  Fill of 1, 2, 3, 4 columns (5 columns uses built-in 0xFF block)
+ *   4-7:  Peak-hold marker in column 1, 2, 3, 4 (column 0 reuses glyph 0)
+ *   A cell shows one glyph, so where the peak falls in the partly lit
+ *   cell at the end of the bar, the marker is drawn instead of the fill.
+ *
+ * LCD Primitives:
+ *   The widget calls lcd_send_cmd() and lcd_send_data(), which must be
+ *   provided by the application (see adc_lcd.c).
+ ******************************************************************************/
+
+#ifndef LCD_BARGRAPH_H
+#define LCD_BARGRAPH_H
+
+// Bar Graph Geometry
+#define BAR_CELLS           16      // Characters per LCD line
+#define BAR_COLS_PER_CELL   5       // Pixel columns per character (5x8 font)
+#define BAR_SEGMENTS        (BAR_CELLS * BAR_COLS_PER_CELL)    // 80
+
+// Peak-hold time in samples (0 = peak marker disabled)
+#define BAR_PEAK_HOLD_SAMPLES   6   // 6 x 500 ms = 3 s at the Q8 update rate
+
+// Statistics (read in the MPLAB X Watch window or via bargraph_avg_bytes_x10)
+extern unsigned long bargraph_bytes;    // LCD bytes (cmd + data) since init
+extern unsigned int  bargraph_samples;  // Calls to bargraph_update since init
+                                        // (both halved when it would wrap)
+
+// LCD primitives provided by the application
+void lcd_send_cmd(unsigned char cmd);
+void lcd_send_data(unsigned char data);
+
+void bargraph_init(unsigned char row);
+void bargraph_update(unsigned int adc_value);
+unsigned int bargraph_avg_bytes_x10(void);
+
+#endif